@@ -0,0 +1,411 @@
+"""
+Fixed-corpus benchmark matrix with baseline comparison.
+
+Runs the tokenizer over a deterministic set of generated corpora that cover
+the input shapes we care about, writes machine-readable JSON, and compares
+against a stored baseline with noise-aware thresholds:
+
+    english_prose   ASCII prose with punctuation and capitalization
+    source_code     Python/C-like code with indentation and operators
+    cjk             Chinese/Japanese text (3-byte UTF-8, mostly UNK-prone)
+    emoji_heavy     Prose mixed with emoji, skin tones, ZWJ sequences, flags
+    long_repeat     Pathological: the longest vocab token minus its last byte,
+                    repeated (maximal lookahead wasted on every token)
+    short_prompts   50-2000 byte prompts tokenized one call at a time
+
+Usage:
+    python benchmarks/corpus_suite.py --output results.json
+    python benchmarks/corpus_suite.py --baseline results.json   # exit 1 on regression
+    python benchmarks/corpus_suite.py --corpus mydata=path/to/file.txt
+
+Throughput regressions are flagged when the median drops by more than
+max(--threshold, 3 x combined relative MAD) of baseline and current runs;
+memory regressions when peak RSS grows by more than --mem-threshold.
+
+Peak RSS is measured in a fresh subprocess per corpus (one untimed run,
+VmHWM on Linux, resource.getrusage elsewhere), so it includes the native trie, the
+output buffers and the corpus itself, not only Python allocations. It is
+not reported where the resource module is missing (Windows).
+"""
+
+import argparse
+import json
+import os
+import platform
+import random
+import statistics
+import subprocess
+import sys
+import time
+from typing import Dict, List, Optional, Union
+
+from crayon.core.vocabulary import CrayonVocab
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_VOCAB = os.path.join(REPO_ROOT, "trained_vocab.json")
+SCHEMA_VERSION = 2
+
+try:
+    import resource
+except ImportError:  # Windows
+    resource = None
+
+Corpus = Union[str, List[str]]
+
+# ----------------------------------------------------------------------------
+# Corpus Generators (seeded: identical bytes on every run and host)
+# ----------------------------------------------------------------------------
+
+_WORDS = (
+    "the of and to in is that for it as was with be by on not he this are or "
+    "his from at which but have an they you were her she there been one all "
+    "would their we him has when who will more no if out so said what up its "
+    "about into than them can only other new some could time these two may "
+    "first then do any like my now over such our man me even most made after "
+    "also did many before must through back years where much your way well "
+    "down should because each just those people how too little state good "
+    "very make world still own see men work long get here between both life "
+    "being under never day same another know while last might us great old "
+    "year off come since against go came right used take three tokenizer "
+    "throughput vectorized benchmark latency memory performance regression"
+).split()
+
+_CODE_LINES = (
+    "def {name}(self, {arg}: int = 0) -> Optional[str]:",
+    "    if {arg} is None or len({name}) == 0:",
+    "        return {name}.get({arg}, default)",
+    "    for i in range(len({arg})):",
+    "        result += {name}[i] * {arg}",
+    "static inline int {name}(const uint8_t* {arg}, size_t length) {{",
+    "    while (*{arg} != '\\0' && length-- > 0) {arg}++;",
+    "    return ({name} >> 3) & 0x{hexv};",
+    "}}",
+    "# TODO: vectorize {name} once {arg} is aligned",
+    "import {name}.{arg} as {arg}_mod",
+    "    {name} = [{arg} ** 2 for {arg} in range({num}) if {arg} % 2]",
+)
+
+_IDENTS = ("buffer", "node", "token_id", "vocab", "offset", "trie", "cache",
+           "text", "length", "idx", "result", "matcher", "stream", "chunk")
+
+_KANA = [chr(c) for c in range(0x3041, 0x3097)] + [chr(c) for c in range(0x30A1, 0x30FB)]
+_CJK_PUNCT = ["、", "。", "，", "！", "？", "「", "」"]
+
+_EMOJI = (
+    ["\U0001F600", "\U0001F602", "\U0001F60D", "\U0001F44D", "\U0001F525",
+     "\U0001F680", "❤️", "\U0001F389", "\U0001F914", "✨"] +
+    ["\U0001F44B\U0001F3FD", "\U0001F469‍\U0001F4BB",
+     "\U0001F468‍\U0001F469‍\U0001F467", "\U0001F1FA\U0001F1F8",
+     "\U0001F1EF\U0001F1F5", "\U0001F3F3️‍\U0001F308"]
+)
+
+
+def _prose(rng: random.Random, size: int) -> str:
+    out: List[str] = []
+    total = 0
+    while total < size:
+        words = [rng.choice(_WORDS) for _ in range(rng.randint(6, 24))]
+        words[0] = words[0].capitalize()
+        sentence = " ".join(words) + rng.choice([". ", ". ", ", ", "! ", "? ", ".\n\n"])
+        out.append(sentence)
+        total += len(sentence)
+    return "".join(out)[:size]
+
+
+def gen_english_prose(rng: random.Random, size: int) -> str:
+    return _prose(rng, size)
+
+
+def gen_source_code(rng: random.Random, size: int) -> str:
+    out: List[str] = []
+    total = 0
+    while total < size:
+        line = rng.choice(_CODE_LINES).format(
+            name=rng.choice(_IDENTS), arg=rng.choice(_IDENTS),
+            hexv=f"{rng.randrange(256):02x}", num=rng.randrange(1000),
+        ) + "\n"
+        out.append(line)
+        total += len(line)
+    return "".join(out)
+
+
+def gen_cjk(rng: random.Random, size: int) -> str:
+    # Zipf-ish: a small set of common hanzi dominates, like real text
+    common = [chr(0x4E00 + i) for i in rng.sample(range(0x51A6), 3000)]
+    weights = [1.0 / (i + 1) for i in range(len(common))]
+    out: List[str] = []
+    total = 0
+    while total < size:
+        run = rng.choices(common, weights, k=rng.randint(4, 20))
+        if rng.random() < 0.3:
+            run += [rng.choice(_KANA) for _ in range(rng.randint(1, 5))]
+        run.append(rng.choice(_CJK_PUNCT))
+        chunk = "".join(run)
+        out.append(chunk)
+        total += len(chunk.encode("utf-8"))
+    return "".join(out)
+
+
+def gen_emoji_heavy(rng: random.Random, size: int) -> str:
+    out: List[str] = []
+    total = 0
+    while total < size:
+        chunk = " ".join(rng.choice(_WORDS) for _ in range(rng.randint(1, 5)))
+        chunk += " " + "".join(rng.choice(_EMOJI) for _ in range(rng.randint(1, 4))) + " "
+        out.append(chunk)
+        total += len(chunk.encode("utf-8"))
+    return "".join(out)
+
+
+def gen_long_repeat(rng: random.Random, size: int, vocab: CrayonVocab) -> str:
+    # Longest token minus its last character: the matcher walks the full
+    # depth, fails, and falls back to a shorter match every time.
+    longest = max(vocab.token_to_id, key=len)
+    unit = longest[:-1] if len(longest) > 1 else longest
+    return (unit * (size // max(len(unit.encode("utf-8")), 1) + 1))[:size]
+
+
+def gen_short_prompts(rng: random.Random, size: int) -> List[str]:
+    prompts: List[str] = []
+    total = 0
+    while total < size:
+        # Log-normal lengths clipped to the 50-2000 byte request range
+        length = int(min(max(rng.lognormvariate(5.5, 0.8), 50), 2000))
+        prompt = _prose(rng, length)
+        prompts.append(prompt)
+        total += len(prompt)
+    return prompts
+
+
+def build_corpora(vocab: CrayonVocab, size: int, seed: int = 1234,
+                  only: Optional[List[str]] = None) -> Dict[str, Corpus]:
+    """Generate the fixed corpus matrix (each corpus is ~size bytes)."""
+    corpora: Dict[str, Corpus] = {}
+    for name, gen in (("english_prose", gen_english_prose),
+                      ("source_code", gen_source_code),
+                      ("cjk", gen_cjk),
+                      ("emoji_heavy", gen_emoji_heavy),
+                      ("short_prompts", gen_short_prompts)):
+        if not only or name in only:
+            corpora[name] = gen(random.Random(f"{seed}:{name}"), size)
+    if not only or "long_repeat" in only:
+        corpora["long_repeat"] = gen_long_repeat(random.Random(f"{seed}:long_repeat"), size, vocab)
+    return corpora
+
+# ----------------------------------------------------------------------------
+# Measurement
+# ----------------------------------------------------------------------------
+
+
+def _run_once(vocab: CrayonVocab, corpus: Corpus) -> int:
+    if isinstance(corpus, list):
+        tokenize = vocab.tokenize
+        return sum(len(tokenize(prompt)) for prompt in corpus)
+    return len(vocab.tokenize(corpus))
+
+
+def _robust(samples: List[float]) -> Dict[str, float]:
+    median = statistics.median(samples)
+    mad = statistics.median(abs(s - median) for s in samples)
+    return {"median": median, "mad": mad, "min": min(samples), "max": max(samples)}
+
+
+def _max_rss_mb() -> float:
+    """This process's peak resident set size so far."""
+    # Linux carries ru_maxrss across fork/exec, so a child spawned by a
+    # large parent would report the parent's peak; VmHWM is per process
+    try:
+        with open("/proc/self/status", encoding="ascii") as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1]) / 1024
+    except OSError:
+        pass
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Kilobytes on Linux and the BSDs, bytes on macOS
+    return peak / 2**20 if sys.platform == "darwin" else peak / 1024
+
+
+def probe_rss(vocab: CrayonVocab, corpus: Corpus) -> Dict[str, float]:
+    """Peak RSS before and after one untimed run (--rss-probe child)."""
+    loaded = _max_rss_mb()
+    _run_once(vocab, corpus)
+    return {"loaded_rss_mb": loaded, "peak_rss_mb": _max_rss_mb()}
+
+
+def measure_rss(args, name: str) -> Optional[Dict[str, float]]:
+    """Run probe_rss for one corpus in a fresh interpreter."""
+    if resource is None:
+        return None
+    cmd = [sys.executable, os.path.abspath(__file__), "--rss-probe", "--only", name,
+           "--vocab", args.vocab, "--size-mb", str(args.size_mb)]
+    cmd += [f"--corpus={spec}" for spec in args.corpus if spec.partition("=")[0] == name]
+    out = subprocess.run(cmd, check=True, capture_output=True, text=True).stdout
+    return json.loads(out)
+
+
+def bench_corpus(vocab: CrayonVocab, corpus: Corpus, reps: int, warmup: int) -> Dict:
+    """Throughput over `reps` timed runs (peak RSS is measured separately)."""
+    if isinstance(corpus, list):
+        n_bytes = sum(len(p.encode("utf-8")) for p in corpus)
+    else:
+        n_bytes = len(corpus.encode("utf-8"))
+
+    for _ in range(warmup):
+        _run_once(vocab, corpus)
+
+    mb_per_s: List[float] = []
+    tokens = 0
+    for _ in range(reps):
+        start = time.perf_counter_ns()
+        tokens = _run_once(vocab, corpus)
+        elapsed = (time.perf_counter_ns() - start) / 1e9
+        mb_per_s.append(n_bytes / 1e6 / elapsed)
+
+    throughput = _robust(mb_per_s)
+    return {
+        "bytes": n_bytes,
+        "tokens": tokens,
+        "calls": len(corpus) if isinstance(corpus, list) else 1,
+        "mb_per_s": throughput,
+        "tokens_per_s": throughput["median"] * 1e6 * tokens / n_bytes,
+        "samples": mb_per_s,
+    }
+
+# ----------------------------------------------------------------------------
+# Baseline Comparison
+# ----------------------------------------------------------------------------
+
+
+def compare(current: Dict, baseline: Dict, threshold: float, mem_threshold: float) -> List[str]:
+    """Returns one message per significant regression (empty = pass)."""
+    regressions: List[str] = []
+    for name, cur in current["results"].items():
+        base = baseline.get("results", {}).get(name)
+        if base is None:
+            continue
+        if base["bytes"] != cur["bytes"]:
+            print(f"  {name}: corpus size changed ({base['bytes']} -> {cur['bytes']} bytes), skipped")
+            continue
+
+        b, c = base["mb_per_s"], cur["mb_per_s"]
+        # Relative noise of both runs combined; 3 MADs ~ 2 sigma
+        noise = ((b["mad"] / b["median"]) ** 2 + (c["mad"] / c["median"]) ** 2) ** 0.5
+        allowed = max(threshold, 3.0 * noise)
+        change = c["median"] / b["median"] - 1.0
+        status = "ok"
+        if change < -allowed:
+            status = "REGRESSION"
+            regressions.append(f"{name}: throughput {change:+.1%} (allowed -{allowed:.1%})")
+        print(f"  {name:<16} {b['median']:9.2f} -> {c['median']:9.2f} MB/s "
+              f"{change:+7.1%} (noise +/-{allowed:.1%}) {status}")
+
+        # Baselines from schema 1 carry tracemalloc figures, not RSS
+        if cur.get("peak_rss_mb") is None or base.get("peak_rss_mb") is None:
+            continue
+        mem_growth = cur["peak_rss_mb"] - base["peak_rss_mb"]
+        # Ignore sub-megabyte jitter on small corpora
+        if mem_growth > 1.0 and cur["peak_rss_mb"] > base["peak_rss_mb"] * (1 + mem_threshold):
+            regressions.append(f"{name}: peak RSS {base['peak_rss_mb']:.1f} -> "
+                               f"{cur['peak_rss_mb']:.1f} MB")
+    return regressions
+
+# ----------------------------------------------------------------------------
+# Main
+# ----------------------------------------------------------------------------
+
+
+def _build_mode() -> str:
+    """_core.BUILD_MODE ("release", "pgo-use+lto", ...) or "python"."""
+    try:
+        from crayon.c_ext import _core
+    except ImportError:
+        return "python"
+    return getattr(_core, "BUILD_MODE", "release")
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Crayon fixed-corpus benchmark suite")
+    parser.add_argument("--vocab", default=DEFAULT_VOCAB, help="vocab .json or .txt")
+    parser.add_argument("--size-mb", type=float, default=2.0, help="bytes per generated corpus")
+    parser.add_argument("--reps", type=int, default=7)
+    parser.add_argument("--warmup", type=int, default=1)
+    parser.add_argument("--corpus", action="append", default=[], metavar="NAME=PATH",
+                        help="add a local text file to the matrix")
+    parser.add_argument("--only", action="append", default=[], help="run only these corpora")
+    parser.add_argument("--output", help="write results JSON here")
+    parser.add_argument("--baseline", help="compare against this results JSON")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="minimum relative throughput drop treated as a regression")
+    parser.add_argument("--mem-threshold", type=float, default=0.10,
+                        help="relative peak-RSS growth treated as a regression")
+    parser.add_argument("--rss-probe", action="store_true", help=argparse.SUPPRESS)
+    args = parser.parse_args(argv)
+
+    if args.vocab.endswith(".json"):
+        vocab = CrayonVocab.from_json(args.vocab)
+    else:
+        vocab = CrayonVocab.from_file(args.vocab)
+
+    corpora = build_corpora(vocab, int(args.size_mb * 1e6), only=args.only)
+    for spec in args.corpus:
+        name, _, path = spec.partition("=")
+        if args.only and name not in args.only:
+            continue
+        with open(path, encoding="utf-8") as f:
+            corpora[name] = f.read()
+
+    if args.rss_probe:
+        (corpus,) = corpora.values()
+        print(json.dumps(probe_rss(vocab, corpus)))
+        return 0
+
+    results = {
+        "schema": SCHEMA_VERSION,
+        "meta": {
+            "python": platform.python_version(),
+            "implementation": platform.python_implementation(),
+            "machine": platform.machine(),
+            "platform": platform.platform(),
+            "vocab": os.path.basename(args.vocab),
+            "vocab_size": len(vocab),
+            "c_ext": vocab._c_ext_available,
+            "build": _build_mode(),
+            "reps": args.reps,
+        },
+        "results": {},
+    }
+
+    print(f"Crayon corpus suite: vocab={len(vocab):,} c_ext={vocab._c_ext_available} "
+          f"build={results['meta']['build']} reps={args.reps}")
+    for name, corpus in corpora.items():
+        r = bench_corpus(vocab, corpus, args.reps, args.warmup)
+        rss = measure_rss(args, name)
+        r["peak_rss_mb"] = rss["peak_rss_mb"] if rss else None
+        r["loaded_rss_mb"] = rss["loaded_rss_mb"] if rss else None
+        results["results"][name] = r
+        peak = f"peak RSS {r['peak_rss_mb']:.1f} MB" if rss else "peak RSS n/a"
+        print(f"  {name:<16} {r['mb_per_s']['median']:9.2f} MB/s (MAD {r['mb_per_s']['mad']:.2f}) "
+              f"{r['tokens_per_s'] / 1e6:8.2f} M tok/s  {peak}")
+
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            json.dump(results, f, indent=2)
+
+    if args.baseline:
+        with open(args.baseline, encoding="utf-8") as f:
+            baseline = json.load(f)
+        print(f"\nComparison against {args.baseline} "
+              f"(build {baseline.get('meta', {}).get('build', '?')} -> {results['meta']['build']}):")
+        regressions = compare(results, baseline, args.threshold, args.mem_threshold)
+        if regressions:
+            print("\nSignificant regressions:")
+            for msg in regressions:
+                print(f"  - {msg}")
+            return 1
+        print("\nNo significant regressions.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,240 @@
+"""
+Per-call latency distribution for short inputs.
+
+Request-path prompts are 50-2000 bytes, where fixed call overhead and
+allocation dominate and mean throughput hides the tail. This issues
+millions of calls over a log-normal prompt-size distribution and records
+every per-call latency into an HDR-style histogram, per entry point:
+
+    list    Tokenizer.tokenize(text)             -> list[int]
+    array   Tokenizer.tokenize_into(text, buf)   -> count, reused int32 buffer
+    count   Tokenizer.count(text)                -> int, nothing materialized
+    batch   Tokenizer.tokenize_batch(texts)      -> list[list[int]], amortized per text
+    python  CrayonVocab.tokenize with the C extension disabled (--python)
+
+Reports p50/p90/p99/p99.9/p99.99/max, and the fixed cost per call as the
+intercept of a least-squares fit of latency against prompt bytes.
+
+Usage:
+    python benchmarks/latency_bench.py --calls 1000000
+    python benchmarks/latency_bench.py --calls 200000 --json latency.json
+"""
+
+import argparse
+import gc
+import json
+import os
+import random
+import statistics
+import sys
+import time
+from array import array
+from typing import Callable, Dict, List, Optional
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, script_dir)
+
+from crayon.core.vocabulary import CrayonVocab
+from corpus_suite import DEFAULT_VOCAB, gen_short_prompts
+
+# ----------------------------------------------------------------------------
+# HDR Histogram
+# ----------------------------------------------------------------------------
+
+
+class HdrHistogram:
+    """
+    Log-linear histogram of integer nanosecond values.
+
+    Values below 2 * SUB_BUCKETS are exact; above that each power of two is
+    split into SUB_BUCKETS linear buckets, so any recorded value is off by at
+    most 1 / SUB_BUCKETS (< 0.8%) relative. Histograms with the same layout
+    merge by adding counts.
+    """
+
+    SUB_BITS = 7
+    SUB_BUCKETS = 1 << SUB_BITS
+
+    def __init__(self):
+        self.counts: Dict[int, int] = {}
+        self.total = 0
+        self.sum = 0
+        self.max = 0
+
+    @classmethod
+    def index(cls, value: int) -> int:
+        shift = max(value.bit_length() - cls.SUB_BITS - 1, 0)
+        return cls.SUB_BUCKETS * shift + (value >> shift)
+
+    @classmethod
+    def lower_bound(cls, idx: int) -> int:
+        shift = max(idx // cls.SUB_BUCKETS - 1, 0)
+        return (idx - cls.SUB_BUCKETS * shift) << shift
+
+    def record_many(self, values) -> None:
+        # Timer overhead is subtracted upstream, so a fast call can come out
+        # negative; it is recorded as 0 rather than given a negative bucket
+        values = [v if v > 0 else 0 for v in values]
+        counts = self.counts
+        index = self.index
+        for v in values:
+            idx = index(v)
+            counts[idx] = counts.get(idx, 0) + 1
+        self.total += len(values)
+        self.sum += sum(values)
+        self.max = max(self.max, max(values, default=0))
+
+    def percentile(self, p: float) -> int:
+        """Lower bound of the bucket holding the p-th percentile value."""
+        target = max(1, int(self.total * p / 100.0 + 0.5))
+        seen = 0
+        for idx in sorted(self.counts):
+            seen += self.counts[idx]
+            if seen >= target:
+                return self.lower_bound(idx)
+        return self.max
+
+    def summary(self) -> Dict[str, float]:
+        return {
+            "count": self.total,
+            "mean_ns": self.sum / self.total if self.total else 0.0,
+            "p50_ns": self.percentile(50),
+            "p90_ns": self.percentile(90),
+            "p99_ns": self.percentile(99),
+            "p999_ns": self.percentile(99.9),
+            "p9999_ns": self.percentile(99.99),
+            "max_ns": self.max,
+        }
+
+    def to_json(self) -> Dict:
+        return {"sub_bits": self.SUB_BITS,
+                "buckets": [[self.lower_bound(i), c] for i, c in sorted(self.counts.items())]}
+
+# ----------------------------------------------------------------------------
+# Measurement
+# ----------------------------------------------------------------------------
+
+
+def timer_overhead_ns(samples: int = 100000) -> int:
+    """Median cost of one back-to-back perf_counter_ns pair."""
+    clock = time.perf_counter_ns
+    deltas = array("q")
+    for _ in range(samples):
+        t0 = clock()
+        deltas.append(clock() - t0)
+    return int(statistics.median(deltas))
+
+
+def measure(call: Callable, prompts: List, calls: int, overhead: int):
+    """Times `calls` single-prompt calls; returns (latencies, prompt byte sizes)."""
+    clock = time.perf_counter_ns
+    sizes = [len(p) for p in prompts]
+    n = len(prompts)
+    latencies = array("q", bytes(8 * calls))
+    gc.disable()  # Collector pauses are real, but not the tokenizer's
+    try:
+        for i in range(calls):
+            prompt = prompts[i % n]
+            t0 = clock()
+            call(prompt)
+            latencies[i] = clock() - t0 - overhead
+    finally:
+        gc.enable()
+    return latencies, [sizes[i % n] for i in range(calls)]
+
+
+def fixed_cost(latencies, sizes) -> Dict[str, float]:
+    """Least-squares latency = fixed + per_byte * bytes."""
+    slope, intercept = statistics.linear_regression(sizes, [float(x) for x in latencies])
+    return {"fixed_ns": intercept, "ns_per_byte": slope}
+
+
+def build_entry_points(vocab: CrayonVocab, batch_size: int, with_python: bool) -> Dict[str, Callable]:
+    entries: Dict[str, Callable] = {}
+    tok = vocab._c_tokenizer if vocab._c_ext_available else None
+    if tok is not None:
+        buf = array("i", bytes(4 * 4096))
+        entries["list"] = tok.tokenize
+        entries["array"] = lambda text: tok.tokenize_into(text, buf)
+        entries["count"] = tok.count
+        entries["batch"] = tok.tokenize_batch
+    else:
+        entries["list"] = vocab.tokenize
+    if with_python:
+        def python_tokenize(text, _vocab=vocab):
+            enabled = _vocab._c_ext_available
+            _vocab._c_ext_available = False
+            try:
+                return _vocab.tokenize(text)
+            finally:
+                _vocab._c_ext_available = enabled
+        entries["python"] = python_tokenize
+    return entries
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Crayon per-call latency benchmark")
+    parser.add_argument("--vocab", default=DEFAULT_VOCAB)
+    parser.add_argument("--calls", type=int, default=1000000, help="calls per entry point")
+    parser.add_argument("--prompts", type=int, default=10000, help="distinct prompts in the pool")
+    parser.add_argument("--batch-size", type=int, default=32)
+    parser.add_argument("--python", action="store_true", help="also time the pure-Python path")
+    parser.add_argument("--bytes", action="store_true", help="pass UTF-8 bytes instead of str")
+    parser.add_argument("--json", help="write summaries and histograms here")
+    args = parser.parse_args(argv)
+
+    if args.vocab.endswith(".json"):
+        vocab = CrayonVocab.from_json(args.vocab)
+    else:
+        vocab = CrayonVocab.from_file(args.vocab)
+
+    # Pool of prompts with the request-path size distribution (50-2000 bytes)
+    rng = random.Random(85)
+    prompts: List = []
+    while len(prompts) < args.prompts:
+        prompts.extend(gen_short_prompts(rng, 1 << 16))
+    prompts = prompts[:args.prompts]
+    if args.bytes:
+        prompts = [p.encode("utf-8") for p in prompts]
+    batches = [prompts[i:i + args.batch_size] for i in range(0, len(prompts), args.batch_size)]
+
+    overhead = timer_overhead_ns()
+    sizes = [len(p) for p in prompts]
+    print(f"Crayon latency bench: {args.calls:,} calls/entry, prompts {min(sizes)}-{max(sizes)} "
+          f"bytes (median {int(statistics.median(sizes))}), timer overhead {overhead} ns")
+    print(f"{'entry':<8} {'p50':>8} {'p90':>8} {'p99':>8} {'p99.9':>8} {'p99.99':>8} "
+          f"{'max':>9} {'fixed':>8} {'ns/B':>6}   (ns per call)")
+
+    report = {"timer_overhead_ns": overhead, "calls": args.calls, "entries": {}}
+    for name, call in build_entry_points(vocab, args.batch_size, args.python).items():
+        pool = batches if name == "batch" else prompts
+        calls = max(args.calls // args.batch_size, 1) if name == "batch" else args.calls
+        if name == "python":
+            calls = max(calls // 20, 1)  # ~20x slower; keep runtime bounded
+
+        measure(call, pool, min(calls, 10000), overhead)  # Warmup
+        latencies, call_sizes = measure(call, pool, calls, overhead)
+        if name == "batch":
+            # Every row is per text: amortize each batch over its texts
+            batch_bytes = [sum(len(p) for p in b) / len(b) for b in pool]
+            latencies = array("q", (x // len(pool[i % len(pool)]) for i, x in enumerate(latencies)))
+            call_sizes = [batch_bytes[i % len(pool)] for i in range(calls)]
+
+        hist = HdrHistogram()
+        hist.record_many(latencies)
+        summary = hist.summary()
+        summary.update(fixed_cost(latencies, call_sizes))
+        report["entries"][name] = {"summary": summary, "histogram": hist.to_json()}
+
+        print(f"{name:<8} {summary['p50_ns']:>8} {summary['p90_ns']:>8} {summary['p99_ns']:>8} "
+              f"{summary['p999_ns']:>8} {summary['p9999_ns']:>8} {summary['max_ns']:>9} "
+              f"{summary['fixed_ns']:>8.0f} {summary['ns_per_byte']:>6.2f}")
+
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(report, f)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,20 +1,41 @@
 import time
 import tracemalloc
 import statistics
-from typing import Dict, List, Any
+from typing import Dict, List, Any, Optional
 from crayon.core.vocabulary import CrayonVocab
 
+try:
+    from crayon.c_ext._core import PerfCounters
+except ImportError:
+    PerfCounters = None
+
+
+def open_perf_counters() -> Optional[Any]:
+    """Returns a PerfCounters instance, or None if perf is unavailable."""
+    if PerfCounters is None:
+        return None
+    try:
+        return PerfCounters()
+    except OSError:
+        return None
+
+
 class CrayonBenchmark:
     """
     Comprehensive micro-benchmark suite for tokenizer performance evaluation.
     
     Measures throughput, latency, and memory usage across different configurations.
+    With perf_counters=True, hardware counters (cycles, instructions, cache,
+    dTLB and branch misses) are collected around each run where the host
+    allows perf_event_open, and reported per byte and per token.
     """
     
-    def __init__(self, tokenizer: CrayonVocab, test_corpora: Dict[str, str]):
+    def __init__(self, tokenizer: CrayonVocab, test_corpora: Dict[str, str],
+                 perf_counters: bool = False):
         self.tokenizer = tokenizer
         self.corpora = test_corpora
         self.results: Dict[str, Any] = {}
+        self.perf = open_perf_counters() if perf_counters else None
 
     def run_benchmarks(self, iterations: int = 5) -> Dict:
         """Execute full benchmark suite."""
@@ -29,14 +50,20 @@ class CrayonBenchmark:
             
         times = []
         peak_mem = []
+        counters: Dict[str, int] = {}
         
         for _ in range(iterations):
             tracemalloc.start()
+            if self.perf is not None:
+                self.perf.start()
             start = time.perf_counter()
             
             tokens = self.tokenizer.tokenize(text)
             
             end = time.perf_counter()
+            if self.perf is not None:
+                for event, count in self.perf.stop().items():
+                    counters[event] = counters.get(event, 0) + count
             _, peak = tracemalloc.get_traced_memory()
             tracemalloc.stop()
             
@@ -44,13 +71,22 @@ class CrayonBenchmark:
             peak_mem.append(peak / 1024 / 1024)  # MB
             
         total_tokens = len(tokens)  # from last run
+        total_bytes = len(text.encode('utf-8'))
         
-        return {
+        result = {
             "throughput_mean": total_tokens / statistics.mean(times),
-            "latency_ms_per_mb": (statistics.mean(times) * 1000) / (len(text.encode('utf-8')) / 1e6),
+            "latency_ms_per_mb": (statistics.mean(times) * 1000) / (total_bytes / 1e6),
             "memory_peak_mb": statistics.mean(peak_mem),
             "c_ext_enabled": self.tokenizer._c_ext_available
         }
+        if counters:
+            result["perf"] = {
+                **{f"{event}_per_byte": count / (total_bytes * iterations)
+                   for event, count in counters.items()},
+                **{f"{event}_per_token": count / (total_tokens * iterations)
+                   for event, count in counters.items()},
+            }
+        return result
 
     def run_c_vs_python_comparison(self, text: str, iterations: int = 10) -> Dict:
         """Compare C extension vs Python fallback performance."""
@@ -0,0 +1,532 @@
+/**
+ * @file bench_trie.c
+ * @brief Standalone native benchmark for the Crayon trie and SIMD kernels.
+ *
+ * Links the kernel sources directly, so numbers exclude the
+ * interpreter, argument parsing and list building. Reports:
+ * - tokenize: ns/byte, ns/token and cycles/token (rdtsc) over a corpus,
+ *   for the trie walk and (vocabularies of <= 16-byte tokens) the hashed
+ *   prefix matcher
+ * - find_child_simd: ns/lookup per node fanout (SSE path vs binary search)
+ * - compare_strings_avx2 / classify_characters_avx2: ns/byte per size
+ *
+ * Every measurement uses warmup runs, optional CPU pinning and repeated
+ * runs summarized as mean +/- 95% confidence interval. With --perf, the
+ * measured runs are wrapped in perf_event_open counters (cycles,
+ * instructions, L1D/LLC/dTLB misses, branch misses) reported per byte
+ * (per lookup for find_child_simd) and per token; counters the host does
+ * not expose are skipped.
+ *
+ * Usage:
+ *   bench_trie [--vocab tokens.txt] [--corpus file] [--reps N]
+ *              [--warmup N] [--cpu K] [--perf] [--json]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include <time.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #include <windows.h>
+#else
+    #include <x86intrin.h>
+    #include <sched.h>
+#endif
+
+#include "trie_node.h"
+#include "trie_builder.h"
+#include "trie_match.h"
+#include "simd_ops.h"
+#include "perf_counters.h"
+
+// ----------------------------------------------------------------------------
+// Timing & Statistics
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    int reps;
+    int warmup;
+    int cpu;
+    int json;
+    int perf;
+    const char* vocab_path;
+    const char* corpus_path;
+} BenchConfig;
+
+typedef struct {
+    double mean;
+    double ci95;                // Half-width of the 95% confidence interval
+    double min;
+} Summary;
+
+static double now_ns(void) {
+#if defined(_MSC_VER)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t read_tsc(void) {
+    // Reference cycles (constant-rate TSC), not core clock cycles
+    return __rdtsc();
+}
+
+// Two-sided 95% Student t quantiles for df = 1..30
+static const double T_95[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static Summary summarize(const double* samples, int n) {
+    Summary s = {0.0, 0.0, samples[0]};
+    for (int i = 0; i < n; i++) {
+        s.mean += samples[i];
+        if (samples[i] < s.min) s.min = samples[i];
+    }
+    s.mean /= n;
+    if (n > 1) {
+        double var = 0.0;
+        for (int i = 0; i < n; i++) var += (samples[i] - s.mean) * (samples[i] - s.mean);
+        double sd = sqrt(var / (n - 1));
+        double t = (n - 1 <= 30) ? T_95[n - 2] : 1.960;
+        s.ci95 = t * sd / sqrt((double)n);
+    }
+    return s;
+}
+
+static void pin_to_cpu(int cpu) {
+    if (cpu < 0) return;
+#if defined(_MSC_VER)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        fprintf(stderr, "[bench] warning: could not pin to CPU %d\n", cpu);
+    }
+#endif
+}
+
+// Defeats dead-code elimination of benchmark results
+static volatile uint64_t bench_sink;
+
+// Hardware counters (only opened with --perf)
+static CrayonPerfCounters perf;
+static int perf_enabled = 0;
+
+typedef struct {
+    int64_t values[CRAYON_PERF_EVENT_COUNT];
+    double bytes;               // Normalizer for *_per_byte (0 = skip)
+    double tokens;              // Normalizer for *_per_token (0 = skip)
+} PerfSample;
+
+static void perf_begin(void) {
+    if (perf_enabled) crayon_perf_start(&perf);
+}
+
+static void perf_end(PerfSample* sample, double bytes, double tokens) {
+    sample->bytes = bytes;
+    sample->tokens = tokens;
+    if (perf_enabled) {
+        crayon_perf_stop(&perf, sample->values);
+    } else {
+        for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) sample->values[i] = CRAYON_PERF_UNAVAILABLE;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Inputs
+// ----------------------------------------------------------------------------
+
+static uint8_t* read_file(const char* path, size_t* length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = (uint8_t*)malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *length = buf ? (size_t)size : 0;
+    return buf;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Build a trie from a one-token-per-line file, or a synthetic vocab.
+ *
+ * The synthetic vocab mixes all single bytes of printable ASCII with random
+ * 2-8 byte lowercase words, giving a high-fanout root and shallow subtrees.
+ */
+static CrayonTrie* load_vocab(const char* path, size_t* vocab_size) {
+    CrayonTrieBuilder* builder = crayon_builder_new();
+    if (!builder) return NULL;
+    int32_t next_id = 0;
+
+    if (path) {
+        size_t length;
+        uint8_t* buf = read_file(path, &length);
+        if (!buf) {
+            crayon_builder_free(builder);
+            return NULL;
+        }
+        size_t start = 0;
+        for (size_t i = 0; i <= length; i++) {
+            if (i == length || buf[i] == '\n') {
+                size_t end = i;
+                if (end > start && buf[end - 1] == '\r') end--;
+                if (end > start) {
+                    crayon_builder_insert(builder, buf + start, end - start, next_id);
+                }
+                next_id++;
+                start = i + 1;
+            }
+        }
+        free(buf);
+    } else {
+        for (int c = 32; c < 127; c++) {
+            uint8_t b = (uint8_t)c;
+            crayon_builder_insert(builder, &b, 1, next_id++);
+        }
+        for (int i = 0; i < 20000; i++) {
+            uint8_t word[8];
+            size_t len = 2 + rng_next() % 7;
+            for (size_t j = 0; j < len; j++) word[j] = (uint8_t)('a' + rng_next() % 26);
+            crayon_builder_insert(builder, word, len, next_id++);
+        }
+    }
+
+    *vocab_size = (size_t)next_id;
+    return crayon_builder_finish(builder);
+}
+
+static uint8_t* synthetic_corpus(size_t length) {
+    static const char* words[] = {
+        "the ", "of ", "and ", "tokenizer ", "throughput ", "a ", "in ",
+        "vectorized ", "cache ", "line ", "is ", "to ", "with ", "trie "
+    };
+    uint8_t* buf = (uint8_t*)malloc(length);
+    size_t pos = 0;
+    while (buf && pos < length) {
+        const char* w = words[rng_next() % (sizeof(words) / sizeof(words[0]))];
+        size_t n = strlen(w);
+        if (pos + n > length) n = length - pos;
+        memcpy(buf + pos, w, n);
+        pos += n;
+    }
+    return buf;
+}
+
+// ----------------------------------------------------------------------------
+// Reporting
+// ----------------------------------------------------------------------------
+
+static int first_row = 1;
+
+static void report_counters(const BenchConfig* cfg, const PerfSample* sample) {
+    static const struct { const char* suffix; size_t offset; } norms[] = {
+        {"per_byte", offsetof(PerfSample, bytes)},
+        {"per_token", offsetof(PerfSample, tokens)},
+    };
+    for (size_t n = 0; n < sizeof(norms) / sizeof(norms[0]); n++) {
+        double divisor = *(const double*)((const char*)sample + norms[n].offset);
+        if (divisor <= 0) continue;
+        if (!cfg->json) printf("%-24s %-14s", "", norms[n].suffix);
+        for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+            if (sample->values[i] == CRAYON_PERF_UNAVAILABLE) continue;
+            double v = (double)sample->values[i] / divisor;
+            if (cfg->json) {
+                printf(", \"%s_%s\": %.6f", crayon_perf_event_names[i], norms[n].suffix, v);
+            } else {
+                printf(" %s=%.4f", crayon_perf_event_names[i], v);
+            }
+        }
+        if (!cfg->json) printf("\n");
+    }
+}
+
+static void report(const BenchConfig* cfg, const char* kernel, const char* variant,
+                   const char* unit, Summary s, double extra, const char* extra_name,
+                   const PerfSample* sample) {
+    if (cfg->json) {
+        printf("%s  {\"kernel\": \"%s\", \"variant\": \"%s\", \"unit\": \"%s\", "
+               "\"mean\": %.4f, \"ci95\": %.4f, \"min\": %.4f",
+               first_row ? "" : ",\n", kernel, variant, unit, s.mean, s.ci95, s.min);
+        if (extra_name) printf(", \"%s\": %.4f", extra_name, extra);
+        if (sample) report_counters(cfg, sample);
+        printf("}");
+    } else {
+        printf("%-24s %-14s %10.3f +/- %-8.3f %-12s (min %.3f)",
+               kernel, variant, s.mean, s.ci95, unit, s.min);
+        if (extra_name) printf("  %s=%.2f", extra_name, extra);
+        printf("\n");
+        if (sample) report_counters(cfg, sample);
+    }
+    first_row = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Benchmarks
+// ----------------------------------------------------------------------------
+
+static void bench_tokenize(const BenchConfig* cfg, CrayonViewKind view, const void* root,
+                           const char* variant, const uint8_t* corpus, size_t length) {
+    CrayonKernel kernel = crayon_kernels[view][CRAYON_SINK_I32];
+    int32_t* ids = (int32_t*)malloc(length * sizeof(int32_t));
+    double* ns_per_byte = (double*)malloc(cfg->reps * sizeof(double));
+    double* cycles_per_token = (double*)malloc(cfg->reps * sizeof(double));
+    size_t tokens = 0;
+
+    PerfSample counters;
+    for (int r = -cfg->warmup; r < cfg->reps; r++) {
+        if (r == 0) perf_begin();
+        double t0 = now_ns();
+        uint64_t c0 = read_tsc();
+        CrayonSink sink = {ids, NULL, length, 0, 0, 0};
+        kernel(root, corpus, length, 0, &sink);
+        tokens = sink.count;
+        uint64_t c1 = read_tsc();
+        double t1 = now_ns();
+        bench_sink += ids[tokens - 1];
+        if (r < 0) continue;
+        ns_per_byte[r] = (t1 - t0) / (double)length;
+        cycles_per_token[r] = (double)(c1 - c0) / (double)tokens;
+    }
+    perf_end(&counters, (double)length * cfg->reps, (double)tokens * cfg->reps);
+
+    Summary s = summarize(ns_per_byte, cfg->reps);
+    report(cfg, "tokenize", variant, "ns/byte", s,
+           s.mean * (double)length / (double)tokens, "ns_per_token",
+           perf_enabled ? &counters : NULL);
+    report(cfg, "tokenize", variant, "cycles/token",
+           summarize(cycles_per_token, cfg->reps),
+           (double)length / (double)tokens, "bytes_per_token", NULL);
+
+    free(ids);
+    free(ns_per_byte);
+    free(cycles_per_token);
+}
+
+/**
+ * @brief find_child_simd on a single node of the given fanout.
+ *
+ * Fanout <= 16 takes the SSE compare path; larger nodes fall back to
+ * binary search. Queries are a fixed random mix of hits and misses.
+ */
+static void bench_find_child(const BenchConfig* cfg, int fanout) {
+    enum { QUERIES = 1 << 16 };
+    CrayonTrieBuilder* builder = crayon_builder_new();
+    uint8_t keys[256];
+    for (int i = 0; i < 256; i++) keys[i] = (uint8_t)i;
+    // Random key subset of the requested size
+    for (int i = 255; i > 0; i--) {
+        int j = (int)(rng_next() % (uint64_t)(i + 1));
+        uint8_t tmp = keys[i]; keys[i] = keys[j]; keys[j] = tmp;
+    }
+    for (int i = 0; i < fanout; i++) crayon_builder_insert(builder, &keys[i], 1, i);
+    CrayonTrie* trie = crayon_builder_finish(builder);
+
+    uint8_t* queries = (uint8_t*)malloc(QUERIES);
+    for (int i = 0; i < QUERIES; i++) {
+        // ~50% hits: half the queries draw from the node's keys
+        queries[i] = (rng_next() & 1) ? keys[rng_next() % (uint64_t)fanout] : (uint8_t)rng_next();
+    }
+
+    double* samples = (double*)malloc(cfg->reps * sizeof(double));
+    PerfSample counters;
+    for (int r = -cfg->warmup; r < cfg->reps; r++) {
+        if (r == 0) perf_begin();
+        uint64_t acc = 0;
+        double t0 = now_ns();
+        for (int i = 0; i < QUERIES; i++) acc += (uint64_t)(find_child_simd(trie->root, queries[i]) + 1);
+        double t1 = now_ns();
+        bench_sink += acc;
+        if (r >= 0) samples[r] = (t1 - t0) / QUERIES;
+    }
+    // One lookup per query: "per_byte" reads as per lookup
+    perf_end(&counters, (double)QUERIES * cfg->reps, 0);
+
+    char variant[32];
+    snprintf(variant, sizeof(variant), "fanout=%d", fanout);
+    report(cfg, "find_child_simd", variant, "ns/lookup", summarize(samples, cfg->reps),
+           fanout <= 16 ? 1.0 : 0.0, "simd_path", perf_enabled ? &counters : NULL);
+
+    free(samples);
+    free(queries);
+    crayon_trie_decref(trie);
+}
+
+static void bench_compare_strings(const BenchConfig* cfg, size_t size) {
+    enum { CALLS = 4096 };
+    char* a = (char*)malloc(size + 1);
+    char* b = (char*)malloc(size + 1);
+    for (size_t i = 0; i < size; i++) a[i] = b[i] = (char)('a' + i % 26);
+
+    double* samples = (double*)malloc(cfg->reps * sizeof(double));
+    PerfSample counters;
+    for (int r = -cfg->warmup; r < cfg->reps; r++) {
+        if (r == 0) perf_begin();
+        int acc = 0;
+        double t0 = now_ns();
+        // Equal strings: the full length is always scanned
+        for (int i = 0; i < CALLS; i++) acc += compare_strings_avx2(a, b, size);
+        double t1 = now_ns();
+        bench_sink += (uint64_t)acc;
+        if (r >= 0) samples[r] = (t1 - t0) / ((double)CALLS * (double)size);
+    }
+    perf_end(&counters, (double)CALLS * (double)size * cfg->reps, 0);
+
+    char variant[32];
+    snprintf(variant, sizeof(variant), "len=%zu", size);
+    report(cfg, "compare_strings_avx2", variant, "ns/byte", summarize(samples, cfg->reps), 0, NULL,
+           perf_enabled ? &counters : NULL);
+
+    free(samples);
+    free(a);
+    free(b);
+}
+
+static void bench_classify(const BenchConfig* cfg, const uint8_t* corpus, size_t size) {
+    uint8_t* out = (uint8_t*)malloc(size);
+    int calls = (int)((1 << 22) / size) + 1;
+
+    double* samples = (double*)malloc(cfg->reps * sizeof(double));
+    PerfSample counters;
+    for (int r = -cfg->warmup; r < cfg->reps; r++) {
+        if (r == 0) perf_begin();
+        double t0 = now_ns();
+        for (int i = 0; i < calls; i++) classify_characters_avx2(corpus, out, size);
+        double t1 = now_ns();
+        bench_sink += out[size - 1];
+        if (r >= 0) samples[r] = (t1 - t0) / ((double)calls * (double)size);
+    }
+    perf_end(&counters, (double)calls * (double)size * cfg->reps, 0);
+
+    char variant[32];
+    snprintf(variant, sizeof(variant), "len=%zu", size);
+    report(cfg, "classify_characters_avx2", variant, "ns/byte", summarize(samples, cfg->reps), 0, NULL,
+           perf_enabled ? &counters : NULL);
+
+    free(samples);
+    free(out);
+}
+
+// ----------------------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------------------
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [--vocab tokens.txt] [--corpus file] [--reps N] "
+            "[--warmup N] [--cpu K] [--perf] [--json]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig cfg = {15, 3, -1, 0, 0, NULL, NULL};
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--vocab") && i + 1 < argc) cfg.vocab_path = argv[++i];
+        else if (!strcmp(argv[i], "--corpus") && i + 1 < argc) cfg.corpus_path = argv[++i];
+        else if (!strcmp(argv[i], "--reps") && i + 1 < argc) cfg.reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) cfg.warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--cpu") && i + 1 < argc) cfg.cpu = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json")) cfg.json = 1;
+        else if (!strcmp(argv[i], "--perf")) cfg.perf = 1;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (cfg.reps < 2) cfg.reps = 2;
+
+    pin_to_cpu(cfg.cpu);
+
+    if (cfg.perf) {
+        perf_enabled = crayon_perf_open(&perf) > 0;
+        if (!perf_enabled) {
+            crayon_perf_close(&perf);
+            fprintf(stderr, "[bench] perf_event_open unavailable; hardware counters skipped\n");
+        }
+    }
+
+    size_t vocab_size = 0;
+    CrayonTrie* trie = load_vocab(cfg.vocab_path, &vocab_size);
+    if (!trie) {
+        fprintf(stderr, "[bench] failed to load vocabulary\n");
+        return 1;
+    }
+
+    size_t corpus_length = 0;
+    uint8_t* corpus = cfg.corpus_path
+        ? read_file(cfg.corpus_path, &corpus_length)
+        : (corpus_length = 8u << 20, synthetic_corpus(corpus_length));
+    if (!corpus || corpus_length == 0) {
+        fprintf(stderr, "[bench] failed to load corpus\n");
+        return 1;
+    }
+
+    if (cfg.json) {
+        printf("{\"vocab_size\": %zu, \"corpus_bytes\": %zu, \"reps\": %d, \"results\": [\n",
+               vocab_size, corpus_length, cfg.reps);
+    } else {
+        printf("Crayon native bench: vocab=%zu tokens, corpus=%zu bytes, reps=%d, warmup=%d\n\n",
+               vocab_size, corpus_length, cfg.reps, cfg.warmup);
+    }
+
+    bench_tokenize(&cfg, CRAYON_VIEW_NODE, trie->root, "trie", corpus, corpus_length);
+    int too_long;
+    CrayonHashMatcher* hash = crayon_hash_matcher_build(trie->root, &too_long);
+    if (hash) {
+        bench_tokenize(&cfg, CRAYON_VIEW_HASH, hash, "hash", corpus, corpus_length);
+        crayon_hash_matcher_free(hash);
+    } else if (!cfg.json) {
+        printf("tokenize/hash skipped: %s\n\n",
+               too_long ? "tokens longer than 16 bytes" : "out of memory");
+    }
+
+    static const int fanouts[] = {1, 2, 4, 8, 16, 17, 32, 64, 128, 256};
+    for (size_t i = 0; i < sizeof(fanouts) / sizeof(fanouts[0]); i++) {
+        bench_find_child(&cfg, fanouts[i]);
+    }
+
+    static const size_t sizes[] = {16, 64, 256, 4096, 65536};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_compare_strings(&cfg, sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (sizes[i] <= corpus_length) bench_classify(&cfg, corpus, sizes[i]);
+    }
+
+    if (cfg.json) printf("\n]}\n");
+
+    if (perf_enabled) crayon_perf_close(&perf);
+    free(corpus);
+    crayon_trie_decref(trie);
+    return 0;
+}
@@ -0,0 +1,126 @@
+"""
+Profile-guided + link-time optimized build of the C extension.
+
+Runs the whole cycle reproducibly from a clean profile directory:
+
+    1. baseline   plain -O3 build, corpus suite results saved as the baseline
+    2. generate   instrumented build (CRAYON_PGO=generate)
+    3. train      corpus suite (every corpus shape, including short prompts)
+                  and the per-call latency bench as the training workload
+    4. use        rebuild with the profiles and -flto (CRAYON_PGO=use,
+                  CRAYON_LTO=1); Clang profiles are merged with llvm-profdata
+    5. compare    corpus suite against the baseline, printed by the harness
+
+The optimized extension is left in place (src/crayon/c_ext), and
+_core.BUILD_MODE reads "pgo-use+lto". Re-running starts from scratch, so
+stale profiles never leak into a build.
+
+Usage:
+    python benchmarks/pgo_build.py
+    python benchmarks/pgo_build.py --reps 9 --size-mb 4
+    python benchmarks/pgo_build.py --no-baseline      # just build, no comparison
+    CC=clang python benchmarks/pgo_build.py
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+import sys
+from typing import Dict, List, Optional
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BENCH_DIR = os.path.join(REPO_ROOT, "benchmarks")
+
+
+def run(cmd: List[str], env: Optional[Dict[str, str]] = None, quiet: bool = False) -> None:
+    print("+ " + " ".join(cmd), flush=True)
+    full_env = dict(os.environ)
+    full_env["PYTHONPATH"] = os.pathsep.join(
+        p for p in (os.path.join(REPO_ROOT, "src"), os.environ.get("PYTHONPATH")) if p)
+    full_env.update(env or {})
+    subprocess.run(cmd, cwd=REPO_ROOT, env=full_env, check=True,
+                   stdout=subprocess.DEVNULL if quiet else None)
+
+
+def build(build_temp: str, env: Dict[str, str]) -> None:
+    # Clear every knob, then set this phase's
+    phase_env = {"CRAYON_PGO": "", "CRAYON_LTO": "", **env}
+    run([sys.executable, "setup.py", "-q", "build_ext", "--inplace", "--force",
+         "--build-temp", build_temp], env=phase_env, quiet=True)
+
+
+def suite(args, extra: List[str], quiet: bool = False) -> None:
+    run([sys.executable, os.path.join(BENCH_DIR, "corpus_suite.py"),
+         "--size-mb", str(args.size_mb)] + extra, quiet=quiet)
+
+
+def merge_clang_profiles(profile_dir: str) -> None:
+    raw = glob.glob(os.path.join(profile_dir, "*.profraw"))
+    if not raw:
+        return  # GCC: .gcda files are read directly
+    tool = shutil.which("llvm-profdata")
+    if not tool:
+        sys.exit("Clang profiles found but llvm-profdata is not on PATH")
+    run([tool, "merge", "-output", os.path.join(profile_dir, "default.profdata")] + raw)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="PGO + LTO build of the Crayon extension")
+    parser.add_argument("--work-dir", default=os.path.join(REPO_ROOT, "build", "pgo"),
+                        help="profiles, objects and results go here (wiped first)")
+    parser.add_argument("--size-mb", type=float, default=2.0, help="bytes per benchmark corpus")
+    parser.add_argument("--reps", type=int, default=7, help="timed reps for the comparison")
+    parser.add_argument("--train-calls", type=int, default=200000,
+                        help="calls per entry point in the latency training run")
+    parser.add_argument("--no-baseline", action="store_true",
+                        help="skip the plain build and the comparison")
+    parser.add_argument("--no-lto", action="store_true", help="PGO only")
+    args = parser.parse_args(argv)
+
+    work = os.path.abspath(args.work_dir)
+    profile_dir = os.path.join(work, "profile")
+    shutil.rmtree(work, ignore_errors=True)
+    os.makedirs(profile_dir)
+    baseline = os.path.join(work, "baseline.json")
+
+    if not args.no_baseline:
+        print("== baseline: plain -O3 build", flush=True)
+        build(os.path.join(work, "obj-release"), {})
+        suite(args, ["--reps", str(args.reps), "--output", baseline])
+
+    # generate and use must compile into the same directory: GCC names each
+    # .gcda after its object path
+    objects = os.path.join(work, "obj-pgo")
+    pgo_env = {"CRAYON_PGO_DIR": profile_dir}
+
+    print("== generate: instrumented build", flush=True)
+    build(objects, {**pgo_env, "CRAYON_PGO": "generate"})
+
+    print("== train: benchmark corpora + per-call latency", flush=True)
+    suite(args, ["--reps", "2", "--warmup", "0"], quiet=True)
+    run([sys.executable, os.path.join(BENCH_DIR, "latency_bench.py"),
+         "--calls", str(args.train_calls), "--prompts", "2000"], quiet=True)
+    merge_clang_profiles(profile_dir)
+    if not os.listdir(profile_dir):
+        sys.exit("training run wrote no profiles")
+
+    mode = "PGO" if args.no_lto else "PGO + LTO"
+    print(f"== use: {mode} build", flush=True)
+    build(objects, {**pgo_env, "CRAYON_PGO": "use", "CRAYON_LTO": "" if args.no_lto else "1"})
+
+    if not args.no_baseline:
+        print(f"== compare: {mode} against the plain build", flush=True)
+        # Improvements are the point; only a regression makes this non-zero
+        try:
+            suite(args, ["--reps", str(args.reps), "--baseline", baseline,
+                         "--output", os.path.join(work, "pgo.json")])
+        except subprocess.CalledProcessError as e:
+            print(f"{mode} build regressed vs plain (see the comparison above)", flush=True)
+            return e.returncode
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
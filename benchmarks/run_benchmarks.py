@@ -34,7 +34,9 @@ def main():
     
     # 3. Run Benchmarks
     print("\n[2] Running Corpus Benchmarks...")
-    bench = CrayonBenchmark(vocab, corpora)
+    bench = CrayonBenchmark(vocab, corpora, perf_counters="--perf" in sys.argv)
+    if "--perf" in sys.argv and bench.perf is None:
+        print("    perf_event_open unavailable; hardware counters skipped")
     results = bench.run_benchmarks(iterations=5)
     
     # 4. Report
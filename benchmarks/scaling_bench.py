@@ -0,0 +1,257 @@
+"""
+Multi-thread and multi-process scaling benchmark.
+
+Weak scaling: every worker tokenizes the same fixed set of documents, all
+workers start together on a barrier, and aggregate tokens/s is total tokens
+over wall time. Modes:
+
+    threads          One process, N threads. Documents are >= 4 KB, so the
+                     C extension releases the GIL while matching; on a
+                     free-threaded build there is no GIL at all.
+    procs-shared     N forked processes inheriting the parent's compiled
+                     trie (copy-on-write pages that are never written).
+    procs-private    N forked processes that each rebuild the vocab and
+                     trie after fork (no sharing).
+
+For each worker count the table shows tokens/s, per-core efficiency
+(throughput / (min(N, cores) x single-worker throughput)) and RSS/PSS per
+worker from /proc/<pid>/smaps_rollup (PSS splits shared pages fairly, so it
+shows what the trie sharing actually saves).
+
+Usage:
+    python benchmarks/scaling_bench.py --max-workers 64
+    python benchmarks/scaling_bench.py --modes threads --json scaling.json --plot scaling.png
+"""
+
+import argparse
+import json
+import multiprocessing as mp
+import os
+import random
+import sys
+import sysconfig
+import threading
+import time
+from typing import Dict, List, Optional
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, script_dir)
+
+from crayon.core.vocabulary import CrayonVocab
+from corpus_suite import DEFAULT_VOCAB, gen_english_prose
+
+MODES = ("threads", "procs-shared", "procs-private")
+
+# ----------------------------------------------------------------------------
+# Memory Accounting
+# ----------------------------------------------------------------------------
+
+
+def memory_kb(pid: str = "self") -> Dict[str, int]:
+    """RSS and PSS in KiB (Linux smaps_rollup); empty dict elsewhere."""
+    try:
+        with open(f"/proc/{pid}/smaps_rollup") as f:
+            fields = {}
+            for line in f:
+                key, _, rest = line.partition(":")
+                if key in ("Rss", "Pss"):
+                    fields[key.lower() + "_kb"] = int(rest.split()[0])
+            return fields
+    except OSError:
+        return {}
+
+
+def gil_enabled() -> bool:
+    check = getattr(sys, "_is_gil_enabled", None)
+    return check() if check is not None else True
+
+# ----------------------------------------------------------------------------
+# Workers
+# ----------------------------------------------------------------------------
+
+
+def load_vocab(path: str) -> CrayonVocab:
+    return CrayonVocab.from_json(path) if path.endswith(".json") else CrayonVocab.from_file(path)
+
+
+def _tokenize_all(vocab: CrayonVocab, docs: List[str], rounds: int) -> int:
+    tokenize = vocab.tokenize
+    total = 0
+    for _ in range(rounds):
+        for doc in docs:
+            total += len(tokenize(doc))
+    return total
+
+
+def _process_worker(vocab: Optional[CrayonVocab], vocab_path: str, docs: List[str],
+                    rounds: int, barrier, results) -> None:
+    if vocab is None:
+        vocab = load_vocab(vocab_path)  # procs-private: own trie per process
+    barrier.wait()
+    tokens = _tokenize_all(vocab, docs, rounds)
+    results.put((tokens, memory_kb()))
+
+
+def run_threads(vocab: CrayonVocab, docs: List[str], rounds: int, workers: int):
+    barrier = threading.Barrier(workers + 1)
+    counts = [0] * workers
+
+    def work(i: int) -> None:
+        barrier.wait()
+        counts[i] = _tokenize_all(vocab, docs, rounds)
+
+    threads = [threading.Thread(target=work, args=(i,)) for i in range(workers)]
+    for t in threads:
+        t.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for t in threads:
+        t.join()
+    elapsed = time.perf_counter() - start
+
+    # One address space: per-worker memory is the process total split N ways
+    mem = memory_kb()
+    return sum(counts), elapsed, {k: v / workers for k, v in mem.items()}
+
+
+def run_processes(vocab: CrayonVocab, vocab_path: str, docs: List[str], rounds: int,
+                  workers: int, shared: bool):
+    ctx = mp.get_context("fork")
+    barrier = ctx.Barrier(workers + 1)
+    results = ctx.Queue()
+    procs = [ctx.Process(target=_process_worker,
+                         args=(vocab if shared else None, vocab_path, docs, rounds,
+                               barrier, results))
+             for _ in range(workers)]
+    for p in procs:
+        p.start()
+    barrier.wait()
+    start = time.perf_counter()
+    reports = [results.get() for _ in procs]
+    elapsed = time.perf_counter() - start
+    for p in procs:
+        p.join()
+
+    mem: Dict[str, float] = {}
+    for _, m in reports:
+        for k, v in m.items():
+            mem[k] = mem.get(k, 0) + v / workers
+    return sum(t for t, _ in reports), elapsed, mem
+
+# ----------------------------------------------------------------------------
+# Reporting
+# ----------------------------------------------------------------------------
+
+
+def worker_counts(max_workers: int) -> List[int]:
+    counts, n = [], 1
+    while n < max_workers:
+        counts.append(n)
+        n *= 2
+    counts.append(max_workers)
+    return counts
+
+
+def plot(results: Dict, path: str) -> None:
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib not installed; --plot skipped")
+        return
+    fig, (ax_tput, ax_eff) = plt.subplots(1, 2, figsize=(11, 4))
+    for mode, rows in results["modes"].items():
+        xs = [r["workers"] for r in rows]
+        ax_tput.plot(xs, [r["tokens_per_s"] / 1e6 for r in rows], marker="o", label=mode)
+        ax_eff.plot(xs, [r["efficiency"] for r in rows], marker="o", label=mode)
+    ax_tput.set(xlabel="workers", ylabel="M tokens/s", xscale="log", title="Throughput")
+    ax_eff.set(xlabel="workers", ylabel="per-core efficiency", xscale="log", ylim=(0, 1.1),
+               title="Efficiency")
+    for ax in (ax_tput, ax_eff):
+        ax.grid(True, alpha=0.3)
+        ax.legend()
+    fig.tight_layout()
+    fig.savefig(path, dpi=120)
+    print(f"plot written to {path}")
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Crayon thread/process scaling benchmark")
+    parser.add_argument("--vocab", default=DEFAULT_VOCAB)
+    parser.add_argument("--max-workers", type=int, default=min(64, 2 * (os.cpu_count() or 1)))
+    parser.add_argument("--modes", default=",".join(MODES), help="comma-separated subset of " + ",".join(MODES))
+    parser.add_argument("--docs", type=int, default=16, help="documents per worker")
+    parser.add_argument("--doc-kb", type=int, default=64, help="document size (>= 4 releases the GIL)")
+    parser.add_argument("--rounds", type=int, default=2, help="passes over the documents per worker")
+    parser.add_argument("--json", help="write results here")
+    parser.add_argument("--plot", help="write a throughput/efficiency PNG here (needs matplotlib)")
+    args = parser.parse_args(argv)
+
+    modes = [m for m in args.modes.split(",") if m]
+    unknown = set(modes) - set(MODES)
+    if unknown:
+        parser.error(f"unknown modes: {', '.join(sorted(unknown))}")
+    if "fork" not in mp.get_all_start_methods():
+        modes = [m for m in modes if m == "threads"]
+        print("fork unavailable on this platform; process modes skipped")
+
+    vocab = load_vocab(args.vocab)
+    rng = random.Random(86)
+    docs = [gen_english_prose(rng, args.doc_kb * 1024) for _ in range(args.docs)]
+    cores = os.cpu_count() or 1
+
+    results = {
+        "meta": {
+            "cores": cores,
+            "python": sys.version.split()[0],
+            "free_threaded": bool(sysconfig.get_config_var("Py_GIL_DISABLED")),
+            "gil_enabled": gil_enabled(),
+            "c_ext": vocab._c_ext_available,
+            "vocab_size": len(vocab),
+            "bytes_per_worker": args.docs * args.doc_kb * 1024 * args.rounds,
+        },
+        "modes": {},
+    }
+    print(f"Crayon scaling bench: {cores} cores, GIL {'on' if gil_enabled() else 'off'}, "
+          f"c_ext={vocab._c_ext_available}, {results['meta']['bytes_per_worker'] / 1e6:.1f} MB/worker")
+
+    for mode in modes:
+        print(f"\n[{mode}]")
+        print(f"{'workers':>7} {'M tok/s':>9} {'speedup':>8} {'eff':>6} {'RSS MB/w':>9} {'PSS MB/w':>9}")
+        rows = []
+        single = None
+        for n in worker_counts(args.max_workers):
+            if mode == "threads":
+                run = lambda rounds: run_threads(vocab, docs, rounds, n)
+            else:
+                run = lambda rounds: run_processes(vocab, args.vocab, docs, rounds, n,
+                                                   shared=(mode == "procs-shared"))
+            # Untimed pass first: a cold n=1 baseline inflates every efficiency
+            run(1)
+            tokens, elapsed, mem = run(args.rounds)
+            tput = tokens / elapsed
+            single = single or tput
+            row = {
+                "workers": n,
+                "tokens_per_s": tput,
+                "speedup": tput / single,
+                "efficiency": tput / (min(n, cores) * single),
+                "rss_mb_per_worker": mem.get("rss_kb", 0) / 1024,
+                "pss_mb_per_worker": mem.get("pss_kb", 0) / 1024,
+            }
+            rows.append(row)
+            print(f"{n:>7} {tput / 1e6:>9.2f} {row['speedup']:>8.2f} {row['efficiency']:>6.2f} "
+                  f"{row['rss_mb_per_worker']:>9.1f} {row['pss_mb_per_worker']:>9.1f}")
+        results["modes"][mode] = rows
+
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(results, f, indent=2)
+    if args.plot:
+        plot(results, args.plot)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
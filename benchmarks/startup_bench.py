@@ -0,0 +1,183 @@
+"""
+Startup and cold-cache benchmark for vocabulary loading.
+
+Every measurement runs in a fresh interpreter so import, load and first
+call costs are real. For each load path it reports, as medians over
+--reps runs:
+
+    import_ms    import crayon.core.vocabulary
+    load_ms      vocabulary constructor for the path
+    ttft_ms      import + load + first tokenize() call (time to first token)
+    peak_rss_mb  peak RSS of the child from the start of the import (VmHWM
+                 reset via /proc/self/clear_refs; ru_maxrss elsewhere)
+
+Load paths:
+
+    json    CrayonVocab.from_json (parse, Python tables, C trie build)
+    txt     CrayonVocab.from_file
+    image   CrayonVocab.from_image (binary image with the compiled trie)
+    shm     CrayonVocab.from_shared_memory (image attached by name)
+
+The cold variant drops the vocab file and the C extension from the page
+cache with posix_fadvise(POSIX_FADV_DONTNEED) before each run, so disk
+reads are included. It needs Linux; shm has no file to evict.
+
+Usage:
+    python benchmarks/startup_bench.py --reps 7
+    python benchmarks/startup_bench.py --vocab trained_vocab.json --json startup.json
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+from typing import Dict, List, Optional
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, script_dir)
+
+from corpus_suite import DEFAULT_VOCAB
+
+PATHS = ("json", "txt", "image", "shm")
+
+# Runs in the child interpreter; prints one JSON line
+_CHILD = r"""
+import json, resource, sys, time
+
+def peak_rss_kb():
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+
+try:
+    # Interpreter startup can peak above the load itself; restart the mark
+    with open("/proc/self/clear_refs", "w") as f:
+        f.write("5")
+except OSError:
+    pass
+t0 = time.perf_counter()
+from crayon.core.vocabulary import CrayonVocab
+t1 = time.perf_counter()
+kind, arg = sys.argv[1], sys.argv[2]
+if kind == "json":
+    vocab = CrayonVocab.from_json(arg)
+elif kind == "txt":
+    vocab = CrayonVocab.from_file(arg)
+elif kind == "image":
+    vocab = CrayonVocab.from_image(arg)
+else:
+    vocab = CrayonVocab.from_shared_memory(arg)
+t2 = time.perf_counter()
+vocab.tokenize("Time to first token.")
+t3 = time.perf_counter()
+rss_kb = peak_rss_kb()
+print(json.dumps({
+    "import_ms": (t1 - t0) * 1e3,
+    "load_ms": (t2 - t1) * 1e3,
+    "ttft_ms": (t3 - t0) * 1e3,
+    "peak_rss_mb": rss_kb / 1024,
+    "c_ext": vocab._c_ext_available,
+}))
+"""
+
+
+def evict(paths: List[str]) -> bool:
+    """Drops files from the page cache; False if unsupported."""
+    if not hasattr(os, "posix_fadvise"):
+        return False
+    for path in paths:
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+        finally:
+            os.close(fd)
+    return True
+
+
+def extension_path() -> Optional[str]:
+    try:
+        from crayon.c_ext import _core
+        return _core.__file__
+    except ImportError:
+        return None
+
+
+def run_child(kind: str, arg: str) -> Dict:
+    env = dict(os.environ)
+    src = os.path.join(os.path.dirname(script_dir), "src")
+    env["PYTHONPATH"] = src + os.pathsep + env.get("PYTHONPATH", "")
+    out = subprocess.run([sys.executable, "-c", _CHILD, kind, arg], env=env,
+                         capture_output=True, text=True, check=True)
+    return json.loads(out.stdout.strip().splitlines()[-1])
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Crayon vocabulary startup benchmark")
+    parser.add_argument("--vocab", default=DEFAULT_VOCAB, help="source vocab (.json)")
+    parser.add_argument("--reps", type=int, default=5)
+    parser.add_argument("--paths", default=",".join(PATHS))
+    parser.add_argument("--no-cold", action="store_true", help="skip the cold page-cache variant")
+    parser.add_argument("--json", help="write results here")
+    args = parser.parse_args(argv)
+
+    from crayon.core.vocabulary import CrayonVocab
+
+    # Materialize every format from the same source vocabulary
+    vocab = CrayonVocab.from_json(args.vocab)
+    workdir = tempfile.mkdtemp(prefix="crayon_startup_")
+    files = {"json": args.vocab,
+             "txt": os.path.join(workdir, "vocab.txt"),
+             "image": os.path.join(workdir, "vocab.img")}
+    vocab.save(files["txt"], format="txt")
+    vocab.save(files["image"], format="image")
+    shm = vocab.to_shared_memory()
+    ext = extension_path()
+
+    paths = [p for p in args.paths.split(",") if p]
+    results: Dict[str, Dict] = {}
+    print(f"Crayon startup bench: vocab={len(vocab):,} tokens, reps={args.reps}")
+    print(f"{'path':<6} {'cache':<5} {'import':>8} {'load':>8} {'ttft':>8} {'rss MB':>8} {'file MB':>8}")
+    try:
+        for kind in paths:
+            arg = shm.name if kind == "shm" else files[kind]
+            size_mb = (shm.size if kind == "shm" else os.path.getsize(arg)) / 1e6
+            variants = ["warm"]
+            if not args.no_cold and kind != "shm" and hasattr(os, "posix_fadvise"):
+                variants.append("cold")
+            for variant in variants:
+                runs = []
+                run_child(kind, arg)  # Warm the interpreter's own files
+                for _ in range(args.reps):
+                    if variant == "cold":
+                        evict([arg] + ([ext] if ext else []))
+                    runs.append(run_child(kind, arg))
+                summary = {key: statistics.median(r[key] for r in runs)
+                           for key in ("import_ms", "load_ms", "ttft_ms", "peak_rss_mb")}
+                summary["file_mb"] = size_mb
+                summary["c_ext"] = runs[-1]["c_ext"]
+                results[f"{kind}/{variant}"] = summary
+                print(f"{kind:<6} {variant:<5} {summary['import_ms']:>8.1f} {summary['load_ms']:>8.1f} "
+                      f"{summary['ttft_ms']:>8.1f} {summary['peak_rss_mb']:>8.1f} {size_mb:>8.2f}")
+    finally:
+        shm.close()
+        shm.unlink()
+        for path in (files["txt"], files["image"]):
+            os.remove(path)
+        os.rmdir(workdir)
+
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(results, f, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
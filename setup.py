@@ -7,6 +7,7 @@ Handles C-extension compilation with platform-specific AVX2 flags.
 import os
 import sys
 import platform
+import sysconfig
 from setuptools import setup, Extension, find_packages
 
 # -----------------------------------------------------------------------------
@@ -52,7 +53,88 @@ def get_link_args():
     if system == 'Windows':
         return []
     else:
-        return ['-lm']  # Link math library on Unix
+        return ['-lm', '-pthread']  # Math library; pthreads for tokenize_parallel
+
+
+def get_optimization_args():
+    """
+    Profile-guided and link-time optimization from the environment.
+
+    CRAYON_LTO=1 adds -flto (/GL + /LTCG on MSVC). CRAYON_PGO=generate
+    builds an instrumented extension that writes profiles into
+    CRAYON_PGO_DIR (default build/pgo-data) while it runs; CRAYON_PGO=use
+    rebuilds with them. Both phases must compile into the same build
+    directory so the profile files match the objects.
+    benchmarks/pgo_build.py drives the whole cycle.
+
+    Returns:
+        (compile_args, link_args, macros); the macros let _core.BUILD_MODE
+        report which build this is.
+    """
+    pgo = os.environ.get("CRAYON_PGO", "").lower()
+    lto = os.environ.get("CRAYON_LTO") == "1"
+    if pgo not in ("", "generate", "use"):
+        raise SystemExit(f"CRAYON_PGO must be 'generate' or 'use', not {pgo!r}")
+    profile_dir = os.path.abspath(os.environ.get("CRAYON_PGO_DIR", os.path.join("build", "pgo-data")))
+    compile_args, link_args = [], []
+
+    if platform.system() == 'Windows':
+        if pgo:
+            print("warning: CRAYON_PGO is not supported with MSVC; ignored", file=sys.stderr)
+            pgo = ""
+        if lto:
+            compile_args.append('/GL')
+            link_args.append('/LTCG')
+    else:
+        clang = "clang" in (sysconfig.get_config_var("CC") or "") or \
+            "clang" in os.environ.get("CC", "")
+        if pgo == "generate":
+            # Atomic counters: the GIL is released for long inputs
+            flags = [f'-fprofile-generate={profile_dir}', '-fprofile-update=atomic']
+            compile_args += flags
+            link_args += flags
+        elif pgo == "use":
+            # Clang reads <dir>/default.profdata (merged by pgo_build.py)
+            flags = [f'-fprofile-use={profile_dir}']
+            if clang:
+                flags.append('-Wno-profile-instr-unprofiled')
+            else:
+                # Counters from threads are not exact; functions the
+                # workload never ran keep their normal -O3 code
+                flags += ['-fprofile-correction', '-fprofile-partial-training',
+                          '-Wno-missing-profile']
+            compile_args += flags
+            link_args += flags
+        if lto:
+            compile_args.append('-flto')
+            link_args += ['-flto', '-O3']
+
+    macros = []
+    if pgo:
+        macros.append(("CRAYON_BUILD_PGO", "1" if pgo == "generate" else "2"))
+    if lto:
+        macros.append(("CRAYON_BUILD_LTO", "1"))
+    return compile_args, link_args, macros
+
+
+def get_define_macros():
+    """
+    Optional build flags from the environment.
+
+    CRAYON_STATS=1 compiles traversal counters into the tokenize loop
+    (exposed as _core.get_stats()); release builds leave it unset.
+    _POSIX_C_SOURCE exposes posix_memalign() under -std=c99, as in
+    CMakeLists.txt.
+    """
+    macros = list(OPT_MACROS)
+    if platform.system() != 'Windows':
+        macros.append(("_POSIX_C_SOURCE", "200809L"))
+    if os.environ.get("CRAYON_STATS") == "1":
+        macros.append(("CRAYON_STATS", "1"))
+    return macros
+
+
+OPT_COMPILE_ARGS, OPT_LINK_ARGS, OPT_MACROS = get_optimization_args()
 
 
 # Define the Extension
@@ -60,11 +142,26 @@ crayon_core = Extension(
     name="crayon.c_ext._core",
     sources=[
         "src/crayon/c_ext/crayon_module.c",
-        "src/crayon/c_ext/simd_ops.c"
+        "src/crayon/c_ext/crayon_api.c",
+        "src/crayon/c_ext/crayon_kernels.c",
+        "src/crayon/c_ext/crayon_hash_match.c",
+        "src/crayon/c_ext/crayon_segment.c",
+        "src/crayon/c_ext/crayon_bpe.c",
+        "src/crayon/c_ext/crayon_parallel.c",
+        "src/crayon/c_ext/trie_builder.c",
+        "src/crayon/c_ext/simd_ops.c",
+        "src/crayon/c_ext/byte_tables.c",
+        "src/crayon/c_ext/corpus_reader.c",
+        "src/crayon/c_ext/perf_counters.c",
+        "src/crayon/c_ext/crayon_stats.c",
+        "src/crayon/c_ext/trie_image.c",
+        "src/crayon/c_ext/crayon_metrics.c",
+        "src/crayon/c_ext/crayon_profiler.c",
     ],
     include_dirs=["src/crayon/c_ext"],
-    extra_compile_args=get_compile_args(),
-    extra_link_args=get_link_args(),
+    define_macros=get_define_macros(),
+    extra_compile_args=get_compile_args() + OPT_COMPILE_ARGS,
+    extra_link_args=get_link_args() + OPT_LINK_ARGS,
     optional=False  # Fail installation if C extension cannot be built
 )
 
@@ -122,6 +219,8 @@ setup(
         "License :: OSI Approved :: MIT License",
         "Programming Language :: Python :: 3",
         "Programming Language :: Python :: 3.12",
+        "Programming Language :: Python :: 3.13",
+        "Programming Language :: Python :: Free Threading :: 2 - Beta",
         "Programming Language :: C",
         "Topic :: Scientific/Engineering :: Artificial Intelligence",
         "Topic :: Text Processing :: Linguistic",
@@ -32,6 +32,7 @@ from .core.vocabulary import CrayonVocab
 from .concurrency.pipeline import PipelineTokenizer
 from .memory.zerocopy import ZeroCopyTokenizer
 from .training import train_vocabulary, build_default_vocabulary
+from . import metrics
 
 __version__ = "1.1.0"
 __author__ = "Xerv Research Engineering Division"
@@ -47,6 +48,8 @@ __all__ = [
     # Training
     "train_vocabulary",
     "build_default_vocabulary",
+    # Observability
+    "metrics",
 ]
 
 
@@ -0,0 +1,37 @@
+// Generated by tools/gen_byte_tables.py -- do not edit.
+
+#ifndef CRAYON_BYTE_TABLES_H
+#define CRAYON_BYTE_TABLES_H
+
+#include <stdint.h>
+
+// crayon_byte_class bits
+#define CRAYON_BYTE_ALPHA      0x01  // ASCII letter
+#define CRAYON_BYTE_DIGIT      0x02  // ASCII digit
+#define CRAYON_BYTE_SPACE      0x04  // ASCII whitespace (space, \t \n \v \f \r)
+#define CRAYON_BYTE_PUNCT      0x08  // ASCII punctuation
+#define CRAYON_BYTE_UPPER      0x10  // ASCII upper-case letter
+#define CRAYON_BYTE_CONTROL    0x20  // C0 control or DEL
+#define CRAYON_BYTE_UTF8_CONT  0x40  // UTF-8 continuation byte
+#define CRAYON_BYTE_UTF8_LEAD  0x80  // UTF-8 multi-byte lead (C2..F4)
+
+// Nibble-table bits per vector class (see crayon_nibble_lo/hi)
+#define CRAYON_NIBBLE_ALPHA  0x03
+#define CRAYON_NIBBLE_DIGIT  0x04
+#define CRAYON_NIBBLE_SPACE  0x18
+
+extern const uint8_t crayon_byte_class[256];
+
+// UTF-8 sequence length by lead byte; 0 for continuation bytes and
+// leads that can only start overlong or out-of-range sequences
+extern const uint8_t crayon_utf8_length[256];
+
+// Well-formed second-byte range by lead byte, indexed lead - 0xC0
+extern const uint8_t crayon_utf8_second_min[64];
+extern const uint8_t crayon_utf8_second_max[64];
+
+// PSHUFB lookup by low and high nibble: class bits = lo[b & 15] & hi[b >> 4]
+extern const uint8_t crayon_nibble_lo[16];
+extern const uint8_t crayon_nibble_hi[16];
+
+#endif // CRAYON_BYTE_TABLES_H
@@ -0,0 +1,377 @@
+#include "corpus_reader.h"
+#include "simd_ops.h"
+#include <string.h>
+
+// Maximum nesting depth of a JSONL field path ("a.b.c" = 3)
+#define MAX_PATH_SEGMENTS 16
+
+// ----------------------------------------------------------------------------
+// JSON Helpers
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    const char* name;
+    size_t length;
+} PathSegment;
+
+static inline uint8_t* skip_ws(uint8_t* p, uint8_t* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+static inline int hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static inline long parse_hex4(const uint8_t* p, const uint8_t* end) {
+    if (end - p < 4) return -1;
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_value(p[i]);
+        if (h < 0) return -1;
+        value = (value << 4) | h;
+    }
+    return value;
+}
+
+static inline uint8_t* encode_utf8(uint8_t* w, uint32_t cp) {
+    if (cp < 0x80) {
+        *w++ = (uint8_t)cp;
+    } else if (cp < 0x800) {
+        *w++ = (uint8_t)(0xC0 | (cp >> 6));
+        *w++ = (uint8_t)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *w++ = (uint8_t)(0xE0 | (cp >> 12));
+        *w++ = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (uint8_t)(0x80 | (cp & 0x3F));
+    } else {
+        *w++ = (uint8_t)(0xF0 | (cp >> 18));
+        *w++ = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+        *w++ = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (uint8_t)(0x80 | (cp & 0x3F));
+    }
+    return w;
+}
+
+/**
+ * @brief Unescape a JSON string in place.
+ *
+ * p points just past the opening quote. The decoded bytes are written
+ * starting at p; every escape is at least as long as its encoding, so the
+ * write cursor never overtakes the read cursor.
+ *
+ * @return Pointer just past the closing quote, or NULL if malformed.
+ */
+static uint8_t* json_unescape_string(uint8_t* p, uint8_t* end, size_t* out_length) {
+    uint8_t* r = p;
+    uint8_t* w = p;
+
+    for (;;) {
+        // Jump to the next quote or backslash 32 bytes at a time
+        size_t run = find_any2_avx2(r, (size_t)(end - r), '"', '\\');
+        if (w != r) memmove(w, r, run);
+        w += run;
+        r += run;
+        if (r >= end) return NULL;
+
+        if (*r == '"') {
+            *out_length = (size_t)(w - p);
+            return r + 1;
+        }
+
+        if (r + 1 >= end) return NULL;
+        uint8_t esc = r[1];
+        r += 2;
+        switch (esc) {
+            case '"':  *w++ = '"';  break;
+            case '\\': *w++ = '\\'; break;
+            case '/':  *w++ = '/';  break;
+            case 'b':  *w++ = '\b'; break;
+            case 'f':  *w++ = '\f'; break;
+            case 'n':  *w++ = '\n'; break;
+            case 'r':  *w++ = '\r'; break;
+            case 't':  *w++ = '\t'; break;
+            case 'u': {
+                long cp = parse_hex4(r, end);
+                if (cp < 0) return NULL;
+                r += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    // Combine surrogate pair if the low half follows
+                    long low = (end - r >= 6 && r[0] == '\\' && r[1] == 'u')
+                        ? parse_hex4(r + 2, end) : -1;
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        r += 6;
+                    } else {
+                        cp = 0xFFFD;
+                    }
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    // Lone low surrogate cannot be encoded as UTF-8
+                    cp = 0xFFFD;
+                }
+                w = encode_utf8(w, (uint32_t)cp);
+                break;
+            }
+            default:
+                return NULL;
+        }
+    }
+}
+
+static uint8_t* json_skip_string(uint8_t* p, uint8_t* end) {
+    for (;;) {
+        p += find_any2_avx2(p, (size_t)(end - p), '"', '\\');
+        if (p >= end) return NULL;
+        if (*p == '"') return p + 1;
+        p += 2;  // Skip escaped character
+        if (p > end) return NULL;
+    }
+}
+
+/**
+ * @brief Skip one JSON value of any type.
+ * @return Pointer just past the value, or NULL if malformed.
+ */
+static uint8_t* json_skip_value(uint8_t* p, uint8_t* end) {
+    if (p >= end) return NULL;
+
+    if (*p == '"') return json_skip_string(p + 1, end);
+
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            uint8_t c = *p;
+            if (c == '"') {
+                p = json_skip_string(p + 1, end);
+                if (!p) return NULL;
+                continue;
+            }
+            if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            p++;
+        }
+        return NULL;
+    }
+
+    // Number / true / false / null
+    uint8_t* start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+           *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+        p++;
+    }
+    return p > start ? p : NULL;
+}
+
+/**
+ * @brief Locate the string value at a key path inside one JSON object.
+ *
+ * Like json.loads, a repeated key takes its last value: the whole object is
+ * scanned and only the last occurrence of each path segment counts.
+ *
+ * @return 1 if found (value in *value, length in *value_length), 0 otherwise.
+ */
+static int json_find_path(uint8_t* p, uint8_t* end, const PathSegment* path,
+                          int depth, int segment_count,
+                          uint8_t** value, size_t* value_length) {
+    p = skip_ws(p, end);
+    if (p >= end || *p != '{') return 0;
+    p = skip_ws(p + 1, end);
+    if (p < end && *p == '}') return 0;
+
+    int found = 0;
+    while (p < end) {
+        if (*p != '"') return 0;
+        uint8_t* key = p + 1;
+        size_t key_length = 0;
+        p = json_unescape_string(key, end, &key_length);
+        if (!p) return 0;
+
+        p = skip_ws(p, end);
+        if (p >= end || *p != ':') return 0;
+        p = skip_ws(p + 1, end);
+        if (p >= end) return 0;
+
+        // Skip before matching: unescaping in place would break the skip
+        uint8_t* value_end = json_skip_value(p, end);
+        if (!value_end) return 0;
+
+        const PathSegment* seg = &path[depth];
+        if (key_length == seg->length && memcmp(key, seg->name, key_length) == 0) {
+            uint8_t* match = NULL;
+            size_t match_length = 0;
+            if (depth + 1 < segment_count) {
+                found = json_find_path(p, value_end, path, depth + 1, segment_count,
+                                       &match, &match_length);
+            } else {
+                // Non-string leaf is ignored
+                found = *p == '"' && json_unescape_string(p + 1, value_end, &match_length);
+                match = p + 1;
+            }
+            if (found) {
+                *value = match;
+                *value_length = match_length;
+            }
+        }
+
+        p = skip_ws(value_end, end);
+        if (p < end && *p == '}') return found;
+        if (p >= end || *p != ',') return 0;  // Garbage: json.loads rejects the line
+        p = skip_ws(p + 1, end);
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// JSONL Scanner
+// ----------------------------------------------------------------------------
+
+long long crayon_scan_jsonl(uint8_t* buf, size_t length, const char* field_path,
+                            crayon_field_cb cb, void* ctx, long long max_records) {
+    // Split the dotted path into segments
+    PathSegment path[MAX_PATH_SEGMENTS];
+    int segment_count = 0;
+    const char* s = field_path;
+    for (;;) {
+        const char* dot = strchr(s, '.');
+        size_t seg_len = dot ? (size_t)(dot - s) : strlen(s);
+        if (seg_len == 0 || segment_count == MAX_PATH_SEGMENTS) {
+            return CRAYON_READER_ERR_FIELD;
+        }
+        path[segment_count].name = s;
+        path[segment_count].length = seg_len;
+        segment_count++;
+        if (!dot) break;
+        s = dot + 1;
+    }
+
+    long long emitted = 0;
+    size_t pos = 0;
+
+    while (pos < length) {
+        if (max_records >= 0 && emitted >= max_records) break;
+
+        // JSON strings cannot contain raw newlines, so lines are records
+        size_t line_length = find_byte_avx2(buf + pos, length - pos, '\n');
+        uint8_t* line = buf + pos;
+        uint8_t* line_end = line + line_length;
+        pos += line_length + 1;
+
+        uint8_t* value = NULL;
+        size_t value_length = 0;
+        if (!json_find_path(line, line_end, path, 0, segment_count,
+                            &value, &value_length)) {
+            continue;
+        }
+        if (value_length == 0) continue;
+
+        int rc = cb(value, value_length, ctx);
+        if (rc < 0) return rc;
+        emitted++;
+    }
+    return emitted;
+}
+
+// ----------------------------------------------------------------------------
+// CSV Scanner
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Parse one CSV field starting at p.
+ *
+ * Quoted fields are unescaped in place. *terminator receives ',' or '\n'
+ * (also used for end of buffer).
+ *
+ * @return Pointer to the start of the next field.
+ */
+static uint8_t* csv_parse_field(uint8_t* p, uint8_t* end, uint8_t** field,
+                                size_t* field_length, uint8_t* terminator) {
+    if (p < end && *p == '"') {
+        uint8_t* r = p + 1;
+        uint8_t* w = p + 1;
+        *field = w;
+        for (;;) {
+            size_t run = find_byte_avx2(r, (size_t)(end - r), '"');
+            if (w != r) memmove(w, r, run);
+            w += run;
+            r += run;
+            if (r >= end) break;  // Unterminated quote: take the rest
+            if (r + 1 < end && r[1] == '"') {
+                *w++ = '"';
+                r += 2;
+                continue;
+            }
+            r++;  // Closing quote
+            break;
+        }
+        *field_length = (size_t)(w - *field);
+
+        // Ignore stray bytes between the closing quote and the delimiter
+        r += find_any2_avx2(r, (size_t)(end - r), ',', '\n');
+        if (r >= end) {
+            *terminator = '\n';
+            return end;
+        }
+        *terminator = *r;
+        return r + 1;
+    }
+
+    size_t run = find_any2_avx2(p, (size_t)(end - p), ',', '\n');
+    *field = p;
+    *field_length = run;
+    uint8_t* r = p + run;
+    *terminator = (r < end) ? *r : '\n';
+    if (*terminator == '\n' && run > 0 && p[run - 1] == '\r') {
+        (*field_length)--;
+    }
+    return (r < end) ? r + 1 : end;
+}
+
+long long crayon_scan_csv(uint8_t* buf, size_t length, const char* column,
+                          crayon_field_cb cb, void* ctx, long long max_records) {
+    uint8_t* p = buf;
+    uint8_t* end = buf + length;
+    size_t column_length = strlen(column);
+
+    // Skip UTF-8 BOM
+    if (length >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) p += 3;
+
+    // 1. Header: resolve the column index
+    long target = -1;
+    long index = 0;
+    uint8_t terminator = ',';
+    while (p < end && terminator == ',') {
+        uint8_t* field;
+        size_t field_length;
+        p = csv_parse_field(p, end, &field, &field_length, &terminator);
+        if (target < 0 && field_length == column_length &&
+            memcmp(field, column, column_length) == 0) {
+            target = index;
+        }
+        index++;
+    }
+    if (target < 0) return CRAYON_READER_ERR_COLUMN;
+
+    // 2. Records
+    long long emitted = 0;
+    index = 0;
+    while (p < end) {
+        if (max_records >= 0 && emitted >= max_records) break;
+
+        uint8_t* field;
+        size_t field_length;
+        p = csv_parse_field(p, end, &field, &field_length, &terminator);
+
+        if (index == target && field_length > 0) {
+            int rc = cb(field, field_length, ctx);
+            if (rc < 0) return rc;
+            emitted++;
+        }
+        index = (terminator == '\n') ? 0 : index + 1;
+    }
+    return emitted;
+}
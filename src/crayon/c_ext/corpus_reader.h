@@ -0,0 +1,56 @@
+#ifndef CRAYON_CORPUS_READER_H
+#define CRAYON_CORPUS_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Callback receiving one extracted (already unescaped) field.
+ *
+ * The bytes point into the reader's own buffer and are only valid for
+ * the duration of the call.
+ *
+ * @return 0 to continue scanning, or a negative code to abort with it.
+ */
+typedef int (*crayon_field_cb)(const uint8_t* data, size_t length, void* ctx);
+
+// Error codes returned by the scanners (records emitted are >= 0)
+#define CRAYON_READER_ERR_COLUMN  -1   // CSV column missing from the header
+#define CRAYON_READER_ERR_FIELD   -2   // Malformed field path
+#define CRAYON_READER_ERR_NOMEM   -3   // Reserved for callbacks that fail to allocate
+
+/**
+ * @brief Extract one string field from every line of a JSONL buffer.
+ *
+ * Lines are split with an AVX2 newline scan; string values are unescaped
+ * in place (including \uXXXX and surrogate pairs), so the buffer is
+ * modified. Malformed lines and non-string values are skipped, matching
+ * the Python reader.
+ *
+ * @param buf Mutable file contents.
+ * @param length Number of bytes in buf.
+ * @param field_path Dot-separated key path, e.g. "question" or "meta.text".
+ * @param cb Callback invoked once per extracted field.
+ * @param ctx Opaque pointer passed to cb.
+ * @param max_records Stop after this many fields (negative for no limit).
+ * @return Number of fields emitted, a CRAYON_READER_ERR_* code, or the
+ *         callback's negative return value if it aborted.
+ */
+long long crayon_scan_jsonl(uint8_t* buf, size_t length, const char* field_path,
+                            crayon_field_cb cb, void* ctx, long long max_records);
+
+/**
+ * @brief Extract one column from every record of an RFC 4180 CSV buffer.
+ *
+ * The first record is the header and selects the column by name. Quoted
+ * fields may span lines; doubled quotes are collapsed in place. Empty
+ * fields and blank lines are skipped, matching csv.DictReader usage in
+ * resources.py.
+ *
+ * @return Number of fields emitted, a CRAYON_READER_ERR_* code, or the
+ *         callback's negative return value if it aborted.
+ */
+long long crayon_scan_csv(uint8_t* buf, size_t length, const char* column,
+                          crayon_field_cb cb, void* ctx, long long max_records);
+
+#endif // CRAYON_CORPUS_READER_H
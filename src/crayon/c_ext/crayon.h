@@ -0,0 +1,144 @@
+#ifndef CRAYON_H
+#define CRAYON_H
+
+/**
+ * @brief libcrayon: the Crayon tokenizer core as a plain C library.
+ *
+ * This is the only header installed with libcrayon and the only one a C,
+ * C++ or Rust (bindgen) consumer needs. Tries are opaque, immutable and
+ * reference counted: one trie may be used by any number of threads at
+ * once, and every function here is safe to call concurrently.
+ *
+ * Token IDs are the index of the token in the list passed to
+ * crayon_build(); bytes that start no token are emitted as the caller's
+ * UNK ID, one per byte. Tokenization is greedy longest match on UTF-8 (or
+ * arbitrary) bytes, exactly as in the Python package.
+ *
+ * Compatibility: CRAYON_ABI_VERSION is bumped (and the shared library's
+ * SONAME with it) whenever a declaration below changes incompatibly.
+ * Additions only raise CRAYON_VERSION_MINOR.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRAYON_VERSION_MAJOR 1
+#define CRAYON_VERSION_MINOR 2
+#define CRAYON_VERSION_PATCH 0
+#define CRAYON_VERSION_STRING "1.2.0"
+#define CRAYON_ABI_VERSION 1
+
+#if defined(_WIN32) && defined(CRAYON_SHARED)
+    #if defined(CRAYON_BUILDING_LIBRARY)
+        #define CRAYON_API __declspec(dllexport)
+    #else
+        #define CRAYON_API __declspec(dllimport)
+    #endif
+#elif defined(__GNUC__)
+    #define CRAYON_API __attribute__((visibility("default")))
+#else
+    #define CRAYON_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Status codes (0 or negative)
+#define CRAYON_OK          0
+#define CRAYON_ENOMEM     -1    // Allocation failed
+#define CRAYON_EINVAL     -2    // NULL or out-of-range argument
+#define CRAYON_EMALFORMED -3    // Trie image failed validation
+
+typedef struct CrayonTrie crayon_trie;
+
+/**
+ * @brief Version of the library actually loaded (may differ from the
+ *        header's CRAYON_VERSION_STRING when linked dynamically).
+ */
+CRAYON_API const char* crayon_version(void);
+
+/**
+ * @brief Compile a vocabulary into a trie.
+ *
+ * @param tokens Token byte strings; token i gets ID i. Later duplicates
+ *        override earlier ones and empty tokens are skipped.
+ * @param lengths Byte length of each token, or NULL if every token is
+ *        NUL-terminated.
+ * @param count Number of tokens (at most INT32_MAX).
+ * @param out Receives the trie (reference count 1) on success.
+ * @return CRAYON_OK, CRAYON_EINVAL or CRAYON_ENOMEM.
+ */
+CRAYON_API int crayon_build(const char* const* tokens, const size_t* lengths,
+                            size_t count, crayon_trie** out);
+
+/**
+ * @brief Rebuild a trie from a binary image written by crayon_save_image()
+ *        or CrayonVocab.save(format="image"). Safe on untrusted input.
+ *
+ * A vocabulary image (CRYNVOC1) is unwrapped: its compiled trie is loaded,
+ * or, if it was saved without one, the trie is built from its tokens. The
+ * UNK ID it records is not returned; it is CrayonVocab.unk_token_id.
+ * @return CRAYON_OK, CRAYON_EINVAL, CRAYON_EMALFORMED or CRAYON_ENOMEM.
+ */
+CRAYON_API int crayon_load_image(const void* image, size_t length, crayon_trie** out);
+
+/**
+ * @brief Serialize a trie; release *out with crayon_buffer_free().
+ * @return CRAYON_OK, CRAYON_EINVAL or CRAYON_ENOMEM.
+ */
+CRAYON_API int crayon_save_image(const crayon_trie* trie, uint8_t** out, size_t* out_length);
+
+/**
+ * @brief Tokenize length bytes of text into out.
+ *
+ * Writes at most capacity IDs. A capacity of length is always enough;
+ * otherwise *consumed (if not NULL) tells how many input bytes the
+ * written IDs cover, and the caller can resume from there.
+ *
+ * @return Number of IDs written.
+ */
+CRAYON_API size_t crayon_tokenize(const crayon_trie* trie, const char* text, size_t length,
+                                  int32_t unk_id, int32_t* out, size_t capacity,
+                                  size_t* consumed);
+
+/**
+ * @brief crayon_tokenize() that also writes the byte offset (from text) at
+ *        which each token starts. Since 1.2.
+ */
+CRAYON_API size_t crayon_tokenize_offsets(const crayon_trie* trie, const char* text,
+                                          size_t length, int32_t unk_id, int32_t* out,
+                                          size_t* offsets, size_t capacity, size_t* consumed);
+
+/**
+ * @brief Number of tokens crayon_tokenize() would produce, without output.
+ */
+CRAYON_API size_t crayon_count(const crayon_trie* trie, const char* text, size_t length);
+
+/**
+ * @brief Byte length of the longest token, i.e. the most input one match
+ *        can look at. A token starting at p is final once text up to
+ *        p + this length is available, which is what streaming callers
+ *        need to cut input safely. Walks the trie; cache it. Since 1.2.
+ */
+CRAYON_API size_t crayon_max_token_length(const crayon_trie* trie);
+
+/**
+ * @brief Take an extra reference (e.g. before handing the trie to another
+ *        owner). Each reference is dropped with crayon_free().
+ */
+CRAYON_API crayon_trie* crayon_retain(crayon_trie* trie);
+
+/**
+ * @brief Drop one reference; the trie is freed with the last one. NULL is
+ *        ignored.
+ */
+CRAYON_API void crayon_free(crayon_trie* trie);
+
+CRAYON_API void crayon_buffer_free(void* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRAYON_H
@@ -0,0 +1,207 @@
+#define CRAYON_BUILDING_LIBRARY
+#include "crayon.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "trie_builder.h"
+#include "trie_image.h"
+#include "trie_match.h"
+
+// CrayonVocab.save(format="image") container (src/crayon/core/vocabulary.py)
+#define CRAYON_VOCAB_IMAGE_MAGIC "CRYNVOC1"
+#define CRAYON_VOCAB_IMAGE_HEADER 48
+
+// ----------------------------------------------------------------------------
+// Public C API (crayon.h) over the internal builder, image and match kernels
+// ----------------------------------------------------------------------------
+
+const char* crayon_version(void) {
+    return CRAYON_VERSION_STRING;
+}
+
+int crayon_build(const char* const* tokens, const size_t* lengths,
+                 size_t count, crayon_trie** out) {
+    if (!out || (count && !tokens) || count > INT32_MAX) return CRAYON_EINVAL;
+    *out = NULL;
+
+    CrayonTrieBuilder* builder = crayon_builder_new();
+    if (!builder) return CRAYON_ENOMEM;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!tokens[i]) {
+            crayon_builder_free(builder);
+            return CRAYON_EINVAL;
+        }
+        size_t length = lengths ? lengths[i] : strlen(tokens[i]);
+        if (crayon_builder_insert(builder, (const uint8_t*)tokens[i], length,
+                                  (int32_t)i) != 0) {
+            crayon_builder_free(builder);
+            return CRAYON_ENOMEM;
+        }
+    }
+
+    // Frees the builder either way
+    *out = crayon_builder_finish(builder);
+    return *out ? CRAYON_OK : CRAYON_ENOMEM;
+}
+
+static uint64_t read_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint32_t read_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/*
+ * CrayonVocab.save(format="image"): header | unk | offsets | text | trie,
+ * little-endian. The embedded trie is loaded as is; an image written
+ * without the C extension has none and is rebuilt from the token text.
+ * Token offsets count code points (Python str indices), so the rebuild
+ * walks the UTF-8 text.
+ */
+static int load_vocab_image(const uint8_t* data, size_t length, crayon_trie** out) {
+    const size_t header = CRAYON_VOCAB_IMAGE_HEADER;
+    if (length < header || read_u32(data + 8) != 1) return CRAYON_EMALFORMED;
+    uint64_t unk_len = read_u32(data + 12);
+    uint64_t count = read_u64(data + 24);
+    uint64_t text_len = read_u64(data + 32);
+    uint64_t trie_len = read_u64(data + 40);
+
+    uint64_t pos = header + unk_len;
+    if (count >= INT32_MAX || pos > length || 4 * (count + 1) > length - pos) {
+        return CRAYON_EMALFORMED;
+    }
+    const uint8_t* offsets = data + pos;
+    pos += 4 * (count + 1);
+    if (text_len > length - pos) return CRAYON_EMALFORMED;
+    const uint8_t* text = data + pos;
+    pos = (pos + text_len + 7) & ~(uint64_t)7;
+
+    if (trie_len) {
+        if (pos > length || trie_len > length - pos) return CRAYON_EMALFORMED;
+        int malformed = 0;
+        *out = crayon_trie_load(data + pos, (size_t)trie_len, &malformed);
+        if (*out) return CRAYON_OK;
+        return malformed ? CRAYON_EMALFORMED : CRAYON_ENOMEM;
+    }
+
+    const char** tokens = (const char**)malloc((count ? count : 1) * sizeof(char*));
+    size_t* lengths = (size_t*)malloc((count ? count : 1) * sizeof(size_t));
+    int rc = CRAYON_ENOMEM;
+    if (tokens && lengths) {
+        uint64_t byte = 0, code_point = 0;
+        rc = CRAYON_OK;
+        for (uint64_t i = 0; i < count && rc == CRAYON_OK; i++) {
+            uint64_t start = byte;
+            uint32_t end = read_u32(offsets + 4 * (i + 1));
+            while (code_point < end && byte < text_len) {
+                uint8_t lead = text[byte];
+                byte += lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+                code_point++;
+            }
+            if (code_point < end || byte > text_len) rc = CRAYON_EMALFORMED;
+            tokens[i] = (const char*)text + start;
+            lengths[i] = (size_t)(byte - start);
+        }
+        if (rc == CRAYON_OK) rc = crayon_build(tokens, lengths, (size_t)count, out);
+    }
+    free((void*)tokens);
+    free(lengths);
+    return rc;
+}
+
+int crayon_load_image(const void* image, size_t length, crayon_trie** out) {
+    if (!out || (length && !image)) return CRAYON_EINVAL;
+    *out = NULL;
+    if (length >= 8 && memcmp(image, CRAYON_VOCAB_IMAGE_MAGIC, 8) == 0) {
+        return load_vocab_image((const uint8_t*)image, length, out);
+    }
+    int malformed = 0;
+    *out = crayon_trie_load((const uint8_t*)image, length, &malformed);
+    if (*out) return CRAYON_OK;
+    return malformed ? CRAYON_EMALFORMED : CRAYON_ENOMEM;
+}
+
+int crayon_save_image(const crayon_trie* trie, uint8_t** out, size_t* out_length) {
+    if (!trie || !out || !out_length) return CRAYON_EINVAL;
+    return crayon_trie_serialize(trie, out, out_length) == 0 ? CRAYON_OK : CRAYON_ENOMEM;
+}
+
+size_t crayon_tokenize(const crayon_trie* trie, const char* text, size_t length,
+                       int32_t unk_id, int32_t* out, size_t capacity,
+                       size_t* consumed) {
+    size_t covered = 0;
+    size_t count = 0;
+    if (trie && text && out) {
+        count = crayon_tokenize_bounded(trie->root, (const uint8_t*)text, length, unk_id,
+                                        out, capacity, &covered);
+    }
+    if (consumed) *consumed = covered;
+    return count;
+}
+
+size_t crayon_tokenize_offsets(const crayon_trie* trie, const char* text, size_t length,
+                               int32_t unk_id, int32_t* out, size_t* offsets,
+                               size_t capacity, size_t* consumed) {
+    size_t covered = 0;
+    CrayonSink sink = {out, offsets, capacity, 0, 0, 0};
+    if (trie && text && out && offsets) {
+        covered = crayon_kernel_node_offsets(trie->root, (const uint8_t*)text, length,
+                                             unk_id, &sink);
+    }
+    if (consumed) *consumed = covered;
+    return sink.count;
+}
+
+size_t crayon_count(const crayon_trie* trie, const char* text, size_t length) {
+    if (!trie || !text) return 0;
+    return crayon_count_tokens(trie->root, (const uint8_t*)text, length);
+}
+
+size_t crayon_max_token_length(const crayon_trie* trie) {
+    if (!trie) return 0;
+
+    // Depth-first with an explicit stack: token length bounds the depth,
+    // and a vocabulary may hold tokens far longer than the C stack allows
+    typedef struct { const TrieNode* node; size_t depth; } Frame;
+    size_t capacity = 64, top = 0, deepest = 0;
+    Frame* stack = (Frame*)malloc(capacity * sizeof(Frame));
+    if (!stack) return 0;
+    stack[top++] = (Frame){trie->root, 0};
+
+    while (top) {
+        Frame frame = stack[--top];
+        if (frame.depth > deepest) deepest = frame.depth;
+        const TrieNode* node = frame.node;
+        if (top + node->child_count > capacity) {
+            while (top + node->child_count > capacity) capacity *= 2;
+            Frame* grown = (Frame*)realloc(stack, capacity * sizeof(Frame));
+            if (!grown) {
+                free(stack);
+                return 0;
+            }
+            stack = grown;
+        }
+        for (uint16_t i = 0; i < node->child_count; i++) {
+            stack[top++] = (Frame){&node->children[i], frame.depth + 1};
+        }
+    }
+    free(stack);
+    return deepest;
+}
+
+crayon_trie* crayon_retain(crayon_trie* trie) {
+    if (trie) crayon_trie_incref(trie);
+    return trie;
+}
+
+void crayon_free(crayon_trie* trie) {
+    if (trie) crayon_trie_decref(trie);
+}
+
+void crayon_buffer_free(void* buffer) {
+    free(buffer);
+}
@@ -0,0 +1,79 @@
+#ifndef CRAYON_ATOMIC_H
+#define CRAYON_ATOMIC_H
+
+/**
+ * @brief Minimal portable atomics for shared native state.
+ *
+ * The extension is built as C99 (no <stdatomic.h>), so this wraps the
+ * GCC/Clang __atomic builtins and the MSVC Interlocked intrinsics.
+ */
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    typedef volatile long crayon_atomic_long;
+    #define crayon_atomic_inc(p)        _InterlockedIncrement((p))
+    #define crayon_atomic_dec(p)        _InterlockedDecrement((p))
+    #define crayon_atomic_load(p)       _InterlockedOr((p), 0)
+    #define crayon_atomic_cas(p, e, d)  (_InterlockedCompareExchange((p), (d), (e)) == (e))
+    #define crayon_atomic_store(p, v)   _InterlockedExchange((p), (v))
+    typedef volatile __int64 crayon_atomic_i64;
+    #define crayon_atomic_add64(p, v)   _InterlockedExchangeAdd64((p), (v))
+    #define crayon_atomic_xchg64(p, v)  _InterlockedExchange64((p), (v))
+    #define crayon_atomic_load64(p)     _InterlockedOr64((p), 0)
+    // Aligned 64-bit volatile stores are single instructions on x64/ARM64
+    #define crayon_atomic_store64(p, v) (*(p) = (v))
+    #define crayon_atomic_load_ptr(p)   _InterlockedCompareExchangePointer((void* volatile*)(p), NULL, NULL)
+    #define crayon_atomic_store_ptr(p, v) _InterlockedExchangePointer((void* volatile*)(p), (v))
+    #define crayon_cpu_relax()          _mm_pause()
+    #define CRAYON_THREAD_LOCAL         __declspec(thread)
+#else
+    typedef long crayon_atomic_long;
+    // Returns the new value
+    #define crayon_atomic_inc(p)        __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+    #define crayon_atomic_dec(p)        __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+    #define crayon_atomic_load(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define crayon_atomic_cas(p, e, d)  __extension__ ({                          \
+        long _expected = (e);                                                     \
+        __atomic_compare_exchange_n((p), &_expected, (d), 0,                      \
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); })
+    #define crayon_atomic_store(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+    // 64-bit counters (long is 32-bit on Windows, so these are separate)
+    typedef long long crayon_atomic_i64;
+    #define crayon_atomic_add64(p, v)   __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+    #define crayon_atomic_xchg64(p, v)  __atomic_exchange_n((p), (v), __ATOMIC_RELAXED)
+    #define crayon_atomic_load64(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+    #define crayon_atomic_store64(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+    // Pointer publication (acquire/release)
+    #define crayon_atomic_load_ptr(p)   __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define crayon_atomic_store_ptr(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+    #define CRAYON_THREAD_LOCAL         __thread
+    #if defined(__x86_64__) || defined(__i386__)
+        #define crayon_cpu_relax()      __builtin_ia32_pause()
+    #else
+        #define crayon_cpu_relax()      ((void)0)
+    #endif
+#endif
+
+/**
+ * @brief Process-wide spinlock for short critical sections.
+ *
+ * Usable across sub-interpreters (which do not share a GIL) because it
+ * lives in plain C statics rather than interpreter state.
+ */
+typedef struct {
+    crayon_atomic_long locked;
+} crayon_spinlock;
+
+#define CRAYON_SPINLOCK_INIT {0}
+
+static inline void crayon_spin_lock(crayon_spinlock* lock) {
+    while (!crayon_atomic_cas(&lock->locked, 0, 1)) {
+        crayon_cpu_relax();
+    }
+}
+
+static inline void crayon_spin_unlock(crayon_spinlock* lock) {
+    crayon_atomic_store(&lock->locked, 0);
+}
+
+#endif // CRAYON_ATOMIC_H
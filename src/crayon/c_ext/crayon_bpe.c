@@ -0,0 +1,379 @@
+#include "crayon_bpe.h"
+#include <stdlib.h>
+#include <string.h>
+#include "byte_tables.h"
+#include "crayon_atomic.h"
+#include "simd_ops.h"
+#include "xxhash64.h"
+
+#define CACHE_WORD_BYTES 22
+#define CACHE_WORD_IDS 8
+#define CACHE_STRIPES 64        // Power of two
+#define EMPTY_PAIR UINT64_MAX
+
+typedef struct {
+    uint64_t pair;              // left << 32 | right; EMPTY_PAIR = free
+    int32_t rank;
+    int32_t merged;
+} MergeSlot;
+
+typedef struct {
+    uint64_t hash;              // 0 = free
+    uint8_t length;
+    uint8_t count;
+    uint8_t word[CACHE_WORD_BYTES];
+    int32_t ids[CACHE_WORD_IDS];
+} CacheEntry;
+
+#if defined(_MSC_VER)
+    static_assert(sizeof(CacheEntry) == 64, "CacheEntry must be one cache line");
+#else
+    _Static_assert(sizeof(CacheEntry) == 64, "CacheEntry must be one cache line");
+#endif
+
+// Guards every cache entry whose index is congruent to it mod CACHE_STRIPES.
+// One per cache line, so threads on different stripes never contend.
+typedef struct {
+    crayon_atomic_i64 hits;     // Relaxed, updated outside the lock
+    crayon_atomic_i64 misses;
+    crayon_spinlock lock;
+    uint8_t pad[64 - 2 * sizeof(crayon_atomic_i64) - sizeof(crayon_spinlock)];
+} CacheStripe;
+
+struct CrayonBpe {
+    MergeSlot* merges;
+    uint64_t merge_mask;
+    CacheEntry* cache;          // NULL when disabled
+    uint64_t cache_mask;
+    CacheStripe stripes[CACHE_STRIPES];
+};
+
+typedef struct {
+    int32_t id;                 // -1: character outside the vocabulary
+    int32_t prev;
+    int32_t next;               // -1 ends the list
+    int32_t alive;
+} Symbol;
+
+typedef struct {
+    int32_t rank;
+    int32_t pos;                // Left symbol
+    int32_t left;               // IDs at push time (stale if they changed)
+    int32_t right;
+} Candidate;
+
+// Per-call scratch, grown to the longest word seen
+typedef struct {
+    Symbol* symbols;
+    Candidate* heap;
+    size_t capacity;            // Symbols; the heap holds 3x
+} Scratch;
+
+static inline uint64_t pair_key(int32_t left, int32_t right) {
+    return ((uint64_t)(uint32_t)left << 32) | (uint32_t)right;
+}
+
+static inline uint64_t pair_hash(uint64_t key) {
+    key = (key ^ (key >> 31)) * 0x9E3779B97F4A7C15ULL;
+    return key ^ (key >> 29);
+}
+
+static const MergeSlot* find_merge(const CrayonBpe* bpe, int32_t left, int32_t right) {
+    if (left < 0 || right < 0) return NULL;
+    uint64_t key = pair_key(left, right);
+    for (uint64_t i = pair_hash(key) & bpe->merge_mask;; i = (i + 1) & bpe->merge_mask) {
+        const MergeSlot* slot = &bpe->merges[i];
+        if (slot->pair == key) return slot;
+        if (slot->pair == EMPTY_PAIR) return NULL;
+    }
+}
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+CrayonBpe* crayon_bpe_new(const int32_t* merges, size_t merge_count, size_t cache_slots) {
+    CrayonBpe* bpe = (CrayonBpe*)calloc(1, sizeof(CrayonBpe));
+    if (!bpe) return NULL;
+
+    size_t slots = next_pow2(merge_count * 2 + 1);
+    bpe->merges = (MergeSlot*)malloc(slots * sizeof(MergeSlot));
+    if (!bpe->merges) {
+        free(bpe);
+        return NULL;
+    }
+    bpe->merge_mask = slots - 1;
+    for (size_t i = 0; i < slots; i++) bpe->merges[i].pair = EMPTY_PAIR;
+
+    for (size_t m = 0; m < merge_count; m++) {
+        int32_t left = merges[3 * m], right = merges[3 * m + 1];
+        if (left < 0 || right < 0) continue;
+        uint64_t key = pair_key(left, right);
+        uint64_t i = pair_hash(key) & bpe->merge_mask;
+        while (bpe->merges[i].pair != EMPTY_PAIR && bpe->merges[i].pair != key) {
+            i = (i + 1) & bpe->merge_mask;
+        }
+        if (bpe->merges[i].pair == key) continue;
+        bpe->merges[i].pair = key;
+        bpe->merges[i].rank = (int32_t)m;
+        bpe->merges[i].merged = merges[3 * m + 2];
+    }
+
+    if (cache_slots) {
+        size_t entries = next_pow2(cache_slots);
+        bpe->cache = (CacheEntry*)aligned_alloc_64(entries * sizeof(CacheEntry));
+        if (!bpe->cache) {
+            free(bpe->merges);
+            free(bpe);
+            return NULL;
+        }
+        memset(bpe->cache, 0, entries * sizeof(CacheEntry));
+        bpe->cache_mask = entries - 1;
+    }
+    return bpe;
+}
+
+void crayon_bpe_free(CrayonBpe* bpe) {
+    if (!bpe) return;
+    free(bpe->merges);
+    if (bpe->cache) aligned_free_64(bpe->cache);
+    free(bpe);
+}
+
+void crayon_bpe_cache_stats(CrayonBpe* bpe, uint64_t* hits, uint64_t* misses) {
+    *hits = 0;
+    *misses = 0;
+    for (size_t i = 0; i < CACHE_STRIPES; i++) {
+        *hits += (uint64_t)crayon_atomic_load64(&bpe->stripes[i].hits);
+        *misses += (uint64_t)crayon_atomic_load64(&bpe->stripes[i].misses);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Pre-tokenizer
+// ----------------------------------------------------------------------------
+
+enum { GROUP_LETTER, GROUP_DIGIT, GROUP_SPACE, GROUP_OTHER };
+
+static inline int byte_group(uint8_t b) {
+    uint8_t c = crayon_byte_class[b];
+    if (c & (CRAYON_BYTE_ALPHA | CRAYON_BYTE_UTF8_LEAD | CRAYON_BYTE_UTF8_CONT)) return GROUP_LETTER;
+    if (c & CRAYON_BYTE_DIGIT) return GROUP_DIGIT;
+    if (c & CRAYON_BYTE_SPACE) return GROUP_SPACE;
+    return GROUP_OTHER;
+}
+
+size_t crayon_pretokenize_next(const uint8_t* text, size_t length, size_t start) {
+    size_t i = start;
+    if (text[i] == ' ' && i + 1 < length && byte_group(text[i + 1]) != GROUP_SPACE) i++;
+    int group = byte_group(text[i]);
+    size_t end = i + 1;
+    while (end < length && byte_group(text[end]) == group) end++;
+    // Leave the last space of a whitespace run to the word after it
+    if (group == GROUP_SPACE && end < length && end - i > 1 && text[end - 1] == ' ') end--;
+    return end;
+}
+
+// ----------------------------------------------------------------------------
+// Merging
+// ----------------------------------------------------------------------------
+
+static inline int candidate_less(const Candidate* a, const Candidate* b) {
+    return a->rank < b->rank || (a->rank == b->rank && a->pos < b->pos);
+}
+
+static void heap_push(Candidate* heap, size_t* size, Candidate c) {
+    size_t i = (*size)++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!candidate_less(&c, &heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = c;
+}
+
+static Candidate heap_pop(Candidate* heap, size_t* size) {
+    Candidate top = heap[0];
+    Candidate last = heap[--(*size)];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && candidate_less(&heap[child + 1], &heap[child])) child++;
+        if (!candidate_less(&heap[child], &last)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*size) heap[i] = last;
+    return top;
+}
+
+static void push_pair(const CrayonBpe* bpe, const Symbol* symbols, int32_t pos,
+                      Candidate* heap, size_t* size) {
+    int32_t next = symbols[pos].next;
+    if (next < 0) return;
+    const MergeSlot* merge = find_merge(bpe, symbols[pos].id, symbols[next].id);
+    if (!merge) return;
+    Candidate c = {merge->rank, pos, symbols[pos].id, symbols[next].id};
+    heap_push(heap, size, c);
+}
+
+// Exact trie lookup of one character; -1 when it is not a token
+static int32_t lookup_symbol(const TrieNode* root, const uint8_t* bytes, size_t length) {
+    const TrieNode* node = root;
+    for (size_t i = 0; i < length; i++) {
+        int idx = find_child_simd(node, bytes[i]);
+        if (idx == -1) return -1;
+        node = &node->children[idx];
+    }
+    return node->token_id;
+}
+
+// Length of the UTF-8 character at text (1 for invalid bytes)
+static size_t char_length(const uint8_t* text, size_t limit) {
+    size_t n = crayon_utf8_length[text[0]];
+    if (n <= 1 || n > limit) return 1;
+    uint8_t second = text[1];
+    if (second < crayon_utf8_second_min[text[0] - 0xC0] ||
+        second > crayon_utf8_second_max[text[0] - 0xC0]) {
+        return 1;
+    }
+    for (size_t i = 2; i < n; i++) {
+        if (!(crayon_byte_class[text[i]] & CRAYON_BYTE_UTF8_CONT)) return 1;
+    }
+    return n;
+}
+
+static int reserve(Scratch* scratch, size_t symbols) {
+    if (symbols <= scratch->capacity) return 0;
+    size_t capacity = next_pow2(symbols);
+    Symbol* s = (Symbol*)realloc(scratch->symbols, capacity * sizeof(Symbol));
+    if (!s) return -1;
+    scratch->symbols = s;
+    Candidate* h = (Candidate*)realloc(scratch->heap, 3 * capacity * sizeof(Candidate));
+    if (!h) return -1;
+    scratch->heap = h;
+    scratch->capacity = capacity;
+    return 0;
+}
+
+static size_t merge_word(const CrayonBpe* bpe, const TrieNode* root, const uint8_t* word,
+                         size_t length, int32_t unk_token_id, Scratch* scratch, int32_t* out) {
+    Symbol* symbols = scratch->symbols;
+    int32_t n = 0;
+    for (size_t i = 0; i < length;) {
+        size_t len = char_length(word + i, length - i);
+        symbols[n].id = lookup_symbol(root, word + i, len);
+        symbols[n].prev = n - 1;
+        symbols[n].next = n + 1;
+        symbols[n].alive = 1;
+        n++;
+        i += len;
+    }
+    symbols[n - 1].next = -1;
+
+    // Every merge pushes at most two pairs: the heap never exceeds 3n
+    Candidate* heap = scratch->heap;
+    size_t size = 0;
+    for (int32_t i = 0; i + 1 < n; i++) push_pair(bpe, symbols, i, heap, &size);
+
+    while (size) {
+        Candidate c = heap_pop(heap, &size);
+        Symbol* left = &symbols[c.pos];
+        if (!left->alive || left->id != c.left || left->next < 0) continue;
+        Symbol* right = &symbols[left->next];
+        if (right->id != c.right) continue;
+
+        const MergeSlot* merge = find_merge(bpe, c.left, c.right);
+        left->id = merge->merged;
+        right->alive = 0;
+        left->next = right->next;
+        if (right->next >= 0) symbols[right->next].prev = c.pos;
+
+        if (left->prev >= 0) push_pair(bpe, symbols, left->prev, heap, &size);
+        push_pair(bpe, symbols, c.pos, heap, &size);
+    }
+
+    size_t count = 0;
+    for (int32_t i = 0; i >= 0; i = symbols[i].next) {
+        out[count++] = symbols[i].id >= 0 ? symbols[i].id : unk_token_id;
+    }
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+// Word cache
+// ----------------------------------------------------------------------------
+
+static int cache_get(CrayonBpe* bpe, uint64_t hash, const uint8_t* word, size_t length,
+                     int32_t* out, size_t* count) {
+    uint64_t slot = hash & bpe->cache_mask;
+    CacheEntry* entry = &bpe->cache[slot];
+    CacheStripe* stripe = &bpe->stripes[slot & (CACHE_STRIPES - 1)];
+    int hit = 0;
+    crayon_spin_lock(&stripe->lock);
+    if (entry->hash == hash && entry->length == length && memcmp(entry->word, word, length) == 0) {
+        memcpy(out, entry->ids, entry->count * sizeof(int32_t));
+        *count = entry->count;
+        hit = 1;
+    }
+    crayon_spin_unlock(&stripe->lock);
+    crayon_atomic_add64(hit ? &stripe->hits : &stripe->misses, 1);
+    return hit;
+}
+
+static void cache_put(CrayonBpe* bpe, uint64_t hash, const uint8_t* word, size_t length,
+                      const int32_t* ids, size_t count) {
+    if (count > CACHE_WORD_IDS) return;
+    uint64_t slot = hash & bpe->cache_mask;
+    CacheEntry* entry = &bpe->cache[slot];
+    CacheStripe* stripe = &bpe->stripes[slot & (CACHE_STRIPES - 1)];
+    crayon_spin_lock(&stripe->lock);
+    entry->hash = hash;
+    entry->length = (uint8_t)length;
+    entry->count = (uint8_t)count;
+    memcpy(entry->word, word, length);
+    memcpy(entry->ids, ids, count * sizeof(int32_t));
+    crayon_spin_unlock(&stripe->lock);
+}
+
+int crayon_bpe_encode(CrayonBpe* bpe, const TrieNode* root, const uint8_t* text,
+                      size_t length, int32_t unk_token_id, int32_t* out, size_t* count) {
+    Scratch scratch = {NULL, NULL, 0};
+    size_t n = 0;
+    int rc = 0;
+
+    for (size_t start = 0; start < length;) {
+        size_t end = crayon_pretokenize_next(text, length, start);
+        const uint8_t* word = text + start;
+        size_t word_length = end - start;
+        start = end;
+
+        int cacheable = bpe->cache && word_length <= CACHE_WORD_BYTES;
+        uint64_t hash = 0;
+        if (cacheable) {
+            hash = xxh64(word, word_length, 0) | 1;
+            size_t cached;
+            if (cache_get(bpe, hash, word, word_length, out + n, &cached)) {
+                n += cached;
+                continue;
+            }
+        }
+
+        if (reserve(&scratch, word_length) != 0) {
+            rc = -1;
+            break;
+        }
+        size_t produced = merge_word(bpe, root, word, word_length, unk_token_id, &scratch, out + n);
+        if (cacheable) cache_put(bpe, hash, word, word_length, out + n, produced);
+        n += produced;
+    }
+
+    free(scratch.symbols);
+    free(scratch.heap);
+    *count = rc == 0 ? n : 0;
+    return rc;
+}
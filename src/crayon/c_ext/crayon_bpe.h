@@ -0,0 +1,69 @@
+#ifndef CRAYON_BPE_H
+#define CRAYON_BPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trie_node.h"
+
+/**
+ * @brief BPE-merge encoding over an existing vocabulary.
+ *
+ * For models trained with byte-pair merges rather than greedy longest
+ * match. Text is pre-tokenized into words (crayon_pretokenize_next), each
+ * word starts as one symbol per UTF-8 character (looked up in the trie),
+ * and the lowest-ranked adjacent pair is merged until no ranked pair
+ * remains. Symbols form a doubly linked list and candidate pairs sit in a
+ * binary min-heap keyed by (rank, position), with stale entries skipped on
+ * pop, so a word of n symbols costs O(n log n).
+ *
+ * Encoded short words are kept in a direct-mapped cache (one 64-byte entry
+ * per word), since natural text repeats the same words constantly. The
+ * cache is the only mutable state. Its entries are guarded by striped
+ * spinlocks and its hit/miss counters are relaxed atomics, so one encoder
+ * may be shared by threads that released the GIL without serializing them.
+ */
+
+typedef struct CrayonBpe CrayonBpe;
+
+/**
+ * @brief Build an encoder from ranked merges.
+ *
+ * @param merges merge_count (left, right, merged) ID triples, best rank
+ *        first. A repeated (left, right) pair keeps its first rank.
+ * @param cache_slots Word cache entries (rounded up to a power of two;
+ *        0 disables the cache).
+ * @return Encoder, or NULL on allocation failure.
+ */
+CrayonBpe* crayon_bpe_new(const int32_t* merges, size_t merge_count, size_t cache_slots);
+
+void crayon_bpe_free(CrayonBpe* bpe);
+
+/**
+ * @brief End of the pre-tokenizer word that starts at start (< length).
+ *
+ * A word is a run of one byte group: letters (ASCII letters and every
+ * non-ASCII byte), digits, whitespace, or anything else. A single space
+ * before a non-space run joins that run (" world"), so a whitespace run
+ * leaves its last space to the following word.
+ */
+size_t crayon_pretokenize_next(const uint8_t* text, size_t length, size_t start);
+
+/**
+ * @brief Encode text into out (capacity length: one ID per byte at most).
+ *
+ * Characters missing from the vocabulary become one unk_token_id each and
+ * never merge. The word cache assumes every call passes the same root and
+ * unk_token_id. Safe with the GIL released.
+ *
+ * @param count Receives the number of IDs written.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int crayon_bpe_encode(CrayonBpe* bpe, const TrieNode* root, const uint8_t* text,
+                      size_t length, int32_t unk_token_id, int32_t* out, size_t* count);
+
+/**
+ * @brief Word cache hits and misses so far.
+ */
+void crayon_bpe_cache_stats(CrayonBpe* bpe, uint64_t* hits, uint64_t* misses);
+
+#endif // CRAYON_BPE_H
@@ -0,0 +1,157 @@
+#include "crayon_hash_match.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOOM_BITS_PER_TOKEN 16
+
+const uint8_t crayon_hash_prefix_mask[CRAYON_HASH_MAX_LENGTH + 1][16] = {
+    {0},
+    {0xFF},
+    {0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+};
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// ----------------------------------------------------------------------------
+// Trie enumeration (depth is bounded by CRAYON_HASH_MAX_LENGTH, so plain
+// recursion is fine)
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    CrayonHashMatcher* matcher;     // NULL on the counting pass
+    size_t counts[CRAYON_HASH_MAX_LENGTH];
+    uint8_t path[CRAYON_HASH_MAX_LENGTH];
+    int too_long;
+} Walk;
+
+static void insert(CrayonHashMatcher* matcher, const uint8_t* bytes, size_t length,
+                   int32_t token_id) {
+    CrayonHashLevel* level = &matcher->levels[length - 1];
+    CrayonHashSlot entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.key, bytes, length);
+    entry.token_id = token_id;
+
+    uint64_t h = crayon_hash_key(_mm_loadu_si128((const __m128i*)entry.key));
+    uint64_t b = (h >> 32) & level->bloom_mask;
+    ((uint64_t*)level->bloom)[b >> 6] |= 1ULL << (b & 63);
+
+    CrayonHashSlot* slots = (CrayonHashSlot*)level->slots;
+    uint64_t i = h & level->slot_mask;
+    while (slots[i].token_id != -1) i = (i + 1) & level->slot_mask;
+    slots[i] = entry;
+}
+
+static void walk(Walk* w, const TrieNode* node, size_t depth) {
+    if (depth > 0 && node->token_id != -1) {
+        if (w->matcher) {
+            insert(w->matcher, w->path, depth, node->token_id);
+            uint16_t* by_prefix = (uint16_t*)w->matcher->lengths_by_prefix;
+            if (depth == 1) {
+                // Any second byte (or none, read as zero padding)
+                for (uint32_t b1 = 0; b1 < 256; b1++) by_prefix[w->path[0] | (b1 << 8)] |= 1;
+            } else {
+                by_prefix[w->path[0] | ((uint32_t)w->path[1] << 8)] |= (uint16_t)(1u << (depth - 1));
+            }
+        } else {
+            w->counts[depth - 1]++;
+        }
+    }
+    if (node->child_count == 0) return;
+    if (depth == CRAYON_HASH_MAX_LENGTH) {
+        w->too_long = 1;
+        return;
+    }
+    for (uint16_t i = 0; i < node->child_count && !w->too_long; i++) {
+        w->path[depth] = node->child_chars[i];
+        walk(w, &node->children[i], depth + 1);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Public entry points
+// ----------------------------------------------------------------------------
+
+CrayonHashMatcher* crayon_hash_matcher_build(const TrieNode* root, int* too_long) {
+    Walk w;
+    memset(&w, 0, sizeof(w));
+    *too_long = 0;
+    walk(&w, root, 0);
+    if (w.too_long) {
+        *too_long = 1;
+        return NULL;
+    }
+
+    CrayonHashMatcher* matcher = (CrayonHashMatcher*)calloc(1, sizeof(CrayonHashMatcher));
+    if (!matcher) return NULL;
+
+    // One arena: every level's slots (load factor <= 1/2), its bloom words,
+    // then the two-byte prefix table
+    size_t slot_total = 0, bloom_words = 0;
+    size_t slot_counts[CRAYON_HASH_MAX_LENGTH], bloom_counts[CRAYON_HASH_MAX_LENGTH];
+    for (int l = 0; l < CRAYON_HASH_MAX_LENGTH; l++) {
+        size_t n = w.counts[l];
+        slot_counts[l] = n ? next_pow2(n * 2) : 1;
+        bloom_counts[l] = n ? (next_pow2(n * BLOOM_BITS_PER_TOKEN) + 63) / 64 : 1;
+        slot_total += slot_counts[l];
+        bloom_words += bloom_counts[l];
+    }
+    size_t slot_bytes = slot_total * sizeof(CrayonHashSlot);
+    size_t prefix_bytes = 65536 * sizeof(uint16_t);
+    uint8_t* arena = (uint8_t*)malloc(slot_bytes + bloom_words * sizeof(uint64_t) + prefix_bytes);
+    if (!arena) {
+        free(matcher);
+        return NULL;
+    }
+    CrayonHashSlot* slots = (CrayonHashSlot*)arena;
+    uint64_t* bloom = (uint64_t*)(arena + slot_bytes);
+    memset(bloom, 0, bloom_words * sizeof(uint64_t));
+    uint16_t* by_prefix = (uint16_t*)(bloom + bloom_words);
+    memset(by_prefix, 0, prefix_bytes);
+    matcher->lengths_by_prefix = by_prefix;
+    for (size_t i = 0; i < slot_total; i++) {
+        memset(&slots[i], 0, sizeof(CrayonHashSlot));
+        slots[i].token_id = -1;
+    }
+
+    matcher->arena = arena;
+    for (int l = 0; l < CRAYON_HASH_MAX_LENGTH; l++) {
+        CrayonHashLevel* level = &matcher->levels[l];
+        level->slots = slots;
+        level->slot_mask = slot_counts[l] - 1;
+        level->bloom = bloom;
+        level->bloom_mask = bloom_counts[l] * 64 - 1;
+        slots += slot_counts[l];
+        bloom += bloom_counts[l];
+        if (w.counts[l]) matcher->length_mask |= 1u << l;
+        matcher->token_count += (uint32_t)w.counts[l];
+    }
+
+    w.matcher = matcher;
+    walk(&w, root, 0);
+    return matcher;
+}
+
+void crayon_hash_matcher_free(CrayonHashMatcher* matcher) {
+    if (!matcher) return;
+    free(matcher->arena);
+    free(matcher);
+}
@@ -0,0 +1,135 @@
+#ifndef CRAYON_HASH_MATCH_H
+#define CRAYON_HASH_MATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+#include "trie_node.h"
+
+/**
+ * @brief Longest-match by hashed prefix lookup, for vocabularies whose
+ * tokens are all at most CRAYON_HASH_MAX_LENGTH bytes.
+ *
+ * The trie walk is a chain of dependent node hops (one per byte). This
+ * matcher instead loads 16 input bytes once and, for each token length
+ * present in the vocabulary (longest first), masks the prefix, hashes it
+ * and probes that length's open-addressing table. A table indexed by the
+ * first two bytes limits the lengths to those of tokens with that prefix,
+ * and a per-length Bloom
+ * bitset turns most misses into one bit test on a table that stays in
+ * cache. Probes do not depend on each other, so the CPU can overlap them.
+ *
+ * Built from a compiled trie and immutable afterwards; the trie may be
+ * freed once the matcher exists.
+ */
+
+#define CRAYON_HASH_MAX_LENGTH 16
+
+typedef struct {
+    uint8_t key[16];            // Token bytes, zero padded
+    int32_t token_id;           // -1 = empty slot
+    uint32_t reserved;
+} CrayonHashSlot;
+
+typedef struct {
+    const CrayonHashSlot* slots;
+    const uint64_t* bloom;
+    uint64_t slot_mask;         // slot count - 1 (power of two)
+    uint64_t bloom_mask;        // bloom bit count - 1 (power of two)
+} CrayonHashLevel;
+
+typedef struct CrayonHashMatcher {
+    uint32_t length_mask;       // Bit L-1 set when some token has L bytes
+    uint32_t token_count;
+    // Bit L-1 of lengths_by_prefix[b0 | b1 << 8] is set when a token of L
+    // bytes starts with b0 b1 (bit 0: b0 alone is a token), so only lengths
+    // that can match are probed
+    const uint16_t* lengths_by_prefix;
+    CrayonHashLevel levels[CRAYON_HASH_MAX_LENGTH];  // levels[L - 1]
+    void* arena;                // Single allocation behind every level
+} CrayonHashMatcher;
+
+/**
+ * @brief Build a matcher holding every token of a compiled trie.
+ *
+ * @param too_long Set to 1 when the trie holds a token longer than
+ *        CRAYON_HASH_MAX_LENGTH (the matcher cannot represent it).
+ * @return Matcher, or NULL on allocation failure or *too_long.
+ */
+CrayonHashMatcher* crayon_hash_matcher_build(const TrieNode* root, int* too_long);
+
+void crayon_hash_matcher_free(CrayonHashMatcher* matcher);
+
+// Prefix masks: crayon_hash_prefix_mask[L] keeps the first L bytes
+extern const uint8_t crayon_hash_prefix_mask[CRAYON_HASH_MAX_LENGTH + 1][16];
+
+static inline uint64_t crayon_hash_key(__m128i key) {
+    uint64_t lo = (uint64_t)_mm_cvtsi128_si64(key);
+    uint64_t hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(key, key));
+    uint64_t h = (lo ^ (hi * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL;
+    return h ^ (h >> 29);
+}
+
+static inline int crayon_hash_highest_bit(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (int)index;
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+}
+
+/**
+ * @brief Same contract as crayon_longest_match_walk.
+ *
+ * *walked receives the bytes considered (the longest candidate length),
+ * which is at least the match length.
+ */
+static inline size_t crayon_hash_longest_match(const CrayonHashMatcher* matcher,
+                                               const uint8_t* text, size_t limit,
+                                               int32_t* token_id, size_t* walked) {
+    __m128i window;
+    if (limit >= 16) {
+        window = _mm_loadu_si128((const __m128i*)text);
+    } else {
+        uint8_t padded[16] = {0};
+        memcpy(padded, text, limit);
+        window = _mm_loadu_si128((const __m128i*)padded);
+    }
+
+    if (limit == 0) {
+        *walked = 0;
+        return 0;
+    }
+    size_t longest = limit < CRAYON_HASH_MAX_LENGTH ? limit : CRAYON_HASH_MAX_LENGTH;
+    uint32_t prefix = (uint32_t)_mm_extract_epi16(window, 0);
+    uint32_t candidates = matcher->lengths_by_prefix[prefix] & (uint32_t)((1u << longest) - 1u);
+    *walked = candidates ? (size_t)crayon_hash_highest_bit(candidates) + 1 : 0;
+
+    while (candidates) {
+        int bit = crayon_hash_highest_bit(candidates);
+        candidates &= ~(1u << bit);
+        const CrayonHashLevel* level = &matcher->levels[bit];
+
+        __m128i key = _mm_and_si128(window,
+                                    _mm_loadu_si128((const __m128i*)crayon_hash_prefix_mask[bit + 1]));
+        uint64_t h = crayon_hash_key(key);
+        uint64_t b = (h >> 32) & level->bloom_mask;
+        if (!(level->bloom[b >> 6] & (1ULL << (b & 63)))) continue;
+
+        for (uint64_t i = h & level->slot_mask;; i = (i + 1) & level->slot_mask) {
+            const CrayonHashSlot* slot = &level->slots[i];
+            if (slot->token_id == -1) break;
+            __m128i stored = _mm_loadu_si128((const __m128i*)slot->key);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(stored, key)) == 0xFFFF) {
+                *token_id = slot->token_id;
+                return (size_t)bit + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+#endif // CRAYON_HASH_MATCH_H
@@ -0,0 +1,13 @@
+#include "trie_match.h"
+
+// ----------------------------------------------------------------------------
+// Dispatch table over the kernel instances in trie_match.h
+// ----------------------------------------------------------------------------
+
+#define CRAYON_KERNEL_ENTRY(VIEW, SINK, KIND) [CRAYON_SINK_##KIND] = crayon_kernel_##VIEW##_##SINK,
+#define CRAYON_VIEW_ROW(VIEW, KIND) \
+    [CRAYON_VIEW_##KIND] = { CRAYON_FOR_EACH_SINK(CRAYON_KERNEL_ENTRY, VIEW) },
+
+const CrayonKernel crayon_kernels[CRAYON_VIEW_KINDS][CRAYON_SINK_KINDS] = {
+    CRAYON_FOR_EACH_VIEW(CRAYON_VIEW_ROW)
+};
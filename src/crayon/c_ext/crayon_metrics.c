@@ -0,0 +1,136 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime() under -std=c99
+#endif
+
+#include "crayon_metrics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+    #include <pthread.h>
+#endif
+
+#define SERIES_FIELDS (sizeof(CrayonMetricSeries) / sizeof(uint64_t))
+#define FIELD(name) (offsetof(CrayonMetricSeries, name) / sizeof(uint64_t))
+
+/**
+ * One writer thread per shard: fields are bumped with a relaxed load and
+ * store (no read-modify-write), and scrapers read them with relaxed loads.
+ * Shards are never freed; the list only grows, so scrapers can walk it
+ * without a lock.
+ */
+typedef struct CrayonMetricsShard {
+    crayon_atomic_i64 fields[CRAYON_METRIC_ENTRIES][SERIES_FIELDS];
+    struct CrayonMetricsShard* next;
+    crayon_atomic_long in_use;
+} CrayonMetricsShard;
+
+crayon_atomic_long crayon_metrics_on = 0;
+
+static CrayonMetricsShard* shard_list = NULL;
+static crayon_spinlock registry_lock = CRAYON_SPINLOCK_INIT;
+static CrayonMetricsSnapshot baseline;     // Totals at the last reset (registry_lock)
+static CRAYON_THREAD_LOCAL CrayonMetricsShard* tls_shard = NULL;
+
+#if !defined(_WIN32)
+// Hand the shard back when its thread exits so a new thread can reuse it
+// (Windows keeps one shard per thread that ever recorded)
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+
+static void release_shard(void* shard) {
+    crayon_atomic_store(&((CrayonMetricsShard*)shard)->in_use, 0);
+}
+
+static void create_shard_key(void) {
+    pthread_key_create(&shard_key, release_shard);
+}
+#endif
+
+static CrayonMetricsShard* claim_shard(void) {
+    CrayonMetricsShard* shard;
+
+    // Reuse a shard released by an exited thread
+    for (shard = (CrayonMetricsShard*)crayon_atomic_load_ptr(&shard_list); shard; shard = shard->next) {
+        if (crayon_atomic_load(&shard->in_use) == 0 && crayon_atomic_cas(&shard->in_use, 0, 1)) {
+            break;
+        }
+    }
+
+    if (!shard) {
+        shard = (CrayonMetricsShard*)calloc(1, sizeof(CrayonMetricsShard));
+        if (!shard) return NULL;
+        shard->in_use = 1;
+        crayon_spin_lock(&registry_lock);
+        shard->next = shard_list;
+        crayon_atomic_store_ptr(&shard_list, shard);
+        crayon_spin_unlock(&registry_lock);
+    }
+
+#if !defined(_WIN32)
+    pthread_once(&shard_key_once, create_shard_key);
+    pthread_setspecific(shard_key, shard);
+#endif
+    tls_shard = shard;
+    return shard;
+}
+
+static inline void bump(crayon_atomic_i64* field, uint64_t n) {
+    crayon_atomic_store64(field, crayon_atomic_load64(field) + (long long)n);
+}
+
+void crayon_metrics_record(CrayonMetricEntry entry, uint64_t start_ns, size_t bytes,
+                           size_t tokens, size_t unk_tokens) {
+    if (!start_ns) return;
+    uint64_t elapsed = crayon_now_ns() - start_ns;
+
+    CrayonMetricsShard* shard = tls_shard ? tls_shard : claim_shard();
+    if (!shard) return;
+
+    crayon_atomic_i64* f = shard->fields[entry];
+    bump(&f[FIELD(calls)], 1);
+    bump(&f[FIELD(bytes_in)], bytes);
+    bump(&f[FIELD(tokens_out)], tokens);
+    bump(&f[FIELD(unk_tokens)], unk_tokens);
+    bump(&f[FIELD(latency_sum_ns)], elapsed);
+    bump(&f[FIELD(latency) + crayon_metrics_bucket(elapsed)], 1);
+}
+
+void crayon_metrics_set_enabled(int enabled) {
+    crayon_atomic_store(&crayon_metrics_on, enabled ? 1 : 0);
+}
+
+// Raw sums over every shard (counts of exited threads included)
+static void sum_shards(CrayonMetricsSnapshot* out) {
+    memset(out, 0, sizeof(*out));
+    for (CrayonMetricsShard* shard = (CrayonMetricsShard*)crayon_atomic_load_ptr(&shard_list);
+         shard; shard = shard->next) {
+        for (int e = 0; e < CRAYON_METRIC_ENTRIES; e++) {
+            uint64_t* dst = (uint64_t*)&out->entries[e];
+            for (size_t i = 0; i < SERIES_FIELDS; i++) {
+                dst[i] += (uint64_t)crayon_atomic_load64(&shard->fields[e][i]);
+            }
+        }
+    }
+}
+
+void crayon_metrics_snapshot(CrayonMetricsSnapshot* out) {
+    sum_shards(out);
+    uint64_t* dst = (uint64_t*)out;
+    crayon_spin_lock(&registry_lock);
+    const uint64_t* base = (const uint64_t*)&baseline;
+    for (size_t i = 0; i < sizeof(*out) / sizeof(uint64_t); i++) {
+        // A concurrent writer can land between the two reads; never go negative
+        dst[i] = dst[i] > base[i] ? dst[i] - base[i] : 0;
+    }
+    crayon_spin_unlock(&registry_lock);
+}
+
+void crayon_metrics_reset(void) {
+    CrayonMetricsSnapshot totals;
+    sum_shards(&totals);
+    crayon_spin_lock(&registry_lock);
+    baseline = totals;
+    crayon_spin_unlock(&registry_lock);
+}
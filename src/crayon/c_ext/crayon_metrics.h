@@ -0,0 +1,142 @@
+#ifndef CRAYON_METRICS_H
+#define CRAYON_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crayon_atomic.h"
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+/**
+ * @brief Runtime metrics registry for production services.
+ *
+ * Unlike CRAYON_STATS (compile-time traversal counters) this is always
+ * compiled in and switched on at runtime. Each thread records into its own
+ * heap shard with relaxed loads and stores (single writer, no lock prefix,
+ * no contended cache lines); a scrape walks the shard list and sums them,
+ * so reading never blocks or slows a tokenizing thread. Shards of exited
+ * threads are recycled with their counts intact.
+ *
+ * Latency is a log-linear histogram of nanoseconds: values below 16 are
+ * exact, above that every power of two is split into 8 buckets (< 12.5%
+ * relative error), up to 2^40 ns.
+ */
+
+typedef enum {
+    CRAYON_METRIC_TOKENIZE = 0,     // crayon_tokenize_fast, Tokenizer.tokenize
+    CRAYON_METRIC_COUNT,            // Tokenizer.count
+    CRAYON_METRIC_TOKENIZE_INTO,    // Tokenizer.tokenize_into
+    CRAYON_METRIC_BATCH,            // Tokenizer.tokenize_batch (one per batch)
+    CRAYON_METRIC_CORPUS,           // tokenize_jsonl / tokenize_csv (one per file)
+    CRAYON_METRIC_OPTIMAL,          // Tokenizer.tokenize_optimal
+    CRAYON_METRIC_SAMPLE,           // Tokenizer.sample
+    CRAYON_METRIC_BPE,              // Tokenizer.tokenize_bpe
+    CRAYON_METRIC_ENTRIES
+} CrayonMetricEntry;
+
+#define CRAYON_METRICS_SUB_BITS 3
+#define CRAYON_METRICS_SUB_BUCKETS (1 << CRAYON_METRICS_SUB_BITS)
+#define CRAYON_METRICS_MAX_BITS 40
+#define CRAYON_METRICS_BUCKETS \
+    (CRAYON_METRICS_SUB_BUCKETS * (CRAYON_METRICS_MAX_BITS - CRAYON_METRICS_SUB_BITS + 1))
+
+typedef struct {
+    uint64_t calls;
+    uint64_t bytes_in;
+    uint64_t tokens_out;
+    uint64_t unk_tokens;            // Not tracked for count (no IDs produced)
+    uint64_t latency_sum_ns;
+    uint64_t latency[CRAYON_METRICS_BUCKETS];
+} CrayonMetricSeries;
+
+typedef struct {
+    CrayonMetricSeries entries[CRAYON_METRIC_ENTRIES];
+} CrayonMetricsSnapshot;
+
+extern crayon_atomic_long crayon_metrics_on;
+
+static inline int crayon_metrics_enabled(void) {
+    return (int)crayon_atomic_load(&crayon_metrics_on);
+}
+
+static inline uint64_t crayon_now_ns(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (!frequency.QuadPart) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Start timing a call: 0 when metrics are off (record ignores it).
+ */
+static inline uint64_t crayon_metrics_start(void) {
+    return crayon_metrics_enabled() ? crayon_now_ns() : 0;
+}
+
+static inline int crayon_bit_length(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanReverse64(&index, v) ? (int)index + 1 : 0;
+#else
+    return v ? 64 - __builtin_clzll(v) : 0;
+#endif
+}
+
+static inline size_t crayon_metrics_bucket(uint64_t ns) {
+    if (ns >> CRAYON_METRICS_MAX_BITS) return CRAYON_METRICS_BUCKETS - 1;
+    int bits = crayon_bit_length(ns);
+    int shift = bits - CRAYON_METRICS_SUB_BITS - 1;
+    if (shift < 0) shift = 0;
+    return (size_t)CRAYON_METRICS_SUB_BUCKETS * (size_t)shift + (size_t)(ns >> shift);
+}
+
+// Inclusive lower bound of a bucket in nanoseconds
+static inline uint64_t crayon_metrics_bucket_floor(size_t index) {
+    size_t shift = index / CRAYON_METRICS_SUB_BUCKETS;
+    shift = shift ? shift - 1 : 0;
+    return (uint64_t)(index - CRAYON_METRICS_SUB_BUCKETS * shift) << shift;
+}
+
+/**
+ * @brief UNK IDs in an output array (only scanned while metrics are on).
+ */
+static inline size_t crayon_metrics_count_unk(const int32_t* ids, size_t count,
+                                              int32_t unk_token_id) {
+    size_t unk = 0;
+    for (size_t i = 0; i < count; i++) unk += ids[i] == unk_token_id;
+    return unk;
+}
+
+/**
+ * @brief Record one call into the calling thread's shard.
+ *
+ * Safe without the GIL. No-op when start_ns is 0 (metrics were off when
+ * the call started) or the shard cannot be allocated.
+ */
+void crayon_metrics_record(CrayonMetricEntry entry, uint64_t start_ns, size_t bytes,
+                           size_t tokens, size_t unk_tokens);
+
+void crayon_metrics_set_enabled(int enabled);
+
+/**
+ * @brief Totals over all shards since the last reset.
+ */
+void crayon_metrics_snapshot(CrayonMetricsSnapshot* out);
+
+/**
+ * @brief Rebase the totals to zero (writers are never touched).
+ */
+void crayon_metrics_reset(void);
+
+#endif // CRAYON_METRICS_H
@@ -2,333 +2,1794 @@
 #include <Python.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include "crayon.h"
 #include "trie_node.h"
+#include "trie_builder.h"
 #include "simd_ops.h"
+#include "trie_match.h"
+#include "corpus_reader.h"
+#include "xxhash64.h"
+#include "perf_counters.h"
+#include "crayon_stats.h"
+#include "trie_image.h"
+#include "crayon_metrics.h"
+#include "crayon_profiler.h"
+#include "crayon_segment.h"
+#include "crayon_bpe.h"
+#include "crayon_parallel.h"
+
+// _core.BUILD_MODE, from setup.py's CRAYON_PGO / CRAYON_LTO
+#if defined(CRAYON_BUILD_PGO) && CRAYON_BUILD_PGO == 1
+    #define CRAYON_BUILD_MODE_PGO "pgo-generate"
+#elif defined(CRAYON_BUILD_PGO) && CRAYON_BUILD_PGO == 2
+    #define CRAYON_BUILD_MODE_PGO "pgo-use"
+#else
+    #define CRAYON_BUILD_MODE_PGO ""
+#endif
+#if defined(CRAYON_BUILD_LTO)
+    #define CRAYON_BUILD_MODE_LTO "lto"
+#else
+    #define CRAYON_BUILD_MODE_LTO ""
+#endif
 
 // ----------------------------------------------------------------------------
-// Builder Structures (Intermediate, non-aligned for construction)
+// Trie Capsules
 // ----------------------------------------------------------------------------
 
-typedef struct BuilderNode {
-    int32_t token_id;
-    uint8_t key;
-    struct BuilderNode* first_child;
-    struct BuilderNode* next_sibling;
-} BuilderNode;
+#define TRIE_CAPSULE_NAME "crayon_trie_root"
+
+static void capsule_cleanup(PyObject* capsule) {
+    crayon_free((crayon_trie*)PyCapsule_GetPointer(capsule, TRIE_CAPSULE_NAME));
+}
+
+/**
+ * @brief Wrap a trie reference in a capsule (steals the reference).
+ */
+static PyObject* trie_to_capsule(CrayonTrie* trie) {
+    PyObject* capsule = PyCapsule_New(trie, TRIE_CAPSULE_NAME, capsule_cleanup);
+    if (!capsule) crayon_free(trie);
+    return capsule;
+}
 
-static BuilderNode* create_builder_node(uint8_t key) {
-    BuilderNode* node = (BuilderNode*)malloc(sizeof(BuilderNode));
-    if (node) {
-        node->token_id = -1;
-        node->key = key;
-        node->first_child = NULL;
-        node->next_sibling = NULL;
+static CrayonTrie* trie_from_capsule(PyObject* capsule) {
+    CrayonTrie* trie = (CrayonTrie*)PyCapsule_GetPointer(capsule, TRIE_CAPSULE_NAME);
+    if (!trie) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_ValueError, "Invalid Trie Capsule");
     }
-    return node;
+    return trie;
+}
+
+/**
+ * @brief Whether a buffer format (NULL means unsigned bytes) is exactly one
+ * of the single-character codes in accepted.
+ */
+static int format_is_one_of(const char* format, const char* accepted) {
+    return !format || (format[0] != '\0' && format[1] == '\0' && strchr(accepted, format[0]));
 }
 
-static void free_builder_node(BuilderNode* node) {
-    if (!node) return;
-    free_builder_node(node->first_child);
-    free_builder_node(node->next_sibling);
-    free(node);
+/**
+ * @brief Borrow a C-contiguous float32 buffer (array('f'), numpy float32).
+ */
+static int get_float32_buffer(PyObject* obj, Py_buffer* view) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) return -1;
+    if (view->itemsize != 4 || (view->format && strcmp(view->format, "f") != 0)) {
+        PyBuffer_Release(view);
+        PyErr_SetString(PyExc_TypeError, "scores must be a buffer of float32");
+        return -1;
+    }
+    return 0;
 }
 
 // ----------------------------------------------------------------------------
-// Trie Memory Management
+// Python Method: build_trie
 // ----------------------------------------------------------------------------
 
 /**
- * @brief Recursively frees the TrieNode structure contents.
+ * build_trie(tokens, scores=None) -> capsule
+ *
+ * scores: optional float32 buffer of per-token log-probabilities (unigram
+ * LM), stored in the terminal nodes for tokenize_optimal and sample.
  */
-static void free_trie_node_contents(TrieNode* node) {
-    if (!node) return;
+static PyObject* crayon_build_trie(PyObject* self, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"tokens", "scores", NULL};
+    PyObject* token_list;
+    PyObject* scores_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &token_list, &scores_obj)) {
+        return NULL;
+    }
+    if (!PyList_Check(token_list)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a list of strings");
+        return NULL;
+    }
 
-    if (node->child_count > 0 && node->children) {
-        for (uint16_t i = 0; i < node->child_count; i++) {
-            // Recurse to free grandchildren arrays
-            free_trie_node_contents(&node->children[i]);
-        }
-        // Free aligned arrays - use our aligned free
-        free_trie_node_array(node->children);
-        free(node->child_chars);
-        node->children = NULL;
-        node->child_chars = NULL;
+    // 1. Borrow the UTF-8 buffers (cached on each str, valid while the list holds it)
+    Py_ssize_t num_tokens = PyList_Size(token_list);
+    const char** tokens = (const char**)PyMem_Malloc((num_tokens ? num_tokens : 1) * sizeof(char*));
+    size_t* lengths = (size_t*)PyMem_Malloc((num_tokens ? num_tokens : 1) * sizeof(size_t));
+    if (!tokens || !lengths) {
+        PyMem_Free(tokens);
+        PyMem_Free(lengths);
+        return PyErr_NoMemory();
     }
-}
 
-static void capsule_cleanup(PyObject* capsule) {
-    TrieNode* root = (TrieNode*)PyCapsule_GetPointer(capsule, "crayon_trie_root");
-    if (root) {
-        free_trie_node_contents(root);
-        // Free the root itself (allocated with aligned_alloc_64)
-        aligned_free_64(root);
-    }
-}
-
-// ----------------------------------------------------------------------------
-// Builder Logic - Populate TrieNode from BuilderNode with ALIGNED allocation
-// ----------------------------------------------------------------------------
-
-static int populate_trie_node(TrieNode* t_node, BuilderNode* b_node) {
-    // Clear to zeros
-    memset(t_node, 0, sizeof(TrieNode));
-    t_node->token_id = b_node->token_id;
-    t_node->child_bitmap = 0;
-    
-    // Count children
-    int count = 0;
-    BuilderNode* curr = b_node->first_child;
-    while (curr) { count++; curr = curr->next_sibling; }
-    t_node->child_count = (uint16_t)count;
-
-    if (count > 0) {
-        // Allocate ALIGNED Children Array (CRITICAL for cache line optimization)
-        t_node->children = alloc_trie_node_array(count);
-        if (!t_node->children) return -1;
-        
-        // Allocate Char Array (Padding for SIMD over-read safety - round up to 32)
-        int char_pad = (count + 31) & ~31;
-        t_node->child_chars = (uint8_t*)calloc(char_pad, sizeof(uint8_t));
-        if (!t_node->child_chars) {
-            free_trie_node_array(t_node->children);
-            t_node->children = NULL;
-            return -1;
+    for (Py_ssize_t i = 0; i < num_tokens; i++) {
+        Py_ssize_t length;
+        tokens[i] = PyUnicode_AsUTF8AndSize(PyList_GET_ITEM(token_list, i), &length);
+        if (!tokens[i]) {
+            PyMem_Free(tokens);
+            PyMem_Free(lengths);
+            return NULL;
         }
+        lengths[i] = (size_t)length;
+    }
 
-        // Sort children by key for binary search (required for SIMD masking)
-        // First collect into arrays
-        BuilderNode** child_ptrs = (BuilderNode**)malloc(count * sizeof(BuilderNode*));
-        if (!child_ptrs) {
-            free_trie_node_array(t_node->children);
-            free(t_node->child_chars);
-            return -1;
+    // 2. Compile through the public libcrayon entry point
+    crayon_trie* trie;
+    int rc = crayon_build(tokens, lengths, (size_t)num_tokens, &trie);
+    PyMem_Free(tokens);
+    PyMem_Free(lengths);
+    if (rc == CRAYON_EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "Too many tokens");
+        return NULL;
+    }
+    if (rc != CRAYON_OK) return PyErr_NoMemory();
+
+    // 3. Scores go into the nodes before anyone else can see the trie
+    if (scores_obj != Py_None) {
+        Py_buffer scores;
+        if (get_float32_buffer(scores_obj, &scores) != 0) {
+            crayon_free(trie);
+            return NULL;
         }
-        
-        curr = b_node->first_child;
-        for (int i = 0; i < count; i++) {
-            child_ptrs[i] = curr;
-            curr = curr->next_sibling;
+        if (scores.len / 4 != num_tokens) {
+            PyBuffer_Release(&scores);
+            crayon_free(trie);
+            PyErr_SetString(PyExc_ValueError, "scores must have one entry per token");
+            return NULL;
         }
-        
-        // Sort by key (simple insertion sort for small arrays)
-        for (int i = 1; i < count; i++) {
-            BuilderNode* key_node = child_ptrs[i];
-            int j = i - 1;
-            while (j >= 0 && child_ptrs[j]->key > key_node->key) {
-                child_ptrs[j + 1] = child_ptrs[j];
-                j--;
-            }
-            child_ptrs[j + 1] = key_node;
+        crayon_trie_set_scores(trie, (const float*)scores.buf, (size_t)num_tokens);
+        PyBuffer_Release(&scores);
+    }
+
+    // 4. Wrap in Capsule with destructor
+    return trie_to_capsule(trie);
+}
+
+// ----------------------------------------------------------------------------
+// Python Methods: share_trie / attach_trie (Cross-Interpreter Handles)
+// ----------------------------------------------------------------------------
+
+/**
+ * Process-wide lease table. share_trie() takes a trie reference and parks it
+ * under an integer handle; attach_trie() claims the lease and wraps that same
+ * reference in a capsule owned by the calling interpreter. The table lives in
+ * C statics (shared by every interpreter) and is guarded by a spinlock since
+ * sub-interpreters may run under different GILs.
+ */
+#define MAX_TRIE_LEASES 256
+
+typedef struct {
+    long long handle;           // 0 = free entry
+    CrayonTrie* trie;
+} TrieLease;
+
+static TrieLease trie_leases[MAX_TRIE_LEASES];
+static long long next_lease_handle = 1;
+static crayon_spinlock trie_lease_lock = CRAYON_SPINLOCK_INIT;
+
+static PyObject* crayon_share_trie(PyObject* self, PyObject* capsule) {
+    CrayonTrie* trie = trie_from_capsule(capsule);
+    if (!trie) return NULL;
+
+    long long handle = 0;
+    crayon_spin_lock(&trie_lease_lock);
+    for (int i = 0; i < MAX_TRIE_LEASES; i++) {
+        if (trie_leases[i].handle == 0) {
+            handle = next_lease_handle++;
+            crayon_retain(trie);
+            trie_leases[i].handle = handle;
+            trie_leases[i].trie = trie;
+            break;
         }
+    }
+    crayon_spin_unlock(&trie_lease_lock);
 
-        // Populate in sorted order
-        for (int i = 0; i < count; i++) {
-            BuilderNode* child_b = child_ptrs[i];
-            t_node->child_chars[i] = child_b->key;
-            
-            // Set bitmap bit for O(1) existence check (ASCII only)
-            if (child_b->key < 64) {
-                t_node->child_bitmap |= (1ULL << child_b->key);
-            }
-            
-            // Recurse to populate child (in aligned array)
-            if (populate_trie_node(&t_node->children[i], child_b) != 0) {
-                free(child_ptrs);
-                return -1;
-            }
+    if (handle == 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Too many unclaimed trie handles");
+        return NULL;
+    }
+    return PyLong_FromLongLong(handle);
+}
+
+static CrayonTrie* claim_trie_lease(long long handle) {
+    CrayonTrie* trie = NULL;
+    crayon_spin_lock(&trie_lease_lock);
+    for (int i = 0; i < MAX_TRIE_LEASES; i++) {
+        if (handle != 0 && trie_leases[i].handle == handle) {
+            trie = trie_leases[i].trie;
+            trie_leases[i].handle = 0;
+            trie_leases[i].trie = NULL;
+            break;
         }
-        
-        free(child_ptrs);
     }
+    crayon_spin_unlock(&trie_lease_lock);
+    return trie;
+}
+
+static PyObject* crayon_attach_trie(PyObject* self, PyObject* handle_obj) {
+    long long handle = PyLong_AsLongLong(handle_obj);
+    if (handle == -1 && PyErr_Occurred()) return NULL;
+
+    CrayonTrie* trie = claim_trie_lease(handle);
+    if (!trie) {
+        PyErr_SetString(PyExc_ValueError, "Unknown or already claimed trie handle");
+        return NULL;
+    }
+    // The lease's reference now belongs to this interpreter's capsule
+    return trie_to_capsule(trie);
+}
+
+static PyObject* crayon_release_trie(PyObject* self, PyObject* handle_obj) {
+    long long handle = PyLong_AsLongLong(handle_obj);
+    if (handle == -1 && PyErr_Occurred()) return NULL;
+
+    CrayonTrie* trie = claim_trie_lease(handle);
+    if (!trie) {
+        PyErr_SetString(PyExc_ValueError, "Unknown or already claimed trie handle");
+        return NULL;
+    }
+    crayon_free(trie);
+    Py_RETURN_NONE;
+}
+
+// ----------------------------------------------------------------------------
+// Token List Construction (shared by crayon_tokenize_fast and Tokenizer)
+// ----------------------------------------------------------------------------
+
+// Short prompts match into a stack buffer: no heap allocation per call
+#define STACK_TOKEN_CAPACITY 512
+
+// Inputs at least this long are matched with the GIL released
+#define GIL_RELEASE_THRESHOLD 4096
+
+/**
+ * @brief Borrow the UTF-8 bytes of a str, or the raw bytes of a buffer.
+ *
+ * For str the cached UTF-8 representation is used (no copy). For other
+ * objects view is filled and must be released with PyBuffer_Release if
+ * view->obj is set on return.
+ */
+static int get_text_bytes(PyObject* obj, const char** text, Py_ssize_t* length,
+                          Py_buffer* view) {
+    view->obj = NULL;
+    if (PyUnicode_Check(obj)) {
+        *text = PyUnicode_AsUTF8AndSize(obj, length);
+        return *text ? 0 : -1;
+    }
+    if (PyObject_GetBuffer(obj, view, PyBUF_SIMPLE) != 0) {
+        PyErr_SetString(PyExc_TypeError, "Expected str or bytes-like text");
+        return -1;
+    }
+    *text = (const char*)view->buf;
+    *length = view->len;
     return 0;
 }
 
+// Exact-size list filled in place (no PyList_Append growth)
+static PyObject* ids_to_list(const int32_t* ids, size_t count) {
+    PyObject* result = PyList_New((Py_ssize_t)count);
+    if (!result) return NULL;
+    for (size_t i = 0; i < count; i++) {
+        PyObject* val = PyLong_FromLong(ids[i]);
+        if (!val) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, (Py_ssize_t)i, val);
+    }
+    return result;
+}
+
+/**
+ * @brief crayon_tokenize_bounded, profiled when the sampler picks this call.
+ *
+ * root is a TrieNode for CRAYON_VIEW_NODE, else that view's matcher; other
+ * views go through the kernel table. Touches no Python objects, so callers
+ * may hold or release the GIL.
+ */
+static size_t tokenize_with_profile(CrayonMetricEntry entry, CrayonViewKind view,
+                                    const void* root, const uint8_t* text, size_t length,
+                                    int32_t unk_token_id, int32_t* out, size_t capacity,
+                                    size_t* consumed) {
+    CrayonSink sink = {out, NULL, capacity, 0, 0, 0};
+    if (!crayon_profiler_sample()) {
+        if (view == CRAYON_VIEW_NODE) {
+            return crayon_tokenize_bounded((const TrieNode*)root, text, length, unk_token_id,
+                                           out, capacity, consumed);
+        }
+        *consumed = crayon_kernels[view][CRAYON_SINK_I32](root, text, length, unk_token_id, &sink);
+        return sink.count;
+    }
+    uint64_t start = crayon_now_ns();
+    *consumed = crayon_kernels[view][CRAYON_SINK_LOOKAHEAD](root, text, length, unk_token_id,
+                                                             &sink);
+    uint64_t elapsed = crayon_now_ns() - start;
+    crayon_profiler_submit(entry, text, *consumed, sink.count,
+                           crayon_metrics_count_unk(out, sink.count, unk_token_id),
+                           sink.lookahead, elapsed);
+    return sink.count;
+}
+
+static PyObject* tokenize_to_list(CrayonViewKind view, const void* root, const char* text,
+                                  Py_ssize_t text_length, int32_t unk_token_id) {
+    uint64_t metrics_start = crayon_metrics_start();
+    int32_t stack_ids[STACK_TOKEN_CAPACITY];
+    int32_t* ids = stack_ids;
+
+    // Worst case is one token per byte
+    if (text_length > STACK_TOKEN_CAPACITY) {
+        ids = (int32_t*)malloc((size_t)text_length * sizeof(int32_t));
+        if (!ids) return PyErr_NoMemory();
+    }
+
+    // The trie is immutable and the text buffer is owned by an argument the
+    // caller keeps alive, so matching needs no Python state at all.
+    size_t count;
+    size_t consumed;
+    if (text_length >= GIL_RELEASE_THRESHOLD) {
+        Py_BEGIN_ALLOW_THREADS
+        count = tokenize_with_profile(CRAYON_METRIC_TOKENIZE, view, root,
+                                      (const uint8_t*)text, (size_t)text_length, unk_token_id,
+                                      ids, (size_t)text_length, &consumed);
+        CRAYON_STATS_FLUSH();
+        Py_END_ALLOW_THREADS
+    } else {
+        count = tokenize_with_profile(CRAYON_METRIC_TOKENIZE, view, root,
+                                      (const uint8_t*)text, (size_t)text_length, unk_token_id,
+                                      ids, (size_t)text_length, &consumed);
+        CRAYON_STATS_FLUSH();
+    }
+
+    PyObject* result = ids_to_list(ids, count);
+    if (result && metrics_start) {
+        crayon_metrics_record(CRAYON_METRIC_TOKENIZE, metrics_start, (size_t)text_length, count,
+                              crayon_metrics_count_unk(ids, count, unk_token_id));
+    }
+
+    if (ids != stack_ids) free(ids);
+    return result;
+}
+
 // ----------------------------------------------------------------------------
-// Python Method: build_trie
+// Python Method: crayon_tokenize_fast
 // ----------------------------------------------------------------------------
 
-static PyObject* crayon_build_trie(PyObject* self, PyObject* args) {
-    PyObject* token_list;
-    if (!PyArg_ParseTuple(args, "O", &token_list)) return NULL;
-    if (!PyList_Check(token_list)) {
-        PyErr_SetString(PyExc_TypeError, "Expected a list of strings");
+static PyObject* crayon_tokenize_fast(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {
+    if (nargs != 3) {
+        PyErr_Format(PyExc_TypeError,
+                     "crayon_tokenize_fast expected 3 arguments, got %zd", nargs);
         return NULL;
     }
 
-    // 1. Build Intermediate Tree (linked-list based for easy construction)
-    BuilderNode* root_b = create_builder_node(0);
-    if (!root_b) {
-        PyErr_NoMemory();
+    CrayonTrie* trie = trie_from_capsule(args[1]);
+    if (!trie) return NULL;
+
+    long unk_token_id = PyLong_AsLong(args[2]);
+    if (unk_token_id == -1 && PyErr_Occurred()) return NULL;
+
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(args[0], &text, &text_length, &view) != 0) return NULL;
+
+    PyObject* result = tokenize_to_list(CRAYON_VIEW_NODE, trie->root, text, text_length, (int32_t)unk_token_id);
+
+    if (view.obj) PyBuffer_Release(&view);
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Native Type: Tokenizer (trie + UNK ID bound once, one C call per text)
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    PyObject_HEAD
+    PyObject* trie;             // Capsule owning the trie (kept alive)
+    CrayonViewKind view;        // Matcher behind root
+    const void* root;           // TrieNode, or the CrayonHashMatcher
+    CrayonHashMatcher* hash;    // Owned by the "hash" engine, else NULL
+    CrayonBpe* bpe;             // Owned when built with merges, else NULL
+    int32_t unk_token_id;
+} CrayonTokenizer;
+
+static PyObject* Tokenizer_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"trie", "unk_token_id", "engine", "merges", "bpe_cache", NULL};
+    PyObject* trie;
+    int unk_token_id;
+    const char* engine = "trie";
+    PyObject* merges_obj = Py_None;
+    Py_ssize_t bpe_cache = 4096;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oi|sOn", kwlist, &trie, &unk_token_id,
+                                     &engine, &merges_obj, &bpe_cache)) {
         return NULL;
     }
-    
-    Py_ssize_t num_tokens = PyList_Size(token_list);
 
-    for (Py_ssize_t i = 0; i < num_tokens; i++) {
-        PyObject* item = PyList_GetItem(token_list, i);
-        const char* token = PyUnicode_AsUTF8(item);
-        if (!token) { 
-            free_builder_node(root_b); 
-            return NULL; 
+    CrayonTrie* handle = trie_from_capsule(trie);
+    if (!handle) return NULL;
+    if (bpe_cache < 0) {
+        PyErr_SetString(PyExc_ValueError, "bpe_cache must be non-negative");
+        return NULL;
+    }
+
+    CrayonBpe* bpe = NULL;
+    if (merges_obj != Py_None) {
+        Py_buffer merges;
+        if (PyObject_GetBuffer(merges_obj, &merges, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) {
+            return NULL;
+        }
+        if (merges.itemsize != 4 || !format_is_one_of(merges.format, "il") ||
+            (merges.len / 4) % 3 != 0) {
+            PyBuffer_Release(&merges);
+            PyErr_SetString(PyExc_TypeError,
+                            "merges must be an int32 buffer of (left, right, merged) triples");
+            return NULL;
         }
+        bpe = crayon_bpe_new((const int32_t*)merges.buf, (size_t)(merges.len / 12),
+                             (size_t)bpe_cache);
+        PyBuffer_Release(&merges);
+        if (!bpe) return PyErr_NoMemory();
+    }
 
-        // Skip empty tokens
-        if (*token == '\0') continue;
-
-        BuilderNode* curr = root_b;
-        for (const char* c = token; *c; c++) {
-            uint8_t key = (uint8_t)*c;
-            
-            // Find existing child
-            BuilderNode* child = curr->first_child;
-            BuilderNode* prev = NULL;
-            while (child && child->key != key) {
-                prev = child;
-                child = child->next_sibling;
+    CrayonHashMatcher* hash = NULL;
+    if (strcmp(engine, "hash") == 0) {
+        int too_long;
+        hash = crayon_hash_matcher_build(handle->root, &too_long);
+        if (!hash) {
+            crayon_bpe_free(bpe);
+            if (too_long) {
+                PyErr_Format(PyExc_ValueError,
+                             "the hash engine needs tokens of at most %d bytes",
+                             CRAYON_HASH_MAX_LENGTH);
+                return NULL;
             }
+            return PyErr_NoMemory();
+        }
+    } else if (strcmp(engine, "trie") != 0) {
+        crayon_bpe_free(bpe);
+        PyErr_Format(PyExc_ValueError, "unknown engine '%s' (expected 'trie' or 'hash')", engine);
+        return NULL;
+    }
 
-            if (!child) {
-                // Create new child
-                child = create_builder_node(key);
-                if (!child) {
-                    free_builder_node(root_b);
-                    PyErr_NoMemory();
-                    return NULL;
-                }
-                if (prev) prev->next_sibling = child;
-                else curr->first_child = child;
-            }
-            curr = child;
+    CrayonTokenizer* self = (CrayonTokenizer*)type->tp_alloc(type, 0);
+    if (!self) {
+        crayon_hash_matcher_free(hash);
+        crayon_bpe_free(bpe);
+        return NULL;
+    }
+    Py_INCREF(trie);
+    self->trie = trie;
+    self->hash = hash;
+    self->bpe = bpe;
+    self->view = hash ? CRAYON_VIEW_HASH : CRAYON_VIEW_NODE;
+    self->root = hash ? (const void*)hash : (const void*)handle->root;
+    self->unk_token_id = (int32_t)unk_token_id;
+    return (PyObject*)self;
+}
+
+static void Tokenizer_dealloc(CrayonTokenizer* self) {
+    // Heap type: instances own a reference to their type
+    PyTypeObject* type = Py_TYPE(self);
+    crayon_hash_matcher_free(self->hash);
+    crayon_bpe_free(self->bpe);
+    Py_XDECREF(self->trie);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static size_t tokenizer_count(const CrayonTokenizer* self, const uint8_t* text, size_t length) {
+    if (self->view == CRAYON_VIEW_NODE) {
+        return crayon_count_tokens((const TrieNode*)self->root, text, length);
+    }
+    CrayonSink sink = {NULL, NULL, 0, 0, 0, 0};
+    crayon_kernels[self->view][CRAYON_SINK_COUNT](self->root, text, length, -1, &sink);
+    return sink.count;
+}
+
+static PyObject* Tokenizer_tokenize(CrayonTokenizer* self, PyObject* text_obj) {
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(text_obj, &text, &text_length, &view) != 0) return NULL;
+
+    PyObject* result = tokenize_to_list(self->view, self->root, text, text_length, self->unk_token_id);
+
+    if (view.obj) PyBuffer_Release(&view);
+    return result;
+}
+
+static PyObject* Tokenizer_count(CrayonTokenizer* self, PyObject* text_obj) {
+    uint64_t metrics_start = crayon_metrics_start();
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(text_obj, &text, &text_length, &view) != 0) return NULL;
+
+    size_t count;
+    if (text_length >= GIL_RELEASE_THRESHOLD) {
+        Py_BEGIN_ALLOW_THREADS
+        count = tokenizer_count(self, (const uint8_t*)text, (size_t)text_length);
+        CRAYON_STATS_FLUSH();
+        Py_END_ALLOW_THREADS
+    } else {
+        count = tokenizer_count(self, (const uint8_t*)text, (size_t)text_length);
+        CRAYON_STATS_FLUSH();
+    }
+
+    if (view.obj) PyBuffer_Release(&view);
+    crayon_metrics_record(CRAYON_METRIC_COUNT, metrics_start, (size_t)text_length, count, 0);
+    return PyLong_FromSize_t(count);
+}
+
+/**
+ * tokenize_into(text, out) -> int
+ *
+ * Writes token IDs into a caller-owned writable buffer and returns the
+ * count, so a reused buffer costs no allocation per call. 4-byte items
+ * (array('i'), numpy int32) take any ID; 2-byte items (array('H'), numpy
+ * uint16) are filled by the uint16 kernel and raise OverflowError if an ID
+ * does not fit. Raises ValueError if out fills up before the text is
+ * consumed.
+ */
+static PyObject* Tokenizer_tokenize_into(CrayonTokenizer* self, PyObject* const* args,
+                                         Py_ssize_t nargs) {
+    if (nargs != 2) {
+        PyErr_SetString(PyExc_TypeError, "tokenize_into(text, out) takes exactly 2 arguments");
+        return NULL;
+    }
+    uint64_t metrics_start = crayon_metrics_start();
+
+    Py_buffer out;
+    if (PyObject_GetBuffer(args[1], &out, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) {
+        return NULL;
+    }
+    int wide = out.itemsize == 4 && format_is_one_of(out.format, "ilI");
+    // Unsigned only: IDs 0x8000-0xFFFF would read back negative from 'h'
+    int narrow = out.itemsize == 2 && format_is_one_of(out.format, "H");
+    if (!wide && !narrow) {
+        PyBuffer_Release(&out);
+        PyErr_SetString(PyExc_TypeError,
+                        "out must be a writable buffer of 32-bit or unsigned 16-bit integers");
+        return NULL;
+    }
+
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(args[0], &text, &text_length, &view) != 0) {
+        PyBuffer_Release(&out);
+        return NULL;
+    }
+
+    size_t capacity = (size_t)(out.len / out.itemsize);
+    size_t consumed;
+    size_t count;
+    CrayonSink sink = {out.buf, NULL, capacity, 0, 0, 0};
+    CrayonKernel narrow_kernel = crayon_kernels[self->view][CRAYON_SINK_U16];
+    if (text_length >= GIL_RELEASE_THRESHOLD) {
+        Py_BEGIN_ALLOW_THREADS
+        if (wide) {
+            count = tokenize_with_profile(CRAYON_METRIC_TOKENIZE_INTO, self->view, self->root,
+                                          (const uint8_t*)text, (size_t)text_length,
+                                          self->unk_token_id, (int32_t*)out.buf, capacity,
+                                          &consumed);
+        } else {
+            consumed = narrow_kernel(self->root, (const uint8_t*)text, (size_t)text_length,
+                                     self->unk_token_id, &sink);
+            count = sink.count;
+        }
+        CRAYON_STATS_FLUSH();
+        Py_END_ALLOW_THREADS
+    } else {
+        if (wide) {
+            count = tokenize_with_profile(CRAYON_METRIC_TOKENIZE_INTO, self->view, self->root,
+                                          (const uint8_t*)text, (size_t)text_length,
+                                          self->unk_token_id, (int32_t*)out.buf, capacity,
+                                          &consumed);
+        } else {
+            consumed = narrow_kernel(self->root, (const uint8_t*)text, (size_t)text_length,
+                                     self->unk_token_id, &sink);
+            count = sink.count;
         }
-        // Mark end of token
-        curr->token_id = (int32_t)i;
+        CRAYON_STATS_FLUSH();
     }
 
-    // 2. Allocate the Root (64-byte aligned)
-    TrieNode* root_t = alloc_trie_node();
-    if (!root_t) {
-        free_builder_node(root_b);
+    size_t unk = 0;
+    if (metrics_start && wide) {
+        unk = crayon_metrics_count_unk((const int32_t*)out.buf, count, self->unk_token_id);
+    } else if (metrics_start) {
+        const uint16_t* ids = (const uint16_t*)out.buf;
+        for (size_t i = 0; i < count; i++) unk += ids[i] == (uint16_t)self->unk_token_id;
+    }
+    if (view.obj) PyBuffer_Release(&view);
+    PyBuffer_Release(&out);
+
+    if (sink.truncated) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "token ID does not fit in a 16-bit output buffer");
+        return NULL;
+    }
+    if (consumed < (size_t)text_length) {
+        PyErr_Format(PyExc_ValueError,
+                     "output buffer too small (%zu slots, stopped at byte %zu of %zd)",
+                     capacity, consumed, text_length);
+        return NULL;
+    }
+    crayon_metrics_record(CRAYON_METRIC_TOKENIZE_INTO, metrics_start, (size_t)text_length,
+                          count, unk);
+    return PyLong_FromSize_t(count);
+}
+
+/**
+ * tokenize_batch(texts) -> list[list[int]]
+ *
+ * One C call for many short texts: arguments are resolved once, all texts
+ * are matched into a single ID buffer (GIL released when the batch is
+ * large), then the per-text lists are built.
+ */
+static PyObject* Tokenizer_tokenize_batch(CrayonTokenizer* self, PyObject* texts_obj) {
+    uint64_t metrics_start = crayon_metrics_start();
+    // Own a snapshot of the items: the caller's list may change while the
+    // GIL is released
+    PyObject* texts = PySequence_Tuple(texts_obj);
+    if (!texts) return NULL;
+    Py_ssize_t n = PyTuple_GET_SIZE(texts);
+
+    const char** ptrs = (const char**)PyMem_Malloc((size_t)(n ? n : 1) * sizeof(char*));
+    size_t* lengths = (size_t*)PyMem_Malloc((size_t)(n ? n : 1) * sizeof(size_t));
+    size_t* counts = (size_t*)PyMem_Malloc((size_t)(n ? n : 1) * sizeof(size_t));
+    Py_buffer* views = (Py_buffer*)PyMem_Calloc((size_t)(n ? n : 1), sizeof(Py_buffer));
+    int32_t* ids = NULL;
+    PyObject* result = NULL;
+    Py_ssize_t resolved = 0;
+    size_t total = 0;
+
+    if (!ptrs || !lengths || !counts || !views) {
         PyErr_NoMemory();
+        goto done;
+    }
+
+    for (; resolved < n; resolved++) {
+        Py_ssize_t length;
+        if (get_text_bytes(PyTuple_GET_ITEM(texts, resolved), &ptrs[resolved], &length,
+                           &views[resolved]) != 0) {
+            goto done;
+        }
+        lengths[resolved] = (size_t)length;
+        total += (size_t)length;
+    }
+
+    // Worst case is one token per byte across the whole batch
+    ids = (int32_t*)malloc((total ? total : 1) * sizeof(int32_t));
+    if (!ids) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    size_t offset = 0;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        size_t consumed;
+        counts[i] = tokenize_with_profile(CRAYON_METRIC_BATCH, self->view, self->root,
+                                          (const uint8_t*)ptrs[i], lengths[i],
+                                          self->unk_token_id, ids + offset, lengths[i],
+                                          &consumed);
+        offset += counts[i];
+    }
+    CRAYON_STATS_FLUSH();
+    Py_END_ALLOW_THREADS
+
+    result = PyList_New(n);
+    if (!result) goto done;
+    size_t offset_out = 0;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject* list = ids_to_list(ids + offset_out, counts[i]);
+        if (!list) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyList_SET_ITEM(result, i, list);
+        offset_out += counts[i];
+    }
+    if (metrics_start) {
+        crayon_metrics_record(CRAYON_METRIC_BATCH, metrics_start, total, offset_out,
+                              crayon_metrics_count_unk(ids, offset_out, self->unk_token_id));
+    }
+
+done:
+    for (Py_ssize_t i = 0; i < resolved; i++) {
+        if (views[i].obj) PyBuffer_Release(&views[i]);
+    }
+    free(ids);
+    PyMem_Free(ptrs);
+    PyMem_Free(lengths);
+    PyMem_Free(counts);
+    PyMem_Free(views);
+    Py_DECREF(texts);
+    return result;
+}
+
+/**
+ * tokenize_parallel(text, threads=0, segment_size=0) -> list[int]
+ *
+ * Same IDs as tokenize(), for one large text: cut before split-safe
+ * whitespace into ~segment_size (default 1 MiB) segments matched on
+ * native threads (0 = every online CPU) with the GIL released.
+ */
+static PyObject* Tokenizer_tokenize_parallel(CrayonTokenizer* self, PyObject* args,
+                                             PyObject* kwds) {
+    static char* kwlist[] = {"text", "threads", "segment_size", NULL};
+    PyObject* text_obj;
+    int threads = 0;
+    Py_ssize_t segment_size = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|in", kwlist, &text_obj, &threads,
+                                     &segment_size)) {
         return NULL;
     }
+    if (segment_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "segment_size must be non-negative");
+        return NULL;
+    }
+    uint64_t metrics_start = crayon_metrics_start();
+
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(text_obj, &text, &text_length, &view) != 0) return NULL;
+
+    PyObject* result = NULL;
+    int32_t* ids = (int32_t*)malloc((size_t)(text_length ? text_length : 1) * sizeof(int32_t));
+    if (!ids) {
+        PyErr_NoMemory();
+        goto done;
+    }
 
-    // 3. Populate the optimized trie from builder
-    if (populate_trie_node(root_t, root_b) != 0) {
-        free_builder_node(root_b);
-        aligned_free_64(root_t);
+    const CrayonTrie* trie = trie_from_capsule(self->trie);
+    size_t count;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = crayon_tokenize_parallel(trie, self->view, self->root, (const uint8_t*)text,
+                                  (size_t)text_length, self->unk_token_id, threads,
+                                  (size_t)segment_size, ids, &count);
+    CRAYON_STATS_FLUSH();
+    Py_END_ALLOW_THREADS
+    if (rc != 0) {
         PyErr_NoMemory();
+        goto done;
+    }
+
+    result = ids_to_list(ids, count);
+    if (result && metrics_start) {
+        crayon_metrics_record(CRAYON_METRIC_TOKENIZE, metrics_start, (size_t)text_length, count,
+                              crayon_metrics_count_unk(ids, count, self->unk_token_id));
+    }
+
+done:
+    free(ids);
+    if (view.obj) PyBuffer_Release(&view);
+    return result;
+}
+
+/**
+ * tokenize_optimal(text, scores=None, unk_score=-100.0) -> list[int]
+ *
+ * Fewest-token segmentation by dynamic programming over the trie match
+ * lattice, instead of greedy longest-match. With scores (a float32 buffer
+ * of per-token log-probabilities indexed by ID, e.g. array('f')), or
+ * without them on a trie built with scores, the segmentation with the
+ * highest total score instead; each UNK byte scores unk_score. Always
+ * walks the trie, whatever the engine.
+ */
+static PyObject* Tokenizer_tokenize_optimal(CrayonTokenizer* self, PyObject* args,
+                                            PyObject* kwds) {
+    static char* kwlist[] = {"text", "scores", "unk_score", NULL};
+    PyObject* text_obj;
+    PyObject* scores_obj = Py_None;
+    float unk_score = -100.0f;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Of", kwlist, &text_obj, &scores_obj,
+                                     &unk_score)) {
+        return NULL;
+    }
+    uint64_t metrics_start = crayon_metrics_start();
+
+    CrayonTrie* trie = trie_from_capsule(self->trie);
+    Py_buffer scores = {0};
+    CrayonSegmentCosts costs = {NULL, 0, unk_score, 0};
+    if (scores_obj != Py_None) {
+        if (get_float32_buffer(scores_obj, &scores) != 0) return NULL;
+        costs.scores = (const float*)scores.buf;
+        costs.score_count = (size_t)(scores.len / 4);
+    } else {
+        costs.from_trie = trie->scored;
+    }
+
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(text_obj, &text, &text_length, &view) != 0) {
+        if (scores.obj) PyBuffer_Release(&scores);
         return NULL;
     }
 
-    // 4. Cleanup Builder Tree
-    free_builder_node(root_b);
+    PyObject* result = NULL;
+    int32_t* ids = (int32_t*)malloc((size_t)(text_length ? text_length : 1) * sizeof(int32_t));
+    if (!ids) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    const TrieNode* root = trie->root;
+    const CrayonSegmentCosts* cost_model = (scores.obj || costs.from_trie) ? &costs : NULL;
+    size_t count;
+    int rc;
+    if (text_length >= GIL_RELEASE_THRESHOLD) {
+        Py_BEGIN_ALLOW_THREADS
+        rc = crayon_segment_optimal(root, (const uint8_t*)text, (size_t)text_length,
+                                    self->unk_token_id, cost_model, ids, &count);
+        Py_END_ALLOW_THREADS
+    } else {
+        rc = crayon_segment_optimal(root, (const uint8_t*)text, (size_t)text_length,
+                                    self->unk_token_id, cost_model, ids, &count);
+    }
+    if (rc != 0) {
+        PyErr_NoMemory();
+        goto done;
+    }
 
-    // 5. Wrap in Capsule with destructor
-    return PyCapsule_New(root_t, "crayon_trie_root", capsule_cleanup);
+    result = ids_to_list(ids, count);
+    if (result && metrics_start) {
+        crayon_metrics_record(CRAYON_METRIC_OPTIMAL, metrics_start, (size_t)text_length, count,
+                              crayon_metrics_count_unk(ids, count, self->unk_token_id));
+    }
+
+done:
+    free(ids);
+    if (view.obj) PyBuffer_Release(&view);
+    if (scores.obj) PyBuffer_Release(&scores);
+    return result;
 }
 
-// ----------------------------------------------------------------------------
-// Python Method: crayon_tokenize_fast
-// ----------------------------------------------------------------------------
+/**
+ * Sampler RNG of the calling thread, seeded by seed_sampling() or on first
+ * use from the clock and the thread. Per thread, so concurrent samplers
+ * never share state and a seeded thread is reproducible on its own.
+ */
+static CRAYON_THREAD_LOCAL CrayonRng sampler_rng;
+static CRAYON_THREAD_LOCAL int sampler_rng_seeded;
+
+static CrayonRng* thread_sampler_rng(void) {
+    if (!sampler_rng_seeded) {
+        crayon_rng_seed(&sampler_rng, crayon_now_ns() ^ (uint64_t)(uintptr_t)&sampler_rng);
+        sampler_rng_seeded = 1;
+    }
+    return &sampler_rng;
+}
+
+/**
+ * sample(text, alpha=1.0, unk_score=-100.0, seed=None) -> list[int]
+ *
+ * One segmentation drawn from the unigram LM distribution given by the
+ * trie's scores (build_trie(tokens, scores)), sharpened by alpha: subword
+ * regularization for training. seed draws from a fresh RNG for this call;
+ * otherwise the calling thread's RNG (seed_sampling) advances.
+ */
+static PyObject* Tokenizer_sample(CrayonTokenizer* self, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"text", "alpha", "unk_score", "seed", NULL};
+    PyObject* text_obj;
+    float alpha = 1.0f;
+    float unk_score = -100.0f;
+    PyObject* seed_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|ffO", kwlist, &text_obj, &alpha,
+                                     &unk_score, &seed_obj)) {
+        return NULL;
+    }
+    CrayonRng call_rng;
+    CrayonRng* rng = thread_sampler_rng();
+    if (seed_obj != Py_None) {
+        unsigned long long seed = PyLong_AsUnsignedLongLongMask(seed_obj);
+        if (seed == (unsigned long long)-1 && PyErr_Occurred()) return NULL;
+        crayon_rng_seed(&call_rng, (uint64_t)seed);
+        rng = &call_rng;
+    }
+    uint64_t metrics_start = crayon_metrics_start();
+
+    const char* text;
+    Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(text_obj, &text, &text_length, &view) != 0) return NULL;
+
+    PyObject* result = NULL;
+    int32_t* ids = (int32_t*)malloc((size_t)(text_length ? text_length : 1) * sizeof(int32_t));
+    if (!ids) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    const TrieNode* root = trie_from_capsule(self->trie)->root;
+    size_t count;
+    int rc;
+    if (text_length >= GIL_RELEASE_THRESHOLD) {
+        Py_BEGIN_ALLOW_THREADS
+        rc = crayon_segment_sample(root, (const uint8_t*)text, (size_t)text_length,
+                                   self->unk_token_id, unk_score, alpha, rng, ids, &count);
+        Py_END_ALLOW_THREADS
+    } else {
+        rc = crayon_segment_sample(root, (const uint8_t*)text, (size_t)text_length,
+                                   self->unk_token_id, unk_score, alpha, rng, ids, &count);
+    }
+    if (rc != 0) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    result = ids_to_list(ids, count);
+    if (result && metrics_start) {
+        crayon_metrics_record(CRAYON_METRIC_SAMPLE, metrics_start, (size_t)text_length, count,
+                              crayon_metrics_count_unk(ids, count, self->unk_token_id));
+    }
+
+done:
+    free(ids);
+    if (view.obj) PyBuffer_Release(&view);
+    return result;
+}
+
+/**
+ * tokenize_bpe(text) -> list[int]
+ *
+ * BPE-merge encoding with the ranked merges given at construction: words
+ * from the pre-tokenizer start as one symbol per character and merge
+ * lowest rank first. Repeated short words are served from the word cache.
+ */
+static PyObject* Tokenizer_tokenize_bpe(CrayonTokenizer* self, PyObject* text_obj) {
+    if (!self->bpe) {
+        PyErr_SetString(PyExc_ValueError, "Tokenizer was built without merges");
+        return NULL;
+    }
+    uint64_t metrics_start = crayon_metrics_start();
 
-static PyObject* crayon_tokenize_fast(PyObject* self, PyObject* args) {
     const char* text;
     Py_ssize_t text_length;
+    Py_buffer view;
+    if (get_text_bytes(text_obj, &text, &text_length, &view) != 0) return NULL;
+
+    PyObject* result = NULL;
+    int32_t* ids = (int32_t*)malloc((size_t)(text_length ? text_length : 1) * sizeof(int32_t));
+    if (!ids) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    const TrieNode* root = trie_from_capsule(self->trie)->root;
+    size_t count;
+    int rc;
+    if (text_length >= GIL_RELEASE_THRESHOLD) {
+        Py_BEGIN_ALLOW_THREADS
+        rc = crayon_bpe_encode(self->bpe, root, (const uint8_t*)text, (size_t)text_length,
+                               self->unk_token_id, ids, &count);
+        Py_END_ALLOW_THREADS
+    } else {
+        rc = crayon_bpe_encode(self->bpe, root, (const uint8_t*)text, (size_t)text_length,
+                               self->unk_token_id, ids, &count);
+    }
+    if (rc != 0) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    result = ids_to_list(ids, count);
+    if (result && metrics_start) {
+        crayon_metrics_record(CRAYON_METRIC_BPE, metrics_start, (size_t)text_length, count,
+                              crayon_metrics_count_unk(ids, count, self->unk_token_id));
+    }
+
+done:
+    free(ids);
+    if (view.obj) PyBuffer_Release(&view);
+    return result;
+}
+
+static PyObject* Tokenizer_bpe_cache_stats(CrayonTokenizer* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->bpe) Py_RETURN_NONE;
+    uint64_t hits, misses;
+    crayon_bpe_cache_stats(self->bpe, &hits, &misses);
+    return Py_BuildValue("{sKsK}", "hits", (unsigned long long)hits,
+                         "misses", (unsigned long long)misses);
+}
+
+static PyObject* Tokenizer_get_trie(CrayonTokenizer* self, void* closure) {
+    Py_INCREF(self->trie);
+    return self->trie;
+}
+
+static PyObject* Tokenizer_get_unk_token_id(CrayonTokenizer* self, void* closure) {
+    return PyLong_FromLong(self->unk_token_id);
+}
+
+static PyObject* Tokenizer_get_engine(CrayonTokenizer* self, void* closure) {
+    return PyUnicode_FromString(self->hash ? "hash" : "trie");
+}
+
+static PyMethodDef Tokenizer_methods[] = {
+    {"tokenize", (PyCFunction)Tokenizer_tokenize, METH_O, "Tokenize str/bytes to a list of token IDs"},
+    {"count", (PyCFunction)Tokenizer_count, METH_O, "Number of tokens in str/bytes (nothing materialized)"},
+    {"tokenize_into", (PyCFunction)(void(*)(void))Tokenizer_tokenize_into, METH_FASTCALL,
+     "Write token IDs into a writable int32 buffer; returns the count"},
+    {"tokenize_batch", (PyCFunction)Tokenizer_tokenize_batch, METH_O,
+     "Tokenize a sequence of str/bytes in one call; returns a list of lists"},
+    {"tokenize_parallel", (PyCFunction)(void(*)(void))Tokenizer_tokenize_parallel,
+     METH_VARARGS | METH_KEYWORDS,
+     "tokenize() of one large str/bytes on native threads (identical IDs)"},
+    {"tokenize_optimal", (PyCFunction)(void(*)(void))Tokenizer_tokenize_optimal,
+     METH_VARARGS | METH_KEYWORDS,
+     "Fewest-token (or, with scores, highest-scoring) segmentation of str/bytes"},
+    {"sample", (PyCFunction)(void(*)(void))Tokenizer_sample, METH_VARARGS | METH_KEYWORDS,
+     "Segmentation of str/bytes sampled from the trie's unigram scores"},
+    {"tokenize_bpe", (PyCFunction)Tokenizer_tokenize_bpe, METH_O,
+     "BPE-merge encoding of str/bytes (needs merges=)"},
+    {"bpe_cache_stats", (PyCFunction)Tokenizer_bpe_cache_stats, METH_NOARGS,
+     "BPE word cache {'hits', 'misses'}, or None without merges"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Tokenizer_getset[] = {
+    {"trie", (getter)Tokenizer_get_trie, NULL, "Trie capsule", NULL},
+    {"unk_token_id", (getter)Tokenizer_get_unk_token_id, NULL, "UNK token ID", NULL},
+    {"engine", (getter)Tokenizer_get_engine, NULL, "Longest-match engine: 'trie' or 'hash'", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+// Heap type (one per interpreter, stored in module state)
+static PyType_Slot Tokenizer_slots[] = {
+    {Py_tp_doc, "Tokenizer(trie, unk_token_id, engine='trie', merges=None, bpe_cache=4096): "
+                "compiled trie bound to its UNK ID; engine='hash' matches by hashed prefix "
+                "lookup (tokens <= 16 bytes); merges (int32 (left, right, merged) triples, "
+                "best rank first) enable tokenize_bpe"},
+    {Py_tp_new, Tokenizer_new},
+    {Py_tp_dealloc, Tokenizer_dealloc},
+    {Py_tp_methods, Tokenizer_methods},
+    {Py_tp_getset, Tokenizer_getset},
+    {0, NULL}
+};
+
+static PyType_Spec Tokenizer_spec = {
+    .name = "crayon.c_ext._core.Tokenizer",
+    .basicsize = sizeof(CrayonTokenizer),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = Tokenizer_slots,
+};
+
+// ----------------------------------------------------------------------------
+// Python Methods: tokenize_jsonl / tokenize_csv (Native Corpus Readers)
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Growable token shard filled by the corpus reader callback.
+ *
+ * ids holds every token of every extracted field back to back; offsets
+ * holds record boundaries so record k is ids[offsets[k]:offsets[k + 1]].
+ */
+typedef struct {
+    const TrieNode* root;
+    int32_t unk_token_id;
+    int32_t* ids;
+    size_t id_count;
+    size_t id_capacity;
+    int64_t* offsets;
+    size_t offset_count;
+    size_t offset_capacity;
+} CorpusShard;
+
+static int corpus_shard_add_field(const uint8_t* data, size_t length, void* ctx) {
+    CorpusShard* shard = (CorpusShard*)ctx;
+
+    // Worst case is one token per byte
+    if (shard->id_count + length > shard->id_capacity) {
+        size_t new_capacity = shard->id_capacity * 2;
+        if (new_capacity < shard->id_count + length) new_capacity = shard->id_count + length;
+        int32_t* ids = (int32_t*)realloc(shard->ids, new_capacity * sizeof(int32_t));
+        if (!ids) return CRAYON_READER_ERR_NOMEM;
+        shard->ids = ids;
+        shard->id_capacity = new_capacity;
+    }
+    if (shard->offset_count == shard->offset_capacity) {
+        size_t new_capacity = shard->offset_capacity * 2;
+        int64_t* offsets = (int64_t*)realloc(shard->offsets, new_capacity * sizeof(int64_t));
+        if (!offsets) return CRAYON_READER_ERR_NOMEM;
+        shard->offsets = offsets;
+        shard->offset_capacity = new_capacity;
+    }
+
+    size_t consumed;
+    shard->id_count += tokenize_with_profile(CRAYON_METRIC_CORPUS, CRAYON_VIEW_NODE,
+                                             shard->root, data, length, shard->unk_token_id,
+                                             shard->ids + shard->id_count, length, &consumed);
+    shard->offsets[shard->offset_count++] = (int64_t)shard->id_count;
+    return 0;
+}
+
+/**
+ * @brief Read a whole file into a malloc'd buffer (readers unescape in place).
+ * @return 0 on success, errno-style code otherwise.
+ */
+static int read_whole_file(const char* path, uint8_t** out_buf, size_t* out_length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return errno ? errno : ENOENT;
+
+    if (fseek(f, 0, SEEK_END) != 0) { fclose(f); return EIO; }
+    long size = ftell(f);
+    if (size < 0 || fseek(f, 0, SEEK_SET) != 0) { fclose(f); return EIO; }
+
+    uint8_t* buf = (uint8_t*)malloc((size_t)size + 1);
+    if (!buf) { fclose(f); return ENOMEM; }
+
+    size_t read = fread(buf, 1, (size_t)size, f);
+    fclose(f);
+    if (read != (size_t)size) { free(buf); return EIO; }
+
+    *out_buf = buf;
+    *out_length = read;
+    return 0;
+}
+
+static PyObject* tokenize_corpus_file(PyObject* args, int is_csv) {
+    PyObject* path_bytes;
+    const char* field;
     PyObject* vocab_obj;
     int unk_token_id;
+    long long max_records = -1;
 
-    if (!PyArg_ParseTuple(args, "s#Oi", &text, &text_length, &vocab_obj, &unk_token_id)) {
+    if (!PyArg_ParseTuple(args, "O&sOi|L", PyUnicode_FSConverter, &path_bytes,
+                          &field, &vocab_obj, &unk_token_id, &max_records)) {
         return NULL;
     }
+    uint64_t metrics_start = crayon_metrics_start();
 
-    TrieNode* root = (TrieNode*)PyCapsule_GetPointer(vocab_obj, "crayon_trie_root");
-    if (!root) {
-        PyErr_SetString(PyExc_ValueError, "Invalid Trie Capsule");
+    CrayonTrie* trie = trie_from_capsule(vocab_obj);
+    if (!trie) {
+        Py_DECREF(path_bytes);
+        return NULL;
+    }
+
+    CorpusShard shard = {0};
+    shard.root = trie->root;
+    shard.unk_token_id = unk_token_id;
+    shard.offset_capacity = 1024;
+    shard.offsets = (int64_t*)malloc(shard.offset_capacity * sizeof(int64_t));
+    if (!shard.offsets) {
+        Py_DECREF(path_bytes);
+        return PyErr_NoMemory();
+    }
+    shard.offsets[shard.offset_count++] = 0;
+
+    uint8_t* buf = NULL;
+    size_t length = 0;
+    int io_error;
+    long long rc = 0;
+
+    // File -> fields -> token IDs without touching Python objects
+    Py_BEGIN_ALLOW_THREADS
+    io_error = read_whole_file(PyBytes_AS_STRING(path_bytes), &buf, &length);
+    if (io_error == 0) {
+        rc = is_csv
+            ? crayon_scan_csv(buf, length, field, corpus_shard_add_field, &shard, max_records)
+            : crayon_scan_jsonl(buf, length, field, corpus_shard_add_field, &shard, max_records);
+        free(buf);
+    }
+    CRAYON_STATS_FLUSH();
+    Py_END_ALLOW_THREADS
+
+    PyObject* result = NULL;
+    if (io_error != 0) {
+        errno = io_error;
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path_bytes);
+    } else if (rc == CRAYON_READER_ERR_NOMEM) {
+        PyErr_NoMemory();
+    } else if (rc == CRAYON_READER_ERR_COLUMN) {
+        PyErr_Format(PyExc_KeyError, "CSV column '%s' not found in header", field);
+    } else if (rc == CRAYON_READER_ERR_FIELD) {
+        PyErr_Format(PyExc_ValueError, "Invalid field path '%s'", field);
+    } else {
+        if (metrics_start) {
+            crayon_metrics_record(CRAYON_METRIC_CORPUS, metrics_start, length, shard.id_count,
+                                  crayon_metrics_count_unk(shard.ids, shard.id_count,
+                                                           shard.unk_token_id));
+        }
+        result = Py_BuildValue(
+            "(NN)",
+            PyByteArray_FromStringAndSize((const char*)shard.ids,
+                                          (Py_ssize_t)(shard.id_count * sizeof(int32_t))),
+            PyByteArray_FromStringAndSize((const char*)shard.offsets,
+                                          (Py_ssize_t)(shard.offset_count * sizeof(int64_t)))
+        );
+    }
+
+    free(shard.ids);
+    free(shard.offsets);
+    Py_DECREF(path_bytes);
+    return result;
+}
+
+static PyObject* crayon_tokenize_jsonl(PyObject* self, PyObject* args) {
+    return tokenize_corpus_file(args, 0);
+}
+
+static PyObject* crayon_tokenize_csv(PyObject* self, PyObject* args) {
+    return tokenize_corpus_file(args, 1);
+}
+
+// ----------------------------------------------------------------------------
+// Python Method: xxh64 (Content Hashing for the Persistent Cache)
+// ----------------------------------------------------------------------------
+
+static PyObject* crayon_xxh64(PyObject* self, PyObject* args) {
+    PyObject* data;
+    unsigned long long seed = 0;
+
+    if (!PyArg_ParseTuple(args, "O|K", &data, &seed)) return NULL;
+
+    // str: hash the cached UTF-8 representation without copying
+    if (PyUnicode_Check(data)) {
+        Py_ssize_t length;
+        const char* utf8 = PyUnicode_AsUTF8AndSize(data, &length);
+        if (!utf8) return NULL;
+        return PyLong_FromUnsignedLongLong(xxh64(utf8, (size_t)length, seed));
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) != 0) return NULL;
+    uint64_t h;
+    Py_BEGIN_ALLOW_THREADS
+    h = xxh64(view.buf, (size_t)view.len, seed);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+    return PyLong_FromUnsignedLongLong(h);
+}
+
+// ----------------------------------------------------------------------------
+// Python Methods: serialize_trie / load_trie (Binary Vocabulary Images)
+// ----------------------------------------------------------------------------
+
+static PyObject* crayon_serialize_trie(PyObject* self, PyObject* capsule) {
+    CrayonTrie* trie = trie_from_capsule(capsule);
+    if (!trie) return NULL;
+
+    uint8_t* image;
+    size_t length;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = crayon_save_image(trie, &image, &length);
+    Py_END_ALLOW_THREADS
+    if (rc != CRAYON_OK) return PyErr_NoMemory();
+
+    PyObject* result = PyBytes_FromStringAndSize((const char*)image, (Py_ssize_t)length);
+    crayon_buffer_free(image);
+    return result;
+}
+
+static PyObject* crayon_load_trie(PyObject* self, PyObject* image_obj) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(image_obj, &view, PyBUF_SIMPLE) != 0) return NULL;
+
+    crayon_trie* trie;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = crayon_load_image(view.buf, (size_t)view.len, &trie);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    if (rc == CRAYON_EMALFORMED) {
+        PyErr_SetString(PyExc_ValueError, "Invalid trie image");
+        return NULL;
+    }
+    if (rc != CRAYON_OK) return PyErr_NoMemory();
+    return trie_to_capsule(trie);
+}
+
+// ----------------------------------------------------------------------------
+// Python Methods: unigram scores and the sampler RNG
+// ----------------------------------------------------------------------------
+
+static void collect_scores(const TrieNode* node, float* scores, size_t count) {
+    if (node->token_id >= 0 && (size_t)node->token_id < count) {
+        scores[node->token_id] = node->log_prob;
+    }
+    for (uint16_t i = 0; i < node->child_count; i++) {
+        collect_scores(&node->children[i], scores, count);
+    }
+}
+
+/**
+ * trie_scores(trie, count) -> bytes | None
+ *
+ * The float32 log-probabilities stored by build_trie(tokens, scores) (or
+ * carried by a loaded image) for IDs 0..count-1, or None if unscored.
+ */
+static PyObject* crayon_trie_scores(PyObject* self, PyObject* args) {
+    PyObject* capsule;
+    Py_ssize_t count;
+    if (!PyArg_ParseTuple(args, "On", &capsule, &count)) return NULL;
+    CrayonTrie* trie = trie_from_capsule(capsule);
+    if (!trie) return NULL;
+    if (!trie->scored) Py_RETURN_NONE;
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must be non-negative");
         return NULL;
     }
 
-    // Pre-allocate result list with estimated capacity
-    Py_ssize_t estimated_tokens = text_length / 4 + 1;
-    PyObject* result = PyList_New(0);
+    PyObject* result = PyBytes_FromStringAndSize(NULL, count * (Py_ssize_t)sizeof(float));
     if (!result) return NULL;
-    
-    Py_ssize_t position = 0;
+    float* scores = (float*)PyBytes_AS_STRING(result);
+    memset(scores, 0, (size_t)count * sizeof(float));
+    collect_scores(trie->root, scores, (size_t)count);
+    return result;
+}
+
+static PyObject* crayon_seed_sampling(PyObject* self, PyObject* seed_obj) {
+    unsigned long long seed = PyLong_AsUnsignedLongLongMask(seed_obj);
+    if (seed == (unsigned long long)-1 && PyErr_Occurred()) return NULL;
+    crayon_rng_seed(&sampler_rng, (uint64_t)seed);
+    sampler_rng_seeded = 1;
+    Py_RETURN_NONE;
+}
+
+// ----------------------------------------------------------------------------
+// Python Method: split_bytes (Cut Points for Tokenizer.tokenize_parallel)
+// ----------------------------------------------------------------------------
+
+/**
+ * split_bytes(trie) -> bytes
+ *
+ * Whitespace bytes tokenize_parallel may cut before: none of them occurs
+ * past the first byte of any token (checked when the trie was built or
+ * loaded). Empty when the vocabulary allows no exact cut.
+ */
+static PyObject* crayon_split_bytes(PyObject* self, PyObject* capsule) {
+    CrayonTrie* trie = trie_from_capsule(capsule);
+    if (!trie) return NULL;
+    char safe[256];
+    Py_ssize_t n = 0;
+    for (int b = 0; b < 256; b++) {
+        if (crayon_split_safe(trie, (uint8_t)b)) safe[n++] = (char)b;
+    }
+    return PyBytes_FromStringAndSize(safe, n);
+}
+
+// ----------------------------------------------------------------------------
+// Python Methods: get_stats / reset_stats (CRAYON_STATS builds only)
+// ----------------------------------------------------------------------------
+
+#if defined(CRAYON_STATS)
 
-    // Hot Loop Optimization: Pre-create unk token object
-    PyObject* py_unk = PyLong_FromLong(unk_token_id);
-    if (!py_unk) {
-        Py_DECREF(result);
+static PyObject* crayon_get_stats(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    CrayonStats stats;
+    crayon_stats_snapshot(&stats);
+
+    PyObject* depth = PyList_New(CRAYON_STATS_DEPTH_BUCKETS);
+    if (!depth) return NULL;
+    for (int i = 0; i < CRAYON_STATS_DEPTH_BUCKETS; i++) {
+        PyObject* val = PyLong_FromUnsignedLongLong(stats.depth[i]);
+        if (!val) {
+            Py_DECREF(depth);
+            return NULL;
+        }
+        PyList_SET_ITEM(depth, i, val);
+    }
+
+    return Py_BuildValue(
+        "{sKsKsKsKsKsKsKsN}",
+        "calls", (unsigned long long)stats.calls,
+        "tokens", (unsigned long long)stats.tokens,
+        "unk_tokens", (unsigned long long)stats.unk_tokens,
+        "steps", (unsigned long long)stats.steps,
+        "simd_lookups", (unsigned long long)stats.simd_lookups,
+        "bsearch_lookups", (unsigned long long)stats.bsearch_lookups,
+        "wasted_bytes", (unsigned long long)stats.wasted_bytes,
+        "depth_histogram", depth
+    );
+}
+
+static PyObject* crayon_reset_stats(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    crayon_stats_reset();
+    Py_RETURN_NONE;
+}
+
+#else
+
+static PyObject* crayon_get_stats(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "traversal stats are not compiled in (rebuild with CRAYON_STATS=1)");
+    return NULL;
+}
+
+static PyObject* crayon_reset_stats(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    return crayon_get_stats(self, NULL);
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Python Methods: metrics registry (always compiled, enabled at runtime)
+// ----------------------------------------------------------------------------
+
+static const char* const metric_entry_names[CRAYON_METRIC_ENTRIES] = {
+    "tokenize", "count", "tokenize_into", "tokenize_batch", "corpus", "tokenize_optimal",
+    "sample", "tokenize_bpe",
+};
+
+static PyObject* crayon_set_metrics_enabled(PyObject* self, PyObject* flag) {
+    int enabled = PyObject_IsTrue(flag);
+    if (enabled < 0) return NULL;
+    crayon_metrics_set_enabled(enabled);
+    Py_RETURN_NONE;
+}
+
+static PyObject* crayon_metrics_enabled_py(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    return PyBool_FromLong(crayon_metrics_enabled());
+}
+
+/**
+ * get_metrics() -> {entry: {calls, bytes_in, tokens_out, unk_tokens,
+ *                           latency_sum_ns, latency: [(floor_ns, ceil_ns, count)]}}
+ *
+ * Only non-empty latency buckets are listed; ceil_ns is exclusive.
+ */
+static PyObject* crayon_get_metrics(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    CrayonMetricsSnapshot* snap = (CrayonMetricsSnapshot*)PyMem_Malloc(sizeof(*snap));
+    if (!snap) return PyErr_NoMemory();
+    Py_BEGIN_ALLOW_THREADS
+    crayon_metrics_snapshot(snap);
+    Py_END_ALLOW_THREADS
+
+    PyObject* result = PyDict_New();
+    for (int e = 0; result && e < CRAYON_METRIC_ENTRIES; e++) {
+        const CrayonMetricSeries* series = &snap->entries[e];
+        PyObject* buckets = PyList_New(0);
+        for (size_t i = 0; buckets && i < CRAYON_METRICS_BUCKETS; i++) {
+            if (!series->latency[i]) continue;
+            PyObject* item = Py_BuildValue("(KKK)",
+                (unsigned long long)crayon_metrics_bucket_floor(i),
+                (unsigned long long)crayon_metrics_bucket_floor(i + 1),
+                (unsigned long long)series->latency[i]);
+            if (!item || PyList_Append(buckets, item) < 0) Py_CLEAR(buckets);
+            Py_XDECREF(item);
+        }
+        PyObject* entry = buckets ? Py_BuildValue(
+            "{sKsKsKsKsKsN}",
+            "calls", (unsigned long long)series->calls,
+            "bytes_in", (unsigned long long)series->bytes_in,
+            "tokens_out", (unsigned long long)series->tokens_out,
+            "unk_tokens", (unsigned long long)series->unk_tokens,
+            "latency_sum_ns", (unsigned long long)series->latency_sum_ns,
+            "latency", buckets) : NULL;
+        if (!entry || PyDict_SetItemString(result, metric_entry_names[e], entry) < 0) {
+            Py_CLEAR(result);
+        }
+        Py_XDECREF(entry);
+    }
+
+    PyMem_Free(snap);
+    return result;
+}
+
+static PyObject* crayon_reset_metrics(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    crayon_metrics_reset();
+    Py_RETURN_NONE;
+}
+
+// ----------------------------------------------------------------------------
+// Python Methods: sampling profiler (outlier ring buffer)
+// ----------------------------------------------------------------------------
+
+static PyObject* crayon_configure_profiler(PyObject* self, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"sample_every", "ns_per_byte", "lookahead_per_token", "capacity", NULL};
+    long sample_every = 0;
+    double ns_per_byte = 0.0;
+    double lookahead_per_token = 0.0;
+    Py_ssize_t capacity = 256;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|lddn", kwlist, &sample_every, &ns_per_byte,
+                                     &lookahead_per_token, &capacity)) {
         return NULL;
     }
+    if (sample_every < 0 || capacity < 0) {
+        PyErr_SetString(PyExc_ValueError, "sample_every and capacity must be >= 0");
+        return NULL;
+    }
+    if (crayon_profiler_configure(sample_every, ns_per_byte, lookahead_per_token,
+                                  (size_t)capacity) != 0) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
 
-    while (position < text_length) {
-        int match_length = 0;
-        int32_t token_id = -1;
-        
-        const TrieNode* curr = root;
-        int curr_len = 0;
-        
-        // Max lookahead or remaining string length
-        Py_ssize_t limit = text_length - position;
-        const char* sub = text + position;
-
-        for (Py_ssize_t i = 0; i < limit; i++) {
-            uint8_t target = (uint8_t)sub[i];
-            
-            // SIMD Child Lookup [cite: 414]
-            int idx = find_child_simd(curr, target);
-            if (idx == -1) break;
-
-            curr = &curr->children[idx];
-            curr_len++;
-
-            // Track longest match
-            if (curr->token_id != -1) {
-                token_id = curr->token_id;
-                match_length = curr_len;
-            }
+/**
+ * profiler_dump(clear=False) -> list[dict], oldest first
+ *
+ * Each record: entry, hash, timestamp_ns, elapsed_ns, bytes, tokens,
+ * unk_tokens, lookahead_bytes, invalid_utf8.
+ */
+static PyObject* crayon_profiler_dump_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"clear", NULL};
+    int clear = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p", kwlist, &clear)) return NULL;
+
+    CrayonProfileRecord* records;
+    long n = crayon_profiler_dump(&records, clear);
+    if (n < 0) return PyErr_NoMemory();
+
+    PyObject* result = PyList_New(n);
+    for (long i = 0; result && i < n; i++) {
+        const CrayonProfileRecord* r = &records[i];
+        PyObject* item = Py_BuildValue(
+            "{sssKsKsKsKsKsKsKsO}",
+            "entry", metric_entry_names[r->entry],
+            "hash", (unsigned long long)r->hash,
+            "timestamp_ns", (unsigned long long)r->timestamp_ns,
+            "elapsed_ns", (unsigned long long)r->elapsed_ns,
+            "bytes", (unsigned long long)r->bytes,
+            "tokens", (unsigned long long)r->tokens,
+            "unk_tokens", (unsigned long long)r->unk_tokens,
+            "lookahead_bytes", (unsigned long long)r->lookahead_bytes,
+            "invalid_utf8", (r->flags & CRAYON_PROFILE_INVALID_UTF8) ? Py_True : Py_False);
+        if (!item) {
+            Py_CLEAR(result);
+            break;
         }
+        PyList_SET_ITEM(result, i, item);
+    }
+    free(records);
+    return result;
+}
 
-        if (match_length > 0) {
-            PyObject* val = PyLong_FromLong(token_id);
-            if (!val) {
-                Py_DECREF(py_unk);
-                Py_DECREF(result);
-                return NULL;
-            }
-            PyList_Append(result, val);
-            Py_DECREF(val);
-            position += match_length;
-        } else {
-            // Unknown character - use pre-created object
-            PyList_Append(result, py_unk);
-            position += 1;
+static PyObject* crayon_profiler_stats(PyObject* self, PyObject* Py_UNUSED(ignored)) {
+    CrayonProfilerCounts counts;
+    crayon_profiler_counts(&counts);
+    return Py_BuildValue("{sKsKsKsl}",
+                         "sampled", (unsigned long long)counts.sampled,
+                         "outliers", (unsigned long long)counts.outliers,
+                         "overwritten", (unsigned long long)counts.overwritten,
+                         "sample_every", crayon_atomic_load(&crayon_profiler_every));
+}
+
+// ----------------------------------------------------------------------------
+// Native Type: PerfCounters (hardware counters around benchmark runs)
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    PyObject_HEAD
+    CrayonPerfCounters counters;
+    int running;
+} CrayonPerfCountersObject;
+
+static PyObject* PerfCounters_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist)) return NULL;
+
+    CrayonPerfCountersObject* self = (CrayonPerfCountersObject*)type->tp_alloc(type, 0);
+    if (!self) return NULL;
+    if (crayon_perf_open(&self->counters) == 0) {
+        crayon_perf_close(&self->counters);
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_OSError, "perf_event_open: no hardware counters available");
+        return NULL;
+    }
+    return (PyObject*)self;
+}
+
+static void PerfCounters_dealloc(CrayonPerfCountersObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    crayon_perf_close(&self->counters);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject* PerfCounters_start(CrayonPerfCountersObject* self, PyObject* Py_UNUSED(ignored)) {
+    self->running = 1;
+    crayon_perf_start(&self->counters);
+    Py_RETURN_NONE;
+}
+
+static PyObject* PerfCounters_stop(CrayonPerfCountersObject* self, PyObject* Py_UNUSED(ignored)) {
+    int64_t values[CRAYON_PERF_EVENT_COUNT];
+    if (!self->running) {
+        PyErr_SetString(PyExc_RuntimeError, "PerfCounters.stop() called before start()");
+        return NULL;
+    }
+    crayon_perf_stop(&self->counters, values);
+    self->running = 0;
+
+    // Only events the host could count appear in the result
+    PyObject* result = PyDict_New();
+    if (!result) return NULL;
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+        if (values[i] == CRAYON_PERF_UNAVAILABLE) continue;
+        PyObject* value = PyLong_FromLongLong(values[i]);
+        if (!value || PyDict_SetItemString(result, crayon_perf_event_names[i], value) < 0) {
+            Py_XDECREF(value);
+            Py_DECREF(result);
+            return NULL;
         }
+        Py_DECREF(value);
     }
-    
-    Py_DECREF(py_unk);
     return result;
 }
 
+static PyMethodDef PerfCounters_methods[] = {
+    {"start", (PyCFunction)PerfCounters_start, METH_NOARGS, "Reset and enable the counters"},
+    {"stop", (PyCFunction)PerfCounters_stop, METH_NOARGS, "Disable the counters; returns {event: count}"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot PerfCounters_slots[] = {
+    {Py_tp_doc, "PerfCounters(): per-thread perf_event_open counters (OSError if unavailable)"},
+    {Py_tp_new, PerfCounters_new},
+    {Py_tp_dealloc, PerfCounters_dealloc},
+    {Py_tp_methods, PerfCounters_methods},
+    {0, NULL}
+};
+
+static PyType_Spec PerfCounters_spec = {
+    .name = "crayon.c_ext._core.PerfCounters",
+    .basicsize = sizeof(CrayonPerfCountersObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = PerfCounters_slots,
+};
+
 // ----------------------------------------------------------------------------
 // Module Registration
 // ----------------------------------------------------------------------------
 
 static PyMethodDef CrayonMethods[] = {
-    {"build_trie", crayon_build_trie, METH_VARARGS, "Build SIMD-optimized C-Trie from token list"},
-    {"crayon_tokenize_fast", crayon_tokenize_fast, METH_VARARGS, "SIMD-accelerated tokenization"},
+    {"build_trie", (PyCFunction)(void(*)(void))crayon_build_trie, METH_VARARGS | METH_KEYWORDS,
+     "Build SIMD-optimized C-Trie from token list (optional float32 scores)"},
+    {"crayon_tokenize_fast", (PyCFunction)(void(*)(void))crayon_tokenize_fast, METH_FASTCALL, "SIMD-accelerated tokenization"},
+    {"tokenize_jsonl", crayon_tokenize_jsonl, METH_VARARGS, "Tokenize one string field of every JSONL line natively"},
+    {"tokenize_csv", crayon_tokenize_csv, METH_VARARGS, "Tokenize one CSV column natively"},
+    {"xxh64", crayon_xxh64, METH_VARARGS, "XXH64 of a str (UTF-8) or bytes-like object"},
+    {"share_trie", crayon_share_trie, METH_O, "Lease a trie to another interpreter; returns an integer handle"},
+    {"attach_trie", crayon_attach_trie, METH_O, "Claim a share_trie handle as a trie capsule"},
+    {"release_trie", crayon_release_trie, METH_O, "Drop an unclaimed share_trie handle"},
+    {"serialize_trie", crayon_serialize_trie, METH_O, "Serialize a trie capsule to a position-independent image"},
+    {"load_trie", crayon_load_trie, METH_O, "Rebuild a trie capsule from a serialize_trie image (bytes-like)"},
+    {"trie_scores", crayon_trie_scores, METH_VARARGS, "Per-ID float32 scores stored in a trie (bytes), or None"},
+    {"seed_sampling", crayon_seed_sampling, METH_O, "Seed the calling thread's Tokenizer.sample RNG"},
+    {"split_bytes", crayon_split_bytes, METH_O, "Whitespace bytes tokenize_parallel may cut before"},
+    {"get_stats", crayon_get_stats, METH_NOARGS, "Traversal counters (CRAYON_STATS builds)"},
+    {"reset_stats", crayon_reset_stats, METH_NOARGS, "Zero the traversal counters (CRAYON_STATS builds)"},
+    {"set_metrics_enabled", crayon_set_metrics_enabled, METH_O, "Turn the runtime metrics registry on or off"},
+    {"metrics_enabled", crayon_metrics_enabled_py, METH_NOARGS, "Whether calls are being recorded"},
+    {"get_metrics", crayon_get_metrics, METH_NOARGS, "Per-entry-point call, byte, token, UNK and latency totals"},
+    {"reset_metrics", crayon_reset_metrics, METH_NOARGS, "Rebase the metrics totals to zero"},
+    {"configure_profiler", (PyCFunction)(void(*)(void))crayon_configure_profiler, METH_VARARGS | METH_KEYWORDS,
+     "Sample every Nth call per thread; keep outliers above the thresholds (0 disables)"},
+    {"profiler_dump", (PyCFunction)(void(*)(void))crayon_profiler_dump_py, METH_VARARGS | METH_KEYWORDS,
+     "Outlier records, oldest first (clear=True empties the ring)"},
+    {"profiler_stats", crayon_profiler_stats, METH_NOARGS, "Sampled, outlier and overwritten counts"},
     {NULL, NULL, 0, NULL}
 };
 
+/**
+ * Per-interpreter module state (PEP 684). Each interpreter gets its own
+ * Tokenizer type object; compiled tries are shared process-wide only through
+ * the refcounted CrayonTrie handles above.
+ */
+typedef struct {
+    PyTypeObject* tokenizer_type;
+    PyTypeObject* perf_counters_type;
+} CrayonModuleState;
+
+static inline CrayonModuleState* get_module_state(PyObject* module) {
+    return (CrayonModuleState*)PyModule_GetState(module);
+}
+
+/**
+ * Thread-safety model (free-threaded builds, PEP 703):
+ * - A compiled trie is never mutated after build_trie returns; readers need
+ *   no synchronization. Its nodes are freed when the last reference
+ *   (capsules in any interpreter, unclaimed share_trie leases) is dropped.
+ * - Process-wide mutable state, each with its own synchronization:
+ *   - the share_trie lease table, guarded by a spinlock;
+ *   - CRAYON_STATS counters: thread-local, flushed into atomic totals;
+ *   - the metrics registry: one shard per thread written with relaxed
+ *     atomics, the shard list and reset baseline under a spinlock;
+ *   - the profiler's outlier ring, guarded by a spinlock that only calls
+ *     over budget take; the sampling period is an atomic;
+ *   - the Tokenizer.sample RNG (seed_sampling): thread-local, no lock.
+ * - Per-Tokenizer mutable state: the BPE word cache, guarded by striped
+ *   spinlocks inside the encoder, with relaxed atomic hit/miss counters
+ *   (its merge table is read-only after construction).
+ * - Every call otherwise works on stack or per-call buffers.
+ */
+static int crayon_core_exec(PyObject* module) {
+    CrayonModuleState* state = get_module_state(module);
+
+#if defined(CRAYON_STATS)
+    if (PyModule_AddIntConstant(module, "STATS_ENABLED", 1) < 0) return -1;
+#else
+    if (PyModule_AddIntConstant(module, "STATS_ENABLED", 0) < 0) return -1;
+#endif
+    {
+        // "release", "pgo-use+lto", ...
+        const char* pgo = CRAYON_BUILD_MODE_PGO;
+        const char* lto = CRAYON_BUILD_MODE_LTO;
+        char mode[32];
+        if (!*pgo && !*lto) snprintf(mode, sizeof(mode), "release");
+        else snprintf(mode, sizeof(mode), "%s%s%s", pgo, *pgo && *lto ? "+" : "", lto);
+        if (PyModule_AddStringConstant(module, "BUILD_MODE", mode) < 0) return -1;
+    }
+
+    state->tokenizer_type = (PyTypeObject*)PyType_FromModuleAndSpec(module, &Tokenizer_spec, NULL);
+    if (!state->tokenizer_type) return -1;
+
+    Py_INCREF(state->tokenizer_type);
+    if (PyModule_AddObject(module, "Tokenizer", (PyObject*)state->tokenizer_type) < 0) {
+        Py_DECREF(state->tokenizer_type);
+        return -1;
+    }
+
+    state->perf_counters_type = (PyTypeObject*)PyType_FromModuleAndSpec(module, &PerfCounters_spec, NULL);
+    if (!state->perf_counters_type) return -1;
+
+    Py_INCREF(state->perf_counters_type);
+    if (PyModule_AddObject(module, "PerfCounters", (PyObject*)state->perf_counters_type) < 0) {
+        Py_DECREF(state->perf_counters_type);
+        return -1;
+    }
+    return 0;
+}
+
+static int crayon_core_traverse(PyObject* module, visitproc visit, void* arg) {
+    Py_VISIT(get_module_state(module)->tokenizer_type);
+    Py_VISIT(get_module_state(module)->perf_counters_type);
+    return 0;
+}
+
+static int crayon_core_clear(PyObject* module) {
+    Py_CLEAR(get_module_state(module)->tokenizer_type);
+    Py_CLEAR(get_module_state(module)->perf_counters_type);
+    return 0;
+}
+
+static void crayon_core_free(void* module) {
+    crayon_core_clear((PyObject*)module);
+}
+
+static PyModuleDef_Slot crayon_core_slots[] = {
+    {Py_mod_exec, crayon_core_exec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
 static struct PyModuleDef crayon_core_module = {
     PyModuleDef_HEAD_INIT,
     "crayon.c_ext._core",
     "High-Performance Crayon Core with AVX2 SIMD",
-    -1,
-    CrayonMethods
+    sizeof(CrayonModuleState),
+    CrayonMethods,
+    crayon_core_slots,
+    crayon_core_traverse,
+    crayon_core_clear,
+    crayon_core_free
 };
 
 PyMODINIT_FUNC PyInit__core(void) {
-    return PyModule_Create(&crayon_core_module);
-}
\ No newline at end of file
+    return PyModuleDef_Init(&crayon_core_module);
+}
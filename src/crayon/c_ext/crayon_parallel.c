@@ -0,0 +1,120 @@
+// pthreads and sysconf under -std=c99
+#define _POSIX_C_SOURCE 200809L
+
+#include "crayon_parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include "byte_tables.h"
+#include "crayon_atomic.h"
+#include "crayon_thread.h"
+
+int crayon_split_safe(const CrayonTrie* trie, uint8_t b) {
+    return (crayon_byte_class[b] & CRAYON_BYTE_SPACE) &&
+           !(trie->inner_bytes[b >> 3] & (1u << (b & 7)));
+}
+
+size_t crayon_plan_segments(const CrayonTrie* trie, const uint8_t* text, size_t length,
+                            size_t segment_size, size_t* cuts, size_t max_cuts) {
+    uint8_t safe[256];
+    int any = 0;
+    for (int b = 0; b < 256; b++) {
+        safe[b] = (uint8_t)crayon_split_safe(trie, (uint8_t)b);
+        any |= safe[b];
+    }
+    if (!any || segment_size == 0) return 0;
+
+    size_t n = 0;
+    size_t pos = segment_size;
+    while (n < max_cuts && pos < length) {
+        while (pos < length && !safe[text[pos]]) pos++;
+        if (pos >= length) break;
+        cuts[n++] = pos;
+        pos += segment_size;
+    }
+    return n;
+}
+
+typedef struct {
+    CrayonKernel kernel;
+    const void* root;
+    const uint8_t* text;
+    int32_t unk_token_id;
+    int32_t* out;
+    const size_t* starts;       // segments + 1 entries (last = length)
+    size_t* counts;
+    long segments;
+    crayon_atomic_long next;    // Segments claimed so far
+} ParallelJob;
+
+static CRAYON_THREAD_FN(parallel_worker) {
+    ParallelJob* job = (ParallelJob*)arg;
+    for (;;) {
+        long k = crayon_atomic_inc(&job->next) - 1;
+        if (k >= job->segments) break;
+        size_t start = job->starts[k];
+        size_t span = job->starts[k + 1] - start;
+        // A segment never yields more IDs than bytes: its own region of out fits
+        CrayonSink sink = {job->out + start, NULL, span, 0, 0, 0};
+        job->kernel(job->root, job->text + start, span, job->unk_token_id, &sink);
+        job->counts[k] = sink.count;
+    }
+    // Worker counters are thread-local and die with the thread
+    CRAYON_STATS_FLUSH();
+    return CRAYON_THREAD_RETURN;
+}
+
+int crayon_tokenize_parallel(const CrayonTrie* trie, CrayonViewKind view, const void* root,
+                             const uint8_t* text, size_t length, int32_t unk_token_id,
+                             int threads, size_t segment_size, int32_t* out, size_t* count) {
+    CrayonKernel kernel = crayon_kernels[view][CRAYON_SINK_I32];
+    if (threads <= 0) threads = crayon_cpu_count();
+    if (segment_size == 0) segment_size = CRAYON_PARALLEL_SEGMENT;
+
+    size_t max_cuts = length / segment_size;
+    if (threads == 1 || max_cuts == 0) {
+        CrayonSink sink = {out, NULL, length, 0, 0, 0};
+        kernel(root, text, length, unk_token_id, &sink);
+        *count = sink.count;
+        return 0;
+    }
+
+    size_t* starts = (size_t*)malloc((max_cuts + 2) * sizeof(size_t));
+    size_t* counts = (size_t*)malloc((max_cuts + 1) * sizeof(size_t));
+    if (!starts || !counts) {
+        free(starts);
+        free(counts);
+        return -1;
+    }
+    starts[0] = 0;
+    size_t cuts = crayon_plan_segments(trie, text, length, segment_size, starts + 1, max_cuts);
+    starts[cuts + 1] = length;
+
+    ParallelJob job = {kernel, root, text, unk_token_id, out, starts, counts,
+                       (long)(cuts + 1), 0};
+    if ((size_t)threads > cuts + 1) threads = (int)(cuts + 1);
+
+    // The calling thread works too; a worker that fails to start only
+    // leaves more segments to the others
+    crayon_thread* workers = (crayon_thread*)malloc((size_t)threads * sizeof(crayon_thread));
+    int started = 0;
+    if (workers) {
+        for (int i = 1; i < threads; i++) {
+            if (crayon_thread_start(&workers[started], parallel_worker, &job) == 0) started++;
+        }
+    }
+    parallel_worker(&job);
+    for (int i = 0; i < started; i++) crayon_thread_join(workers[i]);
+    free(workers);
+
+    // Stitch: segment k sits at out + starts[k]; slide each down in order
+    size_t total = counts[0];
+    for (size_t k = 1; k <= cuts; k++) {
+        memmove(out + total, out + starts[k], counts[k] * sizeof(int32_t));
+        total += counts[k];
+    }
+    *count = total;
+
+    free(starts);
+    free(counts);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef CRAYON_PARALLEL_H
+#define CRAYON_PARALLEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trie_builder.h"
+#include "trie_match.h"
+
+/**
+ * @brief Tokenize one large text on several native threads.
+ *
+ * The text is cut into segments of about segment_size bytes, each cut
+ * placed right before a whitespace byte that is split safe for the
+ * vocabulary: a byte that never occurs past the first byte of any token
+ * (CrayonTrie.inner_bytes, computed when the trie is built or loaded). No
+ * match can then run across the cut, so the sequential greedy stream has a
+ * token boundary there and every segment tokenizes exactly as it would in
+ * one pass. Segments are matched by worker threads into their own region
+ * of the output and compacted in order: the result is identical to
+ * crayon_tokenize_into for any thread count or segment size.
+ *
+ * A vocabulary in which every whitespace byte occurs inside some token
+ * offers no cut point; the text is then tokenized sequentially.
+ */
+
+#define CRAYON_PARALLEL_SEGMENT ((size_t)1 << 20)
+
+/**
+ * @brief Whether a cut right before byte b is exact for this trie.
+ */
+int crayon_split_safe(const CrayonTrie* trie, uint8_t b);
+
+/**
+ * @brief Choose segment starts: the first split-safe byte at or after each
+ * segment_size step. cuts receives the starts after 0, in order.
+ * @return Number of cuts written (at most max_cuts).
+ */
+size_t crayon_plan_segments(const CrayonTrie* trie, const uint8_t* text, size_t length,
+                            size_t segment_size, size_t* cuts, size_t max_cuts);
+
+/**
+ * @brief Parallel greedy tokenization into out (capacity length).
+ *
+ * view / root select the matcher (trie nodes or the hash matcher built
+ * from the same trie). threads <= 0 uses every online CPU. Touches no
+ * Python objects and is safe with the GIL released.
+ *
+ * @param count Receives the number of IDs written.
+ * @return 0 on success, -1 on allocation or thread start failure (out is
+ *         then undefined).
+ */
+int crayon_tokenize_parallel(const CrayonTrie* trie, CrayonViewKind view, const void* root,
+                             const uint8_t* text, size_t length, int32_t unk_token_id,
+                             int threads, size_t segment_size, int32_t* out, size_t* count);
+
+#endif // CRAYON_PARALLEL_H
@@ -0,0 +1,144 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime() under -std=c99
+#endif
+
+#include "crayon_profiler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "byte_tables.h"
+#include "xxhash64.h"
+
+crayon_atomic_long crayon_profiler_every = 0;
+CRAYON_THREAD_LOCAL long crayon_profiler_countdown = 0;
+
+// Everything below is guarded by profiler_lock; only outliers take it
+static crayon_spinlock profiler_lock = CRAYON_SPINLOCK_INIT;
+static CrayonProfileRecord* ring = NULL;
+static size_t ring_capacity = 0;
+static size_t ring_head = 0;            // Next slot to write
+static size_t ring_size = 0;
+static double limit_ns_per_byte = 0.0;
+static double limit_lookahead = 0.0;
+static CrayonProfilerCounts counts;     // sampled lives in sampled_calls
+static crayon_atomic_i64 sampled_calls = 0;
+
+/**
+ * @brief Strict UTF-8 check (no overlongs, surrogates or > U+10FFFF).
+ *
+ * Only run for outliers, so a scalar loop is fine.
+ */
+static int is_valid_utf8(const uint8_t* s, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        uint8_t c = s[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        // Invalid leads have length 0; the second-byte range rules out
+        // overlongs, surrogates and code points above U+10FFFF
+        size_t len = crayon_utf8_length[c];
+        if (len == 0 || len > n - i) return 0;
+        uint8_t second = s[i + 1];
+        if (second < crayon_utf8_second_min[c - 0xC0] || second > crayon_utf8_second_max[c - 0xC0]) {
+            return 0;
+        }
+        for (size_t k = 2; k < len; k++) {
+            if ((crayon_byte_class[s[i + k]] & CRAYON_BYTE_UTF8_CONT) == 0) return 0;
+        }
+        i += len;
+    }
+    return 1;
+}
+
+int crayon_profiler_configure(long sample_every, double ns_per_byte,
+                              double lookahead_per_token, size_t capacity) {
+    CrayonProfileRecord* fresh = NULL;
+    if (sample_every > 0 && capacity != ring_capacity) {
+        fresh = (CrayonProfileRecord*)calloc(capacity ? capacity : 1, sizeof(*fresh));
+        if (!fresh) return -1;
+    }
+
+    crayon_spin_lock(&profiler_lock);
+    limit_ns_per_byte = ns_per_byte;
+    limit_lookahead = lookahead_per_token;
+    if (fresh) {
+        free(ring);
+        ring = fresh;
+        ring_capacity = capacity;
+        ring_head = 0;
+        ring_size = 0;
+    }
+    crayon_spin_unlock(&profiler_lock);
+
+    crayon_atomic_store(&crayon_profiler_every, sample_every > 0 ? sample_every : 0);
+    return 0;
+}
+
+void crayon_profiler_submit(CrayonMetricEntry entry, const uint8_t* text, size_t length,
+                            size_t tokens, size_t unk_tokens, size_t lookahead,
+                            uint64_t elapsed_ns) {
+    double ns_per_byte = (double)elapsed_ns / (double)(length ? length : 1);
+    double lookahead_per_token = (double)lookahead / (double)(tokens ? tokens : 1);
+
+    // Thresholds are read racily; a reconfigure mid-call only changes one verdict
+    int outlier = (limit_ns_per_byte <= 0.0 && limit_lookahead <= 0.0) ||
+                  (limit_ns_per_byte > 0.0 && ns_per_byte > limit_ns_per_byte) ||
+                  (limit_lookahead > 0.0 && lookahead_per_token > limit_lookahead);
+
+    CrayonProfileRecord record;
+    if (outlier) {
+        // Hashing and validation happen outside the lock
+        record.hash = xxh64(text, length, 0);
+        record.timestamp_ns = crayon_now_ns();
+        record.elapsed_ns = elapsed_ns;
+        record.bytes = length;
+        record.tokens = tokens;
+        record.unk_tokens = unk_tokens;
+        record.lookahead_bytes = lookahead;
+        record.entry = (uint32_t)entry;
+        record.flags = is_valid_utf8(text, length) ? 0 : CRAYON_PROFILE_INVALID_UTF8;
+    }
+
+    crayon_atomic_add64(&sampled_calls, 1);
+    if (!outlier) return;
+
+    crayon_spin_lock(&profiler_lock);
+    counts.outliers++;
+    if (ring_capacity) {
+        if (ring_size == ring_capacity) counts.overwritten++;
+        else ring_size++;
+        ring[ring_head] = record;
+        ring_head = (ring_head + 1) % ring_capacity;
+    }
+    crayon_spin_unlock(&profiler_lock);
+}
+
+long crayon_profiler_dump(CrayonProfileRecord** out, int clear) {
+    *out = NULL;
+    crayon_spin_lock(&profiler_lock);
+    size_t n = ring_size;
+    CrayonProfileRecord* copy = n ? (CrayonProfileRecord*)malloc(n * sizeof(*copy)) : NULL;
+    if (n && !copy) {
+        crayon_spin_unlock(&profiler_lock);
+        return -1;
+    }
+    size_t start = (ring_head + ring_capacity - n) % (ring_capacity ? ring_capacity : 1);
+    for (size_t i = 0; i < n; i++) copy[i] = ring[(start + i) % ring_capacity];
+    if (clear) {
+        ring_size = 0;
+        memset(&counts, 0, sizeof(counts));
+        crayon_atomic_xchg64(&sampled_calls, 0);
+    }
+    crayon_spin_unlock(&profiler_lock);
+    *out = copy;
+    return (long)n;
+}
+
+void crayon_profiler_counts(CrayonProfilerCounts* out) {
+    crayon_spin_lock(&profiler_lock);
+    *out = counts;
+    crayon_spin_unlock(&profiler_lock);
+    out->sampled = (uint64_t)crayon_atomic_load64(&sampled_calls);
+}
@@ -0,0 +1,85 @@
+#ifndef CRAYON_PROFILER_H
+#define CRAYON_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crayon_atomic.h"
+#include "crayon_metrics.h"
+
+/**
+ * @brief Sampling profiler with per-document cost attribution.
+ *
+ * When enabled, every Nth native tokenization on each thread (a thread-local
+ * countdown, no shared writes) runs the profiled kernel, which also totals
+ * the bytes the trie walk examined. Calls whose cost exceeds the configured
+ * thresholds are copied into a bounded ring buffer together with the XXH64
+ * of their input (same value as _core.xxh64), so slow documents can be
+ * found again without keeping any text. Disabled, the check is one relaxed
+ * load per call.
+ */
+
+// CrayonProfileRecord.flags
+#define CRAYON_PROFILE_INVALID_UTF8  1u  // Input is not well-formed UTF-8
+
+typedef struct {
+    uint64_t hash;              // XXH64 (seed 0) of the input bytes
+    uint64_t timestamp_ns;      // Monotonic clock when the call finished
+    uint64_t elapsed_ns;
+    uint64_t bytes;
+    uint64_t tokens;
+    uint64_t unk_tokens;
+    uint64_t lookahead_bytes;   // Bytes examined by the trie walk, all tokens
+    uint32_t entry;             // CrayonMetricEntry of the call site
+    uint32_t flags;
+} CrayonProfileRecord;
+
+typedef struct {
+    uint64_t sampled;           // Calls that ran the profiled kernel
+    uint64_t outliers;          // Calls that crossed a threshold
+    uint64_t overwritten;       // Outliers pushed out of the full ring
+} CrayonProfilerCounts;
+
+extern crayon_atomic_long crayon_profiler_every;
+extern CRAYON_THREAD_LOCAL long crayon_profiler_countdown;
+
+/**
+ * @brief Whether the calling thread should profile this call.
+ */
+static inline int crayon_profiler_sample(void) {
+    long every = crayon_atomic_load(&crayon_profiler_every);
+    if (!every) return 0;
+    if (--crayon_profiler_countdown > 0) return 0;
+    crayon_profiler_countdown = every;
+    return 1;
+}
+
+/**
+ * @brief (Re)configure the profiler; sample_every 0 turns it off.
+ *
+ * A call is an outlier when ns per byte exceeds ns_per_byte or lookahead
+ * bytes per token exceed lookahead_per_token (a threshold of 0 is ignored;
+ * with both 0 every sampled call is kept). Resizing the ring drops its
+ * contents.
+ *
+ * @return 0 on success, -1 if the ring cannot be allocated.
+ */
+int crayon_profiler_configure(long sample_every, double ns_per_byte,
+                              double lookahead_per_token, size_t capacity);
+
+/**
+ * @brief Report one profiled call (safe without the GIL).
+ */
+void crayon_profiler_submit(CrayonMetricEntry entry, const uint8_t* text, size_t length,
+                            size_t tokens, size_t unk_tokens, size_t lookahead,
+                            uint64_t elapsed_ns);
+
+/**
+ * @brief Copy the ring, oldest first, into a malloc'd array.
+ * @return Number of records (0 with *out = NULL when empty), or -1 on
+ *         allocation failure.
+ */
+long crayon_profiler_dump(CrayonProfileRecord** out, int clear);
+
+void crayon_profiler_counts(CrayonProfilerCounts* out);
+
+#endif // CRAYON_PROFILER_H
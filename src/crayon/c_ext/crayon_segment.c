@@ -0,0 +1,146 @@
+#include "crayon_segment.h"
+#include <math.h>
+#include <stdlib.h>
+#include "simd_ops.h"
+
+int crayon_segment_optimal(const TrieNode* root, const uint8_t* text, size_t length,
+                           int32_t unk_token_id, const CrayonSegmentCosts* costs,
+                           int32_t* out, size_t* count) {
+    *count = 0;
+    if (length == 0) return 0;
+
+    // cost[i]: best cost of text[i:]; step[i], id[i]: first token of that path
+    double* cost = (double*)malloc((length + 1) * sizeof(double));
+    size_t* step = (size_t*)malloc(length * sizeof(size_t));
+    int32_t* id = (int32_t*)malloc(length * sizeof(int32_t));
+    if (!cost || !step || !id) {
+        free(cost);
+        free(step);
+        free(id);
+        return -1;
+    }
+
+    const float* scores = costs ? costs->scores : NULL;
+    size_t score_count = costs ? costs->score_count : 0;
+    double unk_cost = costs ? -(double)costs->unk_score : 1.0;
+
+    cost[length] = 0.0;
+    for (size_t i = length; i-- > 0;) {
+        double best = 0.0;
+        size_t best_step = 0;
+        int32_t best_id = unk_token_id;
+
+        // Every token starting at i is a lattice edge i -> i + depth
+        const TrieNode* node = root;
+        for (size_t j = i; j < length; j++) {
+            int idx = find_child_simd(node, text[j]);
+            if (idx == -1) break;
+            node = &node->children[idx];
+            if (node->token_id == -1) continue;
+
+            double edge = 1.0;
+            if (costs && costs->from_trie) {
+                edge = -(double)node->log_prob;
+            } else if (costs) {
+                edge = (size_t)node->token_id < score_count
+                    ? -(double)scores[node->token_id] : unk_cost;
+            }
+            double total = edge + cost[j + 1];
+            // <= : on a tie the longer token (found later) wins
+            if (best_step == 0 || total <= best) {
+                best = total;
+                best_step = j + 1 - i;
+                best_id = node->token_id;
+            }
+        }
+        if (best_step == 0) {
+            // No token starts here: one UNK byte
+            best = unk_cost + cost[i + 1];
+            best_step = 1;
+        }
+        cost[i] = best;
+        step[i] = best_step;
+        id[i] = best_id;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < length; i += step[i]) out[n++] = id[i];
+    *count = n;
+
+    free(cost);
+    free(step);
+    free(id);
+    return 0;
+}
+
+void crayon_rng_seed(CrayonRng* rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        rng->s[i] = z ^ (z >> 31);
+    }
+}
+
+int crayon_segment_sample(const TrieNode* root, const uint8_t* text, size_t length,
+                          int32_t unk_token_id, float unk_score, float alpha,
+                          CrayonRng* rng, int32_t* out, size_t* count) {
+    *count = 0;
+    if (length == 0) return 0;
+
+    double* beta = (double*)malloc((length + 1) * sizeof(double));
+    if (!beta) return -1;
+    double unk_weight = (double)alpha * unk_score;
+
+    // 1. Backward filtering; log-sum-exp kept online (one exp per edge)
+    beta[length] = 0.0;
+    for (size_t i = length; i-- > 0;) {
+        double max = -INFINITY;
+        double sum = 0.0;
+        const TrieNode* node = root;
+        for (size_t j = i; j < length; j++) {
+            int idx = find_child_simd(node, text[j]);
+            if (idx == -1) break;
+            node = &node->children[idx];
+            if (node->token_id == -1) continue;
+
+            double x = (double)alpha * node->log_prob + beta[j + 1];
+            if (x > max) {
+                sum = sum * exp(max - x) + 1.0;
+                max = x;
+            } else {
+                sum += exp(x - max);
+            }
+        }
+        beta[i] = sum > 0.0 ? max + log(sum) : unk_weight + beta[i + 1];
+    }
+
+    // 2. Forward sampling: walk the edges again at the chosen positions only
+    size_t n = 0;
+    size_t i = 0;
+    while (i < length) {
+        double target = crayon_rng_uniform(rng);
+        double cumulative = 0.0;
+        size_t pick_step = 0;
+        int32_t pick_id = unk_token_id;
+        const TrieNode* node = root;
+        for (size_t j = i; j < length; j++) {
+            int idx = find_child_simd(node, text[j]);
+            if (idx == -1) break;
+            node = &node->children[idx];
+            if (node->token_id == -1) continue;
+
+            // The last edge absorbs rounding: the probabilities sum to ~1
+            pick_step = j + 1 - i;
+            pick_id = node->token_id;
+            cumulative += exp((double)alpha * node->log_prob + beta[j + 1] - beta[i]);
+            if (cumulative > target) break;
+        }
+        out[n++] = pick_id;
+        i += pick_step ? pick_step : 1;
+    }
+    *count = n;
+
+    free(beta);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#ifndef CRAYON_SEGMENT_H
+#define CRAYON_SEGMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trie_node.h"
+
+/**
+ * @brief Optimal segmentation over the trie match lattice.
+ *
+ * Greedy longest-match commits to the longest token at each position,
+ * which can cost tokens later: with a, ab, bcd, c, d the text "abcd" is
+ * ab + c + d greedily but a + bcd optimally. This finds the segmentation
+ * with the least cost in one backward pass: cost[i] is the best cost of
+ * text[i:], and position i walks the trie forward (at most the longest
+ * token's length, so the pass is linear in the text for a fixed vocabulary).
+ *
+ *   scores == NULL   cost = number of tokens (fewest tokens)
+ *   scores != NULL   cost = -sum(scores[id]) (highest total log-probability)
+ *   from_trie        cost = -sum(node log_prob) (Viterbi over a scored trie)
+ *
+ * Like the greedy kernels, an UNK edge of one byte is used only where no
+ * token starts. Ties go to the longer token at the earlier position, so
+ * the result stays close to greedy when that is already optimal.
+ */
+
+typedef struct {
+    const float* scores;        // Per-token score by ID, or NULL
+    size_t score_count;         // Entries in scores; other IDs score unk_score
+    float unk_score;            // Score of an UNK byte (scores mode)
+    int from_trie;              // Score tokens by TrieNode.log_prob instead
+} CrayonSegmentCosts;
+
+/**
+ * @brief Segment text into out (capacity length: one token per byte at most).
+ *
+ * Touches no Python objects and is safe to call with the GIL released.
+ *
+ * @param costs NULL for fewest tokens.
+ * @param count Receives the number of IDs written.
+ * @return 0 on success, -1 on allocation failure (lattice scratch).
+ */
+int crayon_segment_optimal(const TrieNode* root, const uint8_t* text, size_t length,
+                           int32_t unk_token_id, const CrayonSegmentCosts* costs,
+                           int32_t* out, size_t* count);
+
+// ----------------------------------------------------------------------------
+// Sampled segmentation (subword regularization)
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief xoshiro256** state. Not shared: each thread (or call) owns one,
+ * so a seeded run draws the same segmentations whatever else runs.
+ */
+typedef struct {
+    uint64_t s[4];
+} CrayonRng;
+
+/**
+ * @brief Seed through splitmix64 (any seed, including 0, is fine).
+ */
+void crayon_rng_seed(CrayonRng* rng, uint64_t seed);
+
+static inline uint64_t crayon_rng_next(CrayonRng* rng) {
+    uint64_t* s = rng->s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+// Uniform in [0, 1)
+static inline double crayon_rng_uniform(CrayonRng* rng) {
+    return (double)(crayon_rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Draw one segmentation with probability proportional to
+ * exp(alpha * sum(log_prob)), the unigram LM distribution.
+ *
+ * Backward filtering computes beta[i] = log of the total weight of every
+ * segmentation of text[i:]; forward sampling then picks each token among
+ * those starting at the current position with probability
+ * exp(alpha * log_prob + beta[end] - beta[i]). (The mirror of
+ * forward-filtering/backward-sampling: the trie enumerates tokens by start
+ * position, so filtering runs backward and sampling forward.)
+ *
+ * alpha = 0 samples uniformly over segmentations; large alpha approaches
+ * the Viterbi result. An UNK byte (only where no token starts) weighs
+ * unk_score. Unscored tries have log_prob 0 everywhere.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int crayon_segment_sample(const TrieNode* root, const uint8_t* text, size_t length,
+                          int32_t unk_token_id, float unk_score, float alpha,
+                          CrayonRng* rng, int32_t* out, size_t* count);
+
+#endif // CRAYON_SEGMENT_H
@@ -0,0 +1,41 @@
+#include "crayon_stats.h"
+
+#if defined(CRAYON_STATS)
+
+#include <string.h>
+#include "crayon_atomic.h"
+
+CRAYON_THREAD_LOCAL CrayonStats crayon_tls_stats;
+
+// Process-wide totals, laid out field-for-field like CrayonStats
+static crayon_atomic_i64 global_stats[CRAYON_STATS_FIELDS];
+
+void crayon_stats_flush(void) {
+    const uint64_t* local = (const uint64_t*)&crayon_tls_stats;
+    for (size_t i = 0; i < CRAYON_STATS_FIELDS; i++) {
+        if (local[i]) crayon_atomic_add64(&global_stats[i], (long long)local[i]);
+    }
+    memset(&crayon_tls_stats, 0, sizeof(crayon_tls_stats));
+}
+
+void crayon_stats_snapshot(CrayonStats* out) {
+    uint64_t* fields = (uint64_t*)out;
+    crayon_stats_flush();
+    for (size_t i = 0; i < CRAYON_STATS_FIELDS; i++) {
+        fields[i] = (uint64_t)crayon_atomic_load64(&global_stats[i]);
+    }
+}
+
+void crayon_stats_reset(void) {
+    memset(&crayon_tls_stats, 0, sizeof(crayon_tls_stats));
+    for (size_t i = 0; i < CRAYON_STATS_FIELDS; i++) {
+        crayon_atomic_xchg64(&global_stats[i], 0);
+    }
+}
+
+#else
+
+// ISO C forbids an empty translation unit
+typedef int crayon_stats_disabled;
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef CRAYON_STATS_H
+#define CRAYON_STATS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Compile-time traversal instrumentation (build with CRAYON_STATS=1).
+ *
+ * Hot loops bump plain thread-local counters; native entry points call
+ * CRAYON_STATS_FLUSH() once per call to fold them into process-wide atomic
+ * totals, so threads running with the GIL released never contend. Without
+ * the flag every macro expands to nothing and release builds are unchanged.
+ */
+
+// Depth histogram buckets: depth 0..15 exactly, 16 = "16 or deeper"
+#define CRAYON_STATS_DEPTH_BUCKETS 17
+
+typedef struct {
+    uint64_t calls;             // Native tokenize calls (or corpus fields)
+    uint64_t tokens;            // Tokens emitted
+    uint64_t unk_tokens;        // UNK emissions (no prefix matched)
+    uint64_t steps;             // find_child_simd calls
+    uint64_t simd_lookups;      // Nodes with <= 16 children (SSE compare)
+    uint64_t bsearch_lookups;   // Nodes with > 16 children (binary search)
+    uint64_t wasted_bytes;      // Bytes walked past the last terminal
+    uint64_t depth[CRAYON_STATS_DEPTH_BUCKETS];  // Depth reached before mismatch
+} CrayonStats;
+
+#define CRAYON_STATS_FIELDS (sizeof(CrayonStats) / sizeof(uint64_t))
+
+#if defined(CRAYON_STATS)
+
+#include "crayon_atomic.h"
+
+extern CRAYON_THREAD_LOCAL CrayonStats crayon_tls_stats;
+
+// Fold this thread's counters into the global totals and zero them
+void crayon_stats_flush(void);
+
+// Copy of the global totals (after flushing the calling thread)
+void crayon_stats_snapshot(CrayonStats* out);
+
+void crayon_stats_reset(void);
+
+#define CRAYON_STAT_ADD(field, n)   (crayon_tls_stats.field += (uint64_t)(n))
+#define CRAYON_STAT_DEPTH(d)        (crayon_tls_stats.depth[(d) < CRAYON_STATS_DEPTH_BUCKETS - 1 \
+                                        ? (d) : CRAYON_STATS_DEPTH_BUCKETS - 1]++)
+#define CRAYON_STATS_FLUSH()        crayon_stats_flush()
+
+#else
+
+#define CRAYON_STAT_ADD(field, n)   ((void)0)
+#define CRAYON_STAT_DEPTH(d)        ((void)0)
+#define CRAYON_STATS_FLUSH()        ((void)0)
+
+#endif
+
+#endif // CRAYON_STATS_H
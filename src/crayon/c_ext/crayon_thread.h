@@ -0,0 +1,53 @@
+#ifndef CRAYON_THREAD_H
+#define CRAYON_THREAD_H
+
+/**
+ * @brief Minimal portable native threads (start, join, CPU count).
+ *
+ * Workers are declared with CRAYON_THREAD_FN(name) and end with
+ * return CRAYON_THREAD_RETURN; the signature differs between pthreads
+ * and the Win32 CRT.
+ */
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <process.h>
+    typedef HANDLE crayon_thread;
+    #define CRAYON_THREAD_FN(name) unsigned __stdcall name(void* arg)
+    #define CRAYON_THREAD_RETURN 0
+    typedef unsigned (__stdcall *crayon_thread_fn)(void*);
+
+    static inline int crayon_thread_start(crayon_thread* thread, crayon_thread_fn fn, void* arg) {
+        *thread = (HANDLE)_beginthreadex(NULL, 0, fn, arg, 0, NULL);
+        return *thread ? 0 : -1;
+    }
+    static inline void crayon_thread_join(crayon_thread thread) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    }
+    static inline int crayon_cpu_count(void) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+    }
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    typedef pthread_t crayon_thread;
+    #define CRAYON_THREAD_FN(name) void* name(void* arg)
+    #define CRAYON_THREAD_RETURN NULL
+    typedef void* (*crayon_thread_fn)(void*);
+
+    static inline int crayon_thread_start(crayon_thread* thread, crayon_thread_fn fn, void* arg) {
+        return pthread_create(thread, NULL, fn, arg) == 0 ? 0 : -1;
+    }
+    static inline void crayon_thread_join(crayon_thread thread) {
+        pthread_join(thread, NULL);
+    }
+    static inline int crayon_cpu_count(void) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (int)n : 1;
+    }
+#endif
+
+#endif // CRAYON_THREAD_H
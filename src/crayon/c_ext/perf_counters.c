@@ -0,0 +1,110 @@
+#if defined(__linux__)
+#define _GNU_SOURCE  // syscall() under -std=c99
+#endif
+
+#include "perf_counters.h"
+
+const char* const crayon_perf_event_names[CRAYON_PERF_EVENT_COUNT] = {
+    "cycles",
+    "instructions",
+    "l1d_misses",
+    "llc_misses",
+    "dtlb_misses",
+    "branch_misses",
+};
+
+#if defined(__linux__)
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define HW_CACHE_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} EVENT_SPECS[CRAYON_PERF_EVENT_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int crayon_perf_open(CrayonPerfCounters* counters) {
+    int opened = 0;
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENT_SPECS[i].type;
+        attr.config = EVENT_SPECS[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;    // Allowed at perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters->fds[i] >= 0) opened++;
+    }
+    return opened;
+}
+
+void crayon_perf_start(CrayonPerfCounters* counters) {
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+        if (counters->fds[i] < 0) continue;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void crayon_perf_stop(CrayonPerfCounters* counters, int64_t values[CRAYON_PERF_EVENT_COUNT]) {
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+        if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+        // { value, time_enabled, time_running }
+        uint64_t data[3];
+        values[i] = CRAYON_PERF_UNAVAILABLE;
+        if (counters->fds[i] < 0) continue;
+        if (read(counters->fds[i], data, sizeof(data)) != (ssize_t)sizeof(data)) continue;
+        if (data[2] == 0) continue;  // Never scheduled on the PMU
+        values[i] = (data[2] < data[1])
+            ? (int64_t)((double)data[0] * (double)data[1] / (double)data[2])
+            : (int64_t)data[0];
+    }
+}
+
+void crayon_perf_close(CrayonPerfCounters* counters) {
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) {
+        if (counters->fds[i] >= 0) close(counters->fds[i]);
+        counters->fds[i] = -1;
+    }
+}
+
+#else  // Not Linux: counters are never available
+
+int crayon_perf_open(CrayonPerfCounters* counters) {
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) counters->fds[i] = -1;
+    return 0;
+}
+
+void crayon_perf_start(CrayonPerfCounters* counters) {
+    (void)counters;
+}
+
+void crayon_perf_stop(CrayonPerfCounters* counters, int64_t values[CRAYON_PERF_EVENT_COUNT]) {
+    (void)counters;
+    for (int i = 0; i < CRAYON_PERF_EVENT_COUNT; i++) values[i] = CRAYON_PERF_UNAVAILABLE;
+}
+
+void crayon_perf_close(CrayonPerfCounters* counters) {
+    (void)counters;
+}
+
+#endif
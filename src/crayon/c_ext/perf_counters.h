@@ -0,0 +1,54 @@
+#ifndef CRAYON_PERF_COUNTERS_H
+#define CRAYON_PERF_COUNTERS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Hardware performance counters via Linux perf_event_open.
+ *
+ * Each event is opened as an independent counter (not a group) so a PMU
+ * with few general-purpose counters still reports everything it can; the
+ * kernel multiplexes and values are scaled by time_enabled / time_running.
+ * Events the host cannot count (containers, VMs, perf_event_paranoid,
+ * non-Linux builds) are reported as CRAYON_PERF_UNAVAILABLE.
+ *
+ * Counts are for the calling thread only (pid = 0, cpu = -1).
+ */
+
+enum {
+    CRAYON_PERF_CYCLES = 0,
+    CRAYON_PERF_INSTRUCTIONS,
+    CRAYON_PERF_L1D_MISSES,
+    CRAYON_PERF_LLC_MISSES,
+    CRAYON_PERF_DTLB_MISSES,
+    CRAYON_PERF_BRANCH_MISSES,
+    CRAYON_PERF_EVENT_COUNT
+};
+
+#define CRAYON_PERF_UNAVAILABLE (-1)
+
+typedef struct {
+    int fds[CRAYON_PERF_EVENT_COUNT];
+} CrayonPerfCounters;
+
+// Event names, indexed like the enum above ("cycles", "l1d_misses", ...)
+extern const char* const crayon_perf_event_names[CRAYON_PERF_EVENT_COUNT];
+
+/**
+ * @brief Open every supported event (disabled).
+ * @return Number of events opened; 0 means counters are unavailable.
+ */
+int crayon_perf_open(CrayonPerfCounters* counters);
+
+// Reset and enable all opened events
+void crayon_perf_start(CrayonPerfCounters* counters);
+
+/**
+ * @brief Disable all events and read their (multiplex-scaled) counts.
+ * @param values Receives one count per event, or CRAYON_PERF_UNAVAILABLE.
+ */
+void crayon_perf_stop(CrayonPerfCounters* counters, int64_t values[CRAYON_PERF_EVENT_COUNT]);
+
+void crayon_perf_close(CrayonPerfCounters* counters);
+
+#endif // CRAYON_PERF_COUNTERS_H
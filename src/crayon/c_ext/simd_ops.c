@@ -1,4 +1,6 @@
 #include "simd_ops.h"
+#include "byte_tables.h"
+#include "crayon_stats.h"
 #include <immintrin.h>
 #include <string.h>
 
@@ -36,6 +38,8 @@ int find_child_simd(const TrieNode* node, uint8_t target_char) {
     
     // [cite: 415] Use SIMD for small child sets (<= 16)
     if (node->child_count <= 16) {
+        CRAYON_STAT_ADD(simd_lookups, 1);
+
         // [cite: 418] Set target vector
         __m128i target_vec = _mm_set1_epi8((char)target_char);
         
@@ -59,6 +63,7 @@ int find_child_simd(const TrieNode* node, uint8_t target_char) {
         return CTZ((uint32_t)mask);
     } else {
         // [cite: 425] Fallback to binary search for large child sets
+        CRAYON_STAT_ADD(bsearch_lookups, 1);
         return binary_search_chars(node->child_chars, node->child_count, target_char);
     }
 }
@@ -99,55 +104,83 @@ int compare_strings_avx2(const char* str1, const char* str2, size_t length) {
 }
 
 // [cite: 525] Vectorized Character Classification
+// Two PSHUFB lookups (low and high nibble) from the generated byte tables
+// replace the per-class range compares; a class is hit when any of its
+// rectangle bits survives the AND.
 void classify_characters_avx2(const uint8_t* chars, uint8_t* classifications, size_t count) {
-    // [cite: 526-529] Pre-computed constants
-    const __m256i alpha_min = _mm256_set1_epi8('a');
-    const __m256i alpha_max = _mm256_set1_epi8('z');
-    const __m256i digit_min = _mm256_set1_epi8('0');
-    const __m256i digit_max = _mm256_set1_epi8('9');
-    const __m256i space_char = _mm256_set1_epi8(' ');
-    
+    const __m256i lo_lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)crayon_nibble_lo));
+    const __m256i hi_lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)crayon_nibble_hi));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+
     size_t i = 0;
     // [cite: 530] Loop 32 chars at a time
     for (; i + 32 <= count; i += 32) {
-        // [cite: 532] Load
         __m256i char_vec = _mm256_loadu_si256((const __m256i*)(chars + i));
-        
-        // [cite: 533-536] Is Alpha logic (simplified for AVX comparison quirks)
-        // Note: PCMPGT compares signed bytes. We assume ASCII range here.
-        __m256i is_alpha = _mm256_and_si256(
-            _mm256_cmpgt_epi8(char_vec, _mm256_sub_epi8(alpha_min, _mm256_set1_epi8(1))),
-            _mm256_cmpgt_epi8(_mm256_add_epi8(alpha_max, _mm256_set1_epi8(1)), char_vec)
-        );
+        __m256i lo = _mm256_and_si256(char_vec, nibble);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(char_vec, 4), nibble);
+        __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(lo_lut, lo),
+                                        _mm256_shuffle_epi8(hi_lut, hi));
 
-        // [cite: 537-539] Is Digit logic
-        __m256i is_digit = _mm256_and_si256(
-            _mm256_cmpgt_epi8(char_vec, _mm256_sub_epi8(digit_min, _mm256_set1_epi8(1))),
-            _mm256_cmpgt_epi8(_mm256_add_epi8(digit_max, _mm256_set1_epi8(1)), char_vec)
-        );
-        
-        // [cite: 540] Is Space
-        __m256i is_space = _mm256_cmpeq_epi8(char_vec, space_char);
-        
-        // [cite: 543-544] Combine results: Alpha=1, Digit=2, Space=4
+        // Per class: all-ones where no bit of the class is set, then ANDNOT
+        __m256i no_alpha = _mm256_cmpeq_epi8(_mm256_and_si256(bits, _mm256_set1_epi8(CRAYON_NIBBLE_ALPHA)), zero);
+        __m256i no_digit = _mm256_cmpeq_epi8(_mm256_and_si256(bits, _mm256_set1_epi8(CRAYON_NIBBLE_DIGIT)), zero);
+        __m256i no_space = _mm256_cmpeq_epi8(_mm256_and_si256(bits, _mm256_set1_epi8(CRAYON_NIBBLE_SPACE)), zero);
+
+        // [cite: 543-544] Combine results as CRAYON_BYTE_* bits
         __m256i result = _mm256_or_si256(
-            _mm256_and_si256(is_alpha, _mm256_set1_epi8(1)),
+            _mm256_andnot_si256(no_alpha, _mm256_set1_epi8(CRAYON_BYTE_ALPHA)),
             _mm256_or_si256(
-                _mm256_and_si256(is_digit, _mm256_set1_epi8(2)),
-                _mm256_and_si256(is_space, _mm256_set1_epi8(4))
+                _mm256_andnot_si256(no_digit, _mm256_set1_epi8(CRAYON_BYTE_DIGIT)),
+                _mm256_andnot_si256(no_space, _mm256_set1_epi8(CRAYON_BYTE_SPACE))
             )
         );
-        
+
         // [cite: 546] Store
         _mm256_storeu_si256((__m256i*)(classifications + i), result);
     }
-    
-    // Fallback for remaining
+
+    // Scalar tail reads the same generated table
     for (; i < count; i++) {
-        uint8_t c = chars[i];
-        classifications[i] = 0;
-        if (c >= 'a' && c <= 'z') classifications[i] |= 1;
-        if (c >= '0' && c <= '9') classifications[i] |= 2;
-        if (c == ' ') classifications[i] |= 4;
+        classifications[i] = crayon_byte_class[chars[i]] &
+                             (CRAYON_BYTE_ALPHA | CRAYON_BYTE_DIGIT | CRAYON_BYTE_SPACE);
+    }
+}
+// Structural character scan for the corpus readers
+size_t find_any2_avx2(const uint8_t* data, size_t length, uint8_t a, uint8_t b) {
+    const __m256i vec_a = _mm256_set1_epi8((char)a);
+    const __m256i vec_b = _mm256_set1_epi8((char)b);
+    
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i hits = _mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, vec_a),
+            _mm256_cmpeq_epi8(chunk, vec_b)
+        );
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hits);
+        if (mask != 0) return i + CTZ(mask);
+    }
+    
+    // Scalar tail
+    for (; i < length; i++) {
+        if (data[i] == a || data[i] == b) return i;
+    }
+    return length;
+}
+
+size_t find_byte_avx2(const uint8_t* data, size_t length, uint8_t a) {
+    const __m256i vec_a = _mm256_set1_epi8((char)a);
+    
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vec_a));
+        if (mask != 0) return i + CTZ(mask);
     }
-}
\ No newline at end of file
+    
+    for (; i < length; i++) {
+        if (data[i] == a) return i;
+    }
+    return length;
+}
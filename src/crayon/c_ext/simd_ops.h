@@ -36,9 +36,37 @@ int compare_strings_avx2(const char* str1, const char* str2, size_t length);
  * Used for high-speed Unicode category detection.
  * 
  * @param chars Input character buffer.
- * @param classifications Output classification mask buffer.
+ * @param classifications Output masks: crayon_byte_class[c] restricted to
+ *        CRAYON_BYTE_ALPHA | CRAYON_BYTE_DIGIT | CRAYON_BYTE_SPACE
+ *        (byte_tables.h).
  * @param count Number of characters to process.
  */
 void classify_characters_avx2(const uint8_t* chars, uint8_t* classifications, size_t count);
 
+/**
+ * @brief Find the first occurrence of either of two bytes using AVX2.
+ * 
+ * Used by the corpus readers to jump between structural characters
+ * (quotes, escapes, delimiters) 32 bytes at a time.
+ * 
+ * @param data Input buffer.
+ * @param length Number of bytes to scan.
+ * @param a First byte to search for.
+ * @param b Second byte to search for.
+ * @return Offset of the first match, or length if neither byte occurs.
+ */
+size_t find_any2_avx2(const uint8_t* data, size_t length, uint8_t a, uint8_t b);
+
+/**
+ * @brief Find the first occurrence of one byte using AVX2.
+ * 
+ * Single-delimiter form of find_any2_avx2 (line ends, CSV quotes).
+ * 
+ * @param data Input buffer.
+ * @param length Number of bytes to scan.
+ * @param a Byte to search for.
+ * @return Offset of the first match, or length if the byte does not occur.
+ */
+size_t find_byte_avx2(const uint8_t* data, size_t length, uint8_t a);
+
 #endif // CRAYON_SIMD_OPS_H
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "trie_builder.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ----------------------------------------------------------------------------
+// Builder Structures (Intermediate, non-aligned for construction)
+// ----------------------------------------------------------------------------
+
+typedef struct BuilderNode {
+    int32_t token_id;
+    uint8_t key;
+    struct BuilderNode* first_child;
+    struct BuilderNode* next_sibling;
+} BuilderNode;
+
+static BuilderNode* create_builder_node(uint8_t key) {
+    BuilderNode* node = (BuilderNode*)malloc(sizeof(BuilderNode));
+    if (node) {
+        node->token_id = -1;
+        node->key = key;
+        node->first_child = NULL;
+        node->next_sibling = NULL;
+    }
+    return node;
+}
+
+static void free_builder_node(BuilderNode* node) {
+    if (!node) return;
+    free_builder_node(node->first_child);
+    free_builder_node(node->next_sibling);
+    free(node);
+}
+
+// ----------------------------------------------------------------------------
+// Trie Memory Management
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Recursively frees the TrieNode structure contents.
+ */
+static void free_trie_node_contents(TrieNode* node) {
+    if (!node) return;
+
+    if (node->child_count > 0 && node->children) {
+        for (uint16_t i = 0; i < node->child_count; i++) {
+            // Recurse to free grandchildren arrays
+            free_trie_node_contents(&node->children[i]);
+        }
+        // Free aligned arrays - use our aligned free
+        free_trie_node_array(node->children);
+        free(node->child_chars);
+        node->children = NULL;
+        node->child_chars = NULL;
+    }
+}
+
+void crayon_trie_decref(CrayonTrie* trie) {
+    if (!trie) return;
+    if (crayon_atomic_dec(&trie->refcount) != 0) return;
+
+    if (trie->node_arena) {
+        aligned_free_64(trie->node_arena);
+        free(trie->char_arena);
+    } else {
+        free_trie_node_contents(trie->root);
+        // Free the root itself (allocated with aligned_alloc_64)
+        aligned_free_64(trie->root);
+    }
+    free(trie);
+}
+
+// ----------------------------------------------------------------------------
+// Builder Logic - Populate TrieNode from BuilderNode with ALIGNED allocation
+// ----------------------------------------------------------------------------
+
+static int populate_trie_node(TrieNode* t_node, BuilderNode* b_node) {
+    // Clear to zeros
+    memset(t_node, 0, sizeof(TrieNode));
+    t_node->token_id = b_node->token_id;
+    t_node->child_bitmap = 0;
+    
+    // Count children
+    int count = 0;
+    BuilderNode* curr = b_node->first_child;
+    while (curr) { count++; curr = curr->next_sibling; }
+    t_node->child_count = (uint16_t)count;
+
+    if (count > 0) {
+        // Allocate ALIGNED Children Array (CRITICAL for cache line optimization)
+        t_node->children = alloc_trie_node_array(count);
+        if (!t_node->children) return -1;
+        
+        // Allocate Char Array (Padding for SIMD over-read safety - round up to 32)
+        int char_pad = (count + 31) & ~31;
+        t_node->child_chars = (uint8_t*)calloc(char_pad, sizeof(uint8_t));
+        if (!t_node->child_chars) {
+            free_trie_node_array(t_node->children);
+            t_node->children = NULL;
+            return -1;
+        }
+
+        // Sort children by key for binary search (required for SIMD masking)
+        // First collect into arrays
+        BuilderNode** child_ptrs = (BuilderNode**)malloc(count * sizeof(BuilderNode*));
+        if (!child_ptrs) {
+            free_trie_node_array(t_node->children);
+            free(t_node->child_chars);
+            return -1;
+        }
+        
+        curr = b_node->first_child;
+        for (int i = 0; i < count; i++) {
+            child_ptrs[i] = curr;
+            curr = curr->next_sibling;
+        }
+        
+        // Sort by key (simple insertion sort for small arrays)
+        for (int i = 1; i < count; i++) {
+            BuilderNode* key_node = child_ptrs[i];
+            int j = i - 1;
+            while (j >= 0 && child_ptrs[j]->key > key_node->key) {
+                child_ptrs[j + 1] = child_ptrs[j];
+                j--;
+            }
+            child_ptrs[j + 1] = key_node;
+        }
+
+        // Populate in sorted order
+        for (int i = 0; i < count; i++) {
+            BuilderNode* child_b = child_ptrs[i];
+            t_node->child_chars[i] = child_b->key;
+            
+            // Set bitmap bit for O(1) existence check (ASCII only)
+            if (child_b->key < 64) {
+                t_node->child_bitmap |= (1ULL << child_b->key);
+            }
+            
+            // Recurse to populate child (in aligned array)
+            if (populate_trie_node(&t_node->children[i], child_b) != 0) {
+                free(child_ptrs);
+                return -1;
+            }
+        }
+        
+        free(child_ptrs);
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Public Builder API
+// ----------------------------------------------------------------------------
+
+struct CrayonTrieBuilder {
+    BuilderNode* root;
+};
+
+CrayonTrieBuilder* crayon_builder_new(void) {
+    CrayonTrieBuilder* builder = (CrayonTrieBuilder*)malloc(sizeof(CrayonTrieBuilder));
+    if (!builder) return NULL;
+    builder->root = create_builder_node(0);
+    if (!builder->root) {
+        free(builder);
+        return NULL;
+    }
+    return builder;
+}
+
+int crayon_builder_insert(CrayonTrieBuilder* builder, const uint8_t* token,
+                          size_t length, int32_t token_id) {
+    // Skip empty tokens
+    if (length == 0) return 0;
+
+    BuilderNode* curr = builder->root;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t key = token[i];
+
+        // Find existing child
+        BuilderNode* child = curr->first_child;
+        BuilderNode* prev = NULL;
+        while (child && child->key != key) {
+            prev = child;
+            child = child->next_sibling;
+        }
+
+        if (!child) {
+            // Create new child
+            child = create_builder_node(key);
+            if (!child) return -1;
+            if (prev) prev->next_sibling = child;
+            else curr->first_child = child;
+        }
+        curr = child;
+    }
+    // Mark end of token
+    curr->token_id = token_id;
+    return 0;
+}
+
+void crayon_builder_free(CrayonTrieBuilder* builder) {
+    if (!builder) return;
+    free_builder_node(builder->root);
+    free(builder);
+}
+
+CrayonTrie* crayon_builder_finish(CrayonTrieBuilder* builder) {
+    CrayonTrie* trie = (CrayonTrie*)malloc(sizeof(CrayonTrie));
+    // Allocate the Root (64-byte aligned)
+    TrieNode* root = alloc_trie_node();
+    if (!trie || !root) {
+        free(trie);
+        if (root) aligned_free_64(root);
+        crayon_builder_free(builder);
+        return NULL;
+    }
+
+    // Populate the optimized trie from builder
+    if (populate_trie_node(root, builder->root) != 0) {
+        free_trie_node_contents(root);
+        aligned_free_64(root);
+        free(trie);
+        crayon_builder_free(builder);
+        return NULL;
+    }
+
+    // Cleanup Builder Tree
+    crayon_builder_free(builder);
+
+    trie->refcount = 1;
+    trie->root = root;
+    trie->node_arena = NULL;
+    trie->char_arena = NULL;
+    trie->scored = 0;
+    crayon_trie_scan_inner_bytes(trie);
+    return trie;
+}
+
+static void mark_inner_bytes(const TrieNode* node, uint8_t* inner) {
+    for (uint16_t i = 0; i < node->child_count; i++) {
+        uint8_t key = node->child_chars[i];
+        inner[key >> 3] |= (uint8_t)(1u << (key & 7));
+        mark_inner_bytes(&node->children[i], inner);
+    }
+}
+
+void crayon_trie_scan_inner_bytes(CrayonTrie* trie) {
+    // Edges out of the root are first bytes; every deeper edge is inner
+    memset(trie->inner_bytes, 0, sizeof(trie->inner_bytes));
+    for (uint16_t i = 0; i < trie->root->child_count; i++) {
+        mark_inner_bytes(&trie->root->children[i], trie->inner_bytes);
+    }
+}
+
+static void set_node_scores(TrieNode* node, const float* scores, size_t count) {
+    if (node->token_id >= 0 && (size_t)node->token_id < count) {
+        node->log_prob = scores[node->token_id];
+    }
+    for (uint16_t i = 0; i < node->child_count; i++) {
+        set_node_scores(&node->children[i], scores, count);
+    }
+}
+
+void crayon_trie_set_scores(CrayonTrie* trie, const float* scores, size_t count) {
+    set_node_scores(trie->root, scores, count);
+    trie->scored = 1;
+}
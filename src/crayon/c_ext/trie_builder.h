@@ -0,0 +1,78 @@
+#ifndef CRAYON_TRIE_BUILDER_H
+#define CRAYON_TRIE_BUILDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trie_node.h"
+#include "crayon_atomic.h"
+
+/**
+ * @brief Reference-counted, immutable compiled trie.
+ *
+ * Once built, the node arrays are never written again, so one CrayonTrie can
+ * be read concurrently by any number of threads and sub-interpreters. Each
+ * owner (capsule, shared-handle lease) holds one reference; the nodes are
+ * freed when the last reference is dropped.
+ */
+typedef struct CrayonTrie {
+    crayon_atomic_long refcount;
+    TrieNode* root;             // 64-byte aligned root node
+    // Tries loaded from an image live in two flat arenas (root = arena[0]);
+    // builder tries own one allocation per child array and leave these NULL
+    TrieNode* node_arena;
+    uint8_t* char_arena;
+    int scored;                 // Terminal nodes carry log_prob (unigram LM)
+    // Bit b set when byte b occurs past the first byte of some token; a
+    // byte that never does cannot be inside a match that started earlier
+    uint8_t inner_bytes[32];
+} CrayonTrie;
+
+typedef struct CrayonTrieBuilder CrayonTrieBuilder;
+
+/**
+ * @brief Create an empty builder (linked-list intermediate tree).
+ * @return Builder, or NULL on allocation failure.
+ */
+CrayonTrieBuilder* crayon_builder_new(void);
+
+/**
+ * @brief Insert one token. Empty tokens are ignored.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int crayon_builder_insert(CrayonTrieBuilder* builder, const uint8_t* token,
+                          size_t length, int32_t token_id);
+
+/**
+ * @brief Compile the builder into an aligned trie and free the builder.
+ * @return Trie with refcount 1, or NULL on allocation failure.
+ */
+CrayonTrie* crayon_builder_finish(CrayonTrieBuilder* builder);
+
+/**
+ * @brief Store per-token log-probabilities in the terminal nodes.
+ *
+ * Must run before the trie is shared (it is immutable afterwards). IDs at
+ * or beyond count keep 0.0. Marks the trie scored.
+ */
+void crayon_trie_set_scores(CrayonTrie* trie, const float* scores, size_t count);
+
+/**
+ * @brief Fill trie->inner_bytes (done by the builder and the image loader).
+ */
+void crayon_trie_scan_inner_bytes(CrayonTrie* trie);
+
+/**
+ * @brief Free a builder without compiling it.
+ */
+void crayon_builder_free(CrayonTrieBuilder* builder);
+
+static inline void crayon_trie_incref(CrayonTrie* trie) {
+    crayon_atomic_inc(&trie->refcount);
+}
+
+/**
+ * @brief Drop one reference; frees the trie when it was the last one.
+ */
+void crayon_trie_decref(CrayonTrie* trie);
+
+#endif // CRAYON_TRIE_BUILDER_H
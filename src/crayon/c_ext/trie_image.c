@@ -0,0 +1,148 @@
+#include "trie_image.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+    static_assert(sizeof(CrayonImageNode) == 12, "CrayonImageNode must be 12 bytes");
+#else
+    _Static_assert(sizeof(CrayonImageNode) == 12, "CrayonImageNode must be 12 bytes");
+#endif
+
+static size_t count_nodes(const TrieNode* node) {
+    size_t count = 1;
+    for (uint16_t i = 0; i < node->child_count; i++) {
+        count += count_nodes(&node->children[i]);
+    }
+    return count;
+}
+
+int crayon_trie_serialize(const CrayonTrie* trie, uint8_t** out, size_t* out_length) {
+    size_t node_count = count_nodes(trie->root);
+    size_t node_bytes = node_count * sizeof(CrayonImageNode);
+    size_t length = CRAYON_TRIE_IMAGE_HEADER + node_bytes +
+                    (trie->scored ? node_count * sizeof(float) : 0);
+
+    uint8_t* buf = (uint8_t*)malloc(length);
+    // BFS queue of in-memory nodes, parallel to the image node table
+    const TrieNode** queue = (const TrieNode**)malloc(node_count * sizeof(TrieNode*));
+    if (!buf || !queue) {
+        free(buf);
+        free(queue);
+        return -1;
+    }
+
+    memcpy(buf, CRAYON_TRIE_IMAGE_MAGIC, 8);
+    uint32_t header[2] = {(uint32_t)node_count, trie->scored ? CRAYON_TRIE_IMAGE_SCORED : 0};
+    memcpy(buf + 8, header, sizeof(header));
+    CrayonImageNode* nodes = (CrayonImageNode*)(buf + CRAYON_TRIE_IMAGE_HEADER);
+
+    queue[0] = trie->root;
+    memset(&nodes[0], 0, sizeof(CrayonImageNode));
+    size_t tail = 1;
+    for (size_t head = 0; head < node_count; head++) {
+        const TrieNode* node = queue[head];
+        nodes[head].token_id = node->token_id;
+        nodes[head].child_count = node->child_count;
+        nodes[head].first_child = node->child_count ? (uint32_t)tail : 0;
+        if (trie->scored) {
+            memcpy(buf + CRAYON_TRIE_IMAGE_HEADER + node_bytes + head * sizeof(float),
+                   &node->log_prob, sizeof(float));
+        }
+        for (uint16_t i = 0; i < node->child_count; i++) {
+            memset(&nodes[tail], 0, sizeof(CrayonImageNode));
+            nodes[tail].key = node->child_chars[i];
+            queue[tail++] = &node->children[i];
+        }
+    }
+
+    free(queue);
+    *out = buf;
+    *out_length = length;
+    return 0;
+}
+
+CrayonTrie* crayon_trie_load(const uint8_t* image, size_t length, int* malformed) {
+    *malformed = 1;
+    if (length < CRAYON_TRIE_IMAGE_HEADER || memcmp(image, CRAYON_TRIE_IMAGE_MAGIC, 8) != 0) {
+        return NULL;
+    }
+    uint32_t node_count, flags;
+    memcpy(&node_count, image + 8, sizeof(node_count));
+    memcpy(&flags, image + 12, sizeof(flags));
+    size_t record = sizeof(CrayonImageNode) + ((flags & CRAYON_TRIE_IMAGE_SCORED) ? sizeof(float) : 0);
+    if (node_count == 0 || (flags & ~CRAYON_TRIE_IMAGE_SCORED) ||
+        (length - CRAYON_TRIE_IMAGE_HEADER) / record != node_count) {
+        return NULL;
+    }
+    // Unaligned reads: the image may sit at any offset inside a file or mmap
+    const uint8_t* table = image + CRAYON_TRIE_IMAGE_HEADER;
+    const uint8_t* log_probs = (flags & CRAYON_TRIE_IMAGE_SCORED)
+        ? table + (size_t)node_count * sizeof(CrayonImageNode) : NULL;
+
+    // 1. Validate the BFS shape and size the key arena
+    size_t char_bytes = 0;
+    uint32_t expected_child = 1;
+    for (uint32_t i = 0; i < node_count; i++) {
+        CrayonImageNode n;
+        memcpy(&n, table + (size_t)i * sizeof(n), sizeof(n));
+        if (n.child_count == 0) continue;
+        if (n.child_count > 256 || n.first_child != expected_child ||
+            (uint64_t)n.first_child + n.child_count > node_count) {
+            return NULL;
+        }
+        // Keys strictly increasing: required by binary search, rules out duplicates
+        uint8_t prev_key = 0;
+        for (uint32_t c = 0; c < n.child_count; c++) {
+            CrayonImageNode child;
+            memcpy(&child, table + (size_t)(n.first_child + c) * sizeof(child), sizeof(child));
+            if (c > 0 && child.key <= prev_key) return NULL;
+            prev_key = child.key;
+        }
+        expected_child += n.child_count;
+        // Padding for SIMD over-read safety, as in the builder
+        char_bytes += ((size_t)n.child_count + 31) & ~(size_t)31;
+    }
+    if (expected_child != node_count) return NULL;
+    *malformed = 0;
+
+    // 2. One arena for every node, one for every key array
+    CrayonTrie* trie = (CrayonTrie*)malloc(sizeof(CrayonTrie));
+    TrieNode* arena = (TrieNode*)aligned_alloc_64((size_t)node_count * sizeof(TrieNode));
+    uint8_t* chars = (uint8_t*)calloc(char_bytes ? char_bytes : 1, 1);
+    if (!trie || !arena || !chars) {
+        free(trie);
+        if (arena) aligned_free_64(arena);
+        free(chars);
+        return NULL;
+    }
+
+    // 3. Relocate: indices become pointers into the arenas
+    uint8_t* char_cursor = chars;
+    for (uint32_t i = 0; i < node_count; i++) {
+        CrayonImageNode n;
+        memcpy(&n, table + (size_t)i * sizeof(n), sizeof(n));
+        TrieNode* node = &arena[i];
+        memset(node, 0, sizeof(TrieNode));
+        node->token_id = n.token_id;
+        node->child_count = n.child_count;
+        if (log_probs) memcpy(&node->log_prob, log_probs + (size_t)i * sizeof(float), sizeof(float));
+        if (n.child_count == 0) continue;
+
+        node->children = &arena[n.first_child];
+        node->child_chars = char_cursor;
+        for (uint32_t c = 0; c < n.child_count; c++) {
+            uint8_t key = table[(size_t)(n.first_child + c) * sizeof(n) + offsetof(CrayonImageNode, key)];
+            char_cursor[c] = key;
+            if (key < 64) node->child_bitmap |= (1ULL << key);
+        }
+        char_cursor += ((size_t)n.child_count + 31) & ~(size_t)31;
+    }
+
+    trie->refcount = 1;
+    trie->root = &arena[0];
+    trie->node_arena = arena;
+    trie->char_arena = chars;
+    trie->scored = log_probs != NULL;
+    crayon_trie_scan_inner_bytes(trie);
+    return trie;
+}
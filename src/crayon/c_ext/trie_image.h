@@ -0,0 +1,50 @@
+#ifndef CRAYON_TRIE_IMAGE_H
+#define CRAYON_TRIE_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trie_builder.h"
+
+/**
+ * @brief Position-independent serialized trie ("CRYTRIE1").
+ *
+ * Layout (little-endian):
+ *   char     magic[8]      "CRYTRIE1"
+ *   uint32_t node_count
+ *   uint32_t flags         CRAYON_TRIE_IMAGE_SCORED or 0
+ *   CrayonImageNode nodes[node_count]   breadth-first, root first
+ *   float    log_prob[node_count]       only when CRAYON_TRIE_IMAGE_SCORED
+ *
+ * Breadth-first order makes every node's children a contiguous run that
+ * starts right after the previous node's children, so loading is a single
+ * linear pass into one 64-byte aligned arena: no per-token insertion, no
+ * sorting, one allocation for all nodes and one for all child keys.
+ */
+
+#define CRAYON_TRIE_IMAGE_MAGIC "CRYTRIE1"
+#define CRAYON_TRIE_IMAGE_HEADER 16
+#define CRAYON_TRIE_IMAGE_SCORED 1u
+
+typedef struct {
+    int32_t token_id;           // -1 for non-terminal nodes
+    uint16_t child_count;
+    uint8_t key;                // Byte on the edge from the parent
+    uint8_t reserved;
+    uint32_t first_child;       // Index of the first child (0 if none)
+} CrayonImageNode;
+
+/**
+ * @brief Serialize a compiled trie.
+ * @param out Receives a malloc'd buffer owned by the caller.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int crayon_trie_serialize(const CrayonTrie* trie, uint8_t** out, size_t* out_length);
+
+/**
+ * @brief Rebuild a trie from an image (validated; safe on untrusted input).
+ * @return Trie with refcount 1, or NULL if the image is malformed or
+ *         allocation fails (*malformed tells which).
+ */
+CrayonTrie* crayon_trie_load(const uint8_t* image, size_t length, int* malformed);
+
+#endif // CRAYON_TRIE_IMAGE_H
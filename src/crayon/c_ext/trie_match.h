@@ -0,0 +1,272 @@
+#ifndef CRAYON_TRIE_MATCH_H
+#define CRAYON_TRIE_MATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trie_node.h"
+#include "simd_ops.h"
+#include "crayon_stats.h"
+#include "crayon_hash_match.h"
+
+/**
+ * @brief Greedy longest-match from the start of a byte buffer.
+ *
+ * Walks the trie until the first missing child and remembers the deepest
+ * terminal node seen on the way [cite: 193-196].
+ *
+ * @param root Root of the compiled trie.
+ * @param text Input bytes (no terminator required).
+ * @param limit Number of bytes available at text.
+ * @param token_id Receives the matched token ID (untouched on no match).
+ * @param walked Receives the depth reached (bytes examined before the walk
+ *        stopped), which is at least the match length.
+ * @return Length of the longest match in bytes, or 0 if no token matches.
+ */
+static inline size_t crayon_longest_match_walk(const TrieNode* root, const uint8_t* text,
+                                               size_t limit, int32_t* token_id,
+                                               size_t* walked) {
+    const TrieNode* curr = root;
+    size_t match_length = 0;
+    size_t i = 0;
+
+    for (; i < limit; i++) {
+        // SIMD Child Lookup [cite: 414]
+        int idx = find_child_simd(curr, text[i]);
+        if (idx == -1) break;
+
+        curr = &curr->children[idx];
+
+        // Track longest match
+        if (curr->token_id != -1) {
+            *token_id = curr->token_id;
+            match_length = i + 1;
+        }
+    }
+
+    // i = depth reached; one extra lookup unless the input ran out
+    CRAYON_STAT_ADD(steps, i < limit ? i + 1 : i);
+    CRAYON_STAT_ADD(wasted_bytes, i - match_length);
+    CRAYON_STAT_DEPTH(i);
+    *walked = i;
+    return match_length;
+}
+
+// Same walk when the depth is not needed (the store folds away when inlined)
+static inline size_t crayon_longest_match(const TrieNode* root, const uint8_t* text,
+                                          size_t limit, int32_t* token_id) {
+    size_t walked;
+    return crayon_longest_match_walk(root, text, limit, token_id, &walked);
+}
+
+// ----------------------------------------------------------------------------
+// Specialized kernels: one match loop, instantiated per View x Sink
+// ----------------------------------------------------------------------------
+//
+// A View is a trie layout: a root type crayon_view_<V>_t and a
+// crayon_view_<V>_match() with the crayon_longest_match_walk contract. A
+// Sink is an output type: crayon_sink_<S>_full() and crayon_sink_<S>_emit()
+// over the fields of CrayonSink it uses. CRAYON_DEFINE_KERNEL(V, S) pastes
+// them into crayon_kernel_<V>_<S>; everything is static inline, so each
+// instance compiles to its own loop with the policy calls folded in and the
+// unused bookkeeping (walk depth, offsets, capacity checks) gone.
+//
+// Adding a layout or output type is one view or sink definition plus one
+// line in CRAYON_FOR_EACH_VIEW / CRAYON_FOR_EACH_SINK: the kind enums, the
+// instances and the dispatch table in crayon_kernels.c all come from
+// those lists.
+
+/**
+ * @brief Output state shared by every sink; each sink reads only its fields.
+ */
+typedef struct CrayonSink {
+    void* ids;                  // int32_t* or uint16_t*, per sink
+    size_t* offsets;            // offsets: byte offset of each token
+    size_t capacity;            // slots in ids (and offsets)
+    size_t count;               // tokens emitted
+    size_t lookahead;           // lookahead: bytes walked over all tokens
+    int truncated;              // u16: an ID did not fit in 16 bits
+} CrayonSink;
+
+// View "node": the 64-byte TrieNode tree (builder and loaded images alike)
+typedef TrieNode crayon_view_node_t;
+#define crayon_view_node_match crayon_longest_match_walk
+
+// View "hash": hashed prefix tables for tokens of <= 16 bytes
+typedef CrayonHashMatcher crayon_view_hash_t;
+#define crayon_view_hash_match crayon_hash_longest_match
+
+// Sink "i32": int32 IDs, bounded by capacity
+static inline int crayon_sink_i32_full(const CrayonSink* sink) {
+    return sink->count >= sink->capacity;
+}
+static inline void crayon_sink_i32_emit(CrayonSink* sink, int32_t token_id,
+                                        size_t position, size_t walked) {
+    (void)position; (void)walked;
+    ((int32_t*)sink->ids)[sink->count++] = token_id;
+}
+
+// Sink "u16": uint16 IDs (numpy uint16, .u16 files); flags IDs above 0xFFFF
+#define crayon_sink_u16_full crayon_sink_i32_full
+static inline void crayon_sink_u16_emit(CrayonSink* sink, int32_t token_id,
+                                        size_t position, size_t walked) {
+    (void)position; (void)walked;
+    sink->truncated |= (uint32_t)token_id > 0xFFFF;
+    ((uint16_t*)sink->ids)[sink->count++] = (uint16_t)token_id;
+}
+
+// Sink "count": no output buffer at all, never full
+static inline int crayon_sink_count_full(const CrayonSink* sink) {
+    (void)sink;
+    return 0;
+}
+static inline void crayon_sink_count_emit(CrayonSink* sink, int32_t token_id,
+                                          size_t position, size_t walked) {
+    (void)token_id; (void)position; (void)walked;
+    sink->count++;
+}
+
+// Sink "offsets": int32 IDs plus the byte offset where each token starts
+#define crayon_sink_offsets_full crayon_sink_i32_full
+static inline void crayon_sink_offsets_emit(CrayonSink* sink, int32_t token_id,
+                                            size_t position, size_t walked) {
+    (void)walked;
+    ((int32_t*)sink->ids)[sink->count] = token_id;
+    sink->offsets[sink->count++] = position;
+}
+
+// Sink "lookahead": int32 IDs plus the total walk depth (sampling profiler)
+#define crayon_sink_lookahead_full crayon_sink_i32_full
+static inline void crayon_sink_lookahead_emit(CrayonSink* sink, int32_t token_id,
+                                              size_t position, size_t walked) {
+    (void)position;
+    ((int32_t*)sink->ids)[sink->count++] = token_id;
+    sink->lookahead += walked;
+}
+
+/**
+ * @brief Kernel signature shared by every instance (and the dispatch table).
+ *
+ * Tokenizes until the input ends or the sink is full, appending to sink.
+ * Touches no Python objects and is safe to call with the GIL released.
+ *
+ * @return Input bytes covered (< length means the sink filled up).
+ */
+typedef size_t (*CrayonKernel)(const void* root, const uint8_t* text, size_t length,
+                               int32_t unk_token_id, CrayonSink* sink);
+
+#define CRAYON_DEFINE_KERNEL(VIEW, SINK)                                                  \
+static inline size_t crayon_kernel_##VIEW##_##SINK(const void* root, const uint8_t* text, \
+                                                   size_t length, int32_t unk_token_id,   \
+                                                   CrayonSink* sink) {                    \
+    const crayon_view_##VIEW##_t* trie = (const crayon_view_##VIEW##_t*)root;             \
+    size_t position = 0;                                                                  \
+    size_t emitted = 0;                                                                   \
+    while (position < length && !crayon_sink_##SINK##_full(sink)) {                       \
+        int32_t token_id = unk_token_id;                                                  \
+        size_t walked;                                                                    \
+        size_t match_length = crayon_view_##VIEW##_match(trie, text + position,           \
+                                                         length - position, &token_id,    \
+                                                         &walked);                        \
+        crayon_sink_##SINK##_emit(sink, token_id, position, walked);                      \
+        emitted++;                                                                        \
+        /* Unknown byte - emit UNK and advance by one */                                  \
+        position += match_length > 0 ? match_length : 1;                                  \
+        CRAYON_STAT_ADD(unk_tokens, match_length == 0);                                   \
+    }                                                                                     \
+    CRAYON_STAT_ADD(tokens, emitted);                                                     \
+    CRAYON_STAT_ADD(calls, 1);                                                            \
+    (void)emitted;                                                                        \
+    return position;                                                                      \
+}
+
+// X-macro lists: X(view, sink, SINK_ENUM_SUFFIX) and X(view, VIEW_ENUM_SUFFIX)
+#define CRAYON_FOR_EACH_SINK(X, VIEW) \
+    X(VIEW, i32, I32)                 \
+    X(VIEW, u16, U16)                 \
+    X(VIEW, count, COUNT)             \
+    X(VIEW, offsets, OFFSETS)         \
+    X(VIEW, lookahead, LOOKAHEAD)
+
+#define CRAYON_FOR_EACH_VIEW(X) \
+    X(node, NODE)               \
+    X(hash, HASH)
+
+// Enums and instances are generated from the lists above
+#define CRAYON_VIEW_ENUM(VIEW, KIND) CRAYON_VIEW_##KIND,
+#define CRAYON_SINK_ENUM(VIEW, SINK, KIND) CRAYON_SINK_##KIND,
+
+typedef enum {
+    CRAYON_FOR_EACH_VIEW(CRAYON_VIEW_ENUM)
+    CRAYON_VIEW_KINDS
+} CrayonViewKind;
+
+typedef enum {
+    CRAYON_FOR_EACH_SINK(CRAYON_SINK_ENUM, _)
+    CRAYON_SINK_KINDS
+} CrayonSinkKind;
+
+#undef CRAYON_VIEW_ENUM
+#undef CRAYON_SINK_ENUM
+
+#define CRAYON_INSTANTIATE(VIEW, SINK, KIND) CRAYON_DEFINE_KERNEL(VIEW, SINK)
+#define CRAYON_INSTANTIATE_VIEW(VIEW, KIND) CRAYON_FOR_EACH_SINK(CRAYON_INSTANTIATE, VIEW)
+CRAYON_FOR_EACH_VIEW(CRAYON_INSTANTIATE_VIEW)
+#undef CRAYON_INSTANTIATE_VIEW
+#undef CRAYON_INSTANTIATE
+
+/**
+ * @brief Every instance, by layout and output type (crayon_kernels.c).
+ *
+ * For callers that pick the output type at run time (buffer item size,
+ * CLI format); fixed call sites use the inline instance directly.
+ */
+extern const CrayonKernel crayon_kernels[CRAYON_VIEW_KINDS][CRAYON_SINK_KINDS];
+
+// ----------------------------------------------------------------------------
+// Named entry points over the node view
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Tokenize into an output array of limited capacity.
+ *
+ * Stops when capacity IDs have been written. *consumed receives the number
+ * of input bytes covered, so consumed < length means out was too small.
+ *
+ * @return Number of token IDs written to out.
+ */
+static inline size_t crayon_tokenize_bounded(const TrieNode* root, const uint8_t* text,
+                                             size_t length, int32_t unk_token_id,
+                                             int32_t* out, size_t capacity,
+                                             size_t* consumed) {
+    CrayonSink sink = {out, NULL, capacity, 0, 0, 0};
+    *consumed = crayon_kernel_node_i32(root, text, length, unk_token_id, &sink);
+    return sink.count;
+}
+
+/**
+ * @brief Tokenize a byte buffer into a caller-provided ID array.
+ *
+ * Every emitted token consumes at least one byte, so an output array of
+ * `length` entries is always large enough. Touches no Python objects and
+ * is safe to call with the GIL released.
+ *
+ * @return Number of token IDs written to out.
+ */
+static inline size_t crayon_tokenize_into(const TrieNode* root, const uint8_t* text,
+                                          size_t length, int32_t unk_token_id,
+                                          int32_t* out) {
+    size_t consumed;
+    return crayon_tokenize_bounded(root, text, length, unk_token_id, out, length, &consumed);
+}
+
+/**
+ * @brief Count tokens without storing them (no output buffer at all).
+ */
+static inline size_t crayon_count_tokens(const TrieNode* root, const uint8_t* text,
+                                         size_t length) {
+    CrayonSink sink = {NULL, NULL, 0, 0, 0, 0};
+    crayon_kernel_node_count(root, text, length, -1, &sink);
+    return sink.count;
+}
+
+#endif // CRAYON_TRIE_MATCH_H
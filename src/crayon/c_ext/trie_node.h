@@ -43,7 +43,8 @@ struct TrieNode;
  * - child_bitmap (8 bytes): Fast ASCII child existence check
  * - children (8 bytes): Pointer to aligned array of child TrieNodes
  * - child_chars (8 bytes): Pointer to array of keys (SIMD target)
- * - padding (32 bytes): Force 64-byte total
+ * - log_prob (4 bytes): Unigram log-probability of token_id (0 if unscored)
+ * - padding (28 bytes): Force 64-byte total
  */
 typedef struct ALIGN_64 TrieNode {
     int32_t token_id;           // 4 bytes [cite: 403]
@@ -54,8 +55,10 @@ typedef struct ALIGN_64 TrieNode {
     struct TrieNode* children;  // 8 bytes [cite: 410] Pointer to aligned children array
     uint8_t* child_chars;       // 8 bytes [cite: 411] Characters for SIMD lookup
 
-    // Padding: 4 + 2 + 2 + 8 + 8 + 8 = 32 bytes used. 32 bytes padding needed.
-    uint8_t padding[32];
+    float log_prob;             // 4 bytes - Read by the scored/sampled segmenters
+
+    // Padding: 4 + 2 + 2 + 8 + 8 + 8 + 4 = 36 bytes used. 28 bytes padding needed.
+    uint8_t padding[28];
     
 } TrieNode;
 
@@ -2,7 +2,7 @@ import time
 import threading
 import queue
 from collections import deque
-from typing import Any, List, Tuple, Optional
+from typing import Any, Dict, List, Tuple, Optional
 from ..core.vocabulary import CrayonVocab
 from ..unicode.normalizer import unicode_normalize_nfc_optimized
 
@@ -38,7 +38,9 @@ class PipelineTokenizer:
         ]
         
         # Performance monitoring [cite: 745]
+        # Recent samples per stage, plus lifetime totals for stage_summary()
         self.stage_timings: List[deque] = [deque(maxlen=1000) for _ in range(3)]
+        self.stage_totals: List[List[float]] = [[0, 0.0] for _ in range(3)]
         self.running = False
 
     def start_pipeline(self) -> None:
@@ -56,6 +58,34 @@ class PipelineTokenizer:
         except queue.Full:
             pass
 
+    STAGE_NAMES = ("normalize", "tokenize", "format")
+
+    def _record_stage(self, stage: int, elapsed: float) -> None:
+        # Each stage runs on a single thread, so its totals have one writer
+        self.stage_timings[stage].append(elapsed)
+        totals = self.stage_totals[stage]
+        totals[0] += 1
+        totals[1] += elapsed
+
+    def stage_summary(self) -> Dict[str, Dict[str, float]]:
+        """
+        Per-stage timing summary in seconds.
+
+        count and sum cover the pipeline's lifetime; p50/p99 are over the
+        most recent samples (up to 1000 per stage).
+        """
+        summary = {}
+        for name, samples, (count, total) in zip(self.STAGE_NAMES, self.stage_timings,
+                                                 self.stage_totals):
+            recent = sorted(samples)
+            summary[name] = {
+                "count": count,
+                "sum": total,
+                "p50": recent[len(recent) // 2] if recent else 0.0,
+                "p99": recent[min(len(recent) - 1, int(len(recent) * 0.99))] if recent else 0.0,
+            }
+        return summary
+
     def _normalize_stage(self) -> None:
         """Stage 1: Input preprocessing and Unicode normalization[cite: 752]."""
         while self.running:
@@ -69,7 +99,7 @@ class PipelineTokenizer:
                 # Normalize Unicode (CPU intensive)
                 normalized_text = unicode_normalize_nfc_optimized(text)
                 
-                self.stage_timings[0].append(time.perf_counter() - start_time)
+                self._record_stage(0, time.perf_counter() - start_time)
                 self.normalized_queue.put((text_id, normalized_text))
                 self.input_queue.task_done()
                 
@@ -92,7 +122,7 @@ class PipelineTokenizer:
                 # In production, this calls the C-extension via the vocab object
                 tokens = self.vocab.tokenize(normalized_text)
                 
-                self.stage_timings[1].append(time.perf_counter() - start_time)
+                self._record_stage(1, time.perf_counter() - start_time)
                 self.tokenized_queue.put((text_id, tokens))
                 self.normalized_queue.task_done()
                 
@@ -118,7 +148,7 @@ class PipelineTokenizer:
                     "length": len(tokens)
                 }
                 
-                self.stage_timings[2].append(time.perf_counter() - start_time)
+                self._record_stage(2, time.perf_counter() - start_time)
                 # Put result in output queue for external consumers
                 self.output_queue.put(formatted_result)
                 self.tokenized_queue.task_done()
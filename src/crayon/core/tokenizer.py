@@ -1,4 +1,9 @@
-from typing import List
+import heapq
+import math
+import random
+import threading
+from array import array
+from typing import Iterator, List, Optional, Sequence
 from .vocabulary import CrayonVocab
 
 # Try importing C-extension
@@ -18,8 +23,8 @@ def crayon_tokenize(text: str, vocab: CrayonVocab) -> List[int]:
     Automatically uses C-Extension with SIMD acceleration if available [cite: 358-375].
     """
     # 1. Fast Path: Use C-Extension if available and trie is built
-    if _C_EXT_AVAILABLE and vocab._c_ext_available and vocab._c_trie is not None:
-        return _core.crayon_tokenize_fast(text, vocab._c_trie, vocab.unk_token_id)
+    if _C_EXT_AVAILABLE and vocab._c_ext_available and vocab._c_tokenizer is not None:
+        return vocab._c_tokenizer.tokenize(text)
 
     # 2. Slow Path: Pure Python Implementation (Fallback)
     # Optimized using local variables for loop speed
@@ -44,4 +49,246 @@ def crayon_tokenize(text: str, vocab: CrayonVocab) -> List[int]:
             tokens_append(unk_id)
             position += 1
             
-    return tokens
\ No newline at end of file
+    return tokens
+
+
+def crayon_tokenize_optimal(text: str, vocab: CrayonVocab,
+                            scores: Optional[Sequence[float]] = None,
+                            unk_score: float = -100.0) -> List[int]:
+    """
+    Fewest-token segmentation (or, with per-token scores, the one with the
+    highest total score) by dynamic programming over the match lattice.
+
+    Backward pass: cost[i] is the best cost of text[i:], found by walking
+    the trie from i over every token that starts there. Ties go to the
+    longer token, matching Tokenizer.tokenize_optimal in the C extension.
+    Without scores the vocabulary's own (CrayonVocab(scores=...)) are used
+    when it has them.
+    """
+    if _C_EXT_AVAILABLE and vocab._c_ext_available and vocab._c_tokenizer is not None:
+        # scores=None: the trie's own scores, if it was built with any
+        if scores is not None and not isinstance(scores, array):
+            scores = array("f", scores)
+        return vocab._c_tokenizer.tokenize_optimal(text, scores, unk_score)
+
+    # Pure Python fallback over the character trie
+    if scores is None:
+        scores = vocab.scores
+    n = len(text)
+    root = vocab._root
+    unk_id = vocab.unk_token_id
+    unk_cost = -unk_score if scores is not None else 1.0
+    cost = [0.0] * (n + 1)
+    step = [1] * n
+    ids = [unk_id] * n
+    for i in range(n - 1, -1, -1):
+        best = None
+        node = root
+        for j in range(i, n):
+            node = node['children'].get(text[j])
+            if node is None:
+                break
+            tid = node['token_id']
+            if tid == -1:
+                continue
+            if scores is None:
+                edge = 1.0
+            else:
+                edge = -scores[tid] if tid < len(scores) else unk_cost
+            total = edge + cost[j + 1]
+            if best is None or total <= best:
+                best, step[i], ids[i] = total, j + 1 - i, tid
+        cost[i] = best if best is not None else unk_cost + cost[i + 1]
+
+    tokens: List[int] = []
+    i = 0
+    while i < n:
+        tokens.append(ids[i])
+        i += step[i]
+    return tokens
+
+
+# Fallback sampler RNG, one per thread like the native one
+_sampler = threading.local()
+
+
+def _thread_rng() -> random.Random:
+    rng = getattr(_sampler, "rng", None)
+    if rng is None:
+        rng = _sampler.rng = random.Random()
+    return rng
+
+
+def seed_sampling(seed: int) -> None:
+    """
+    Seed the calling thread's sampler (native and fallback), so the
+    segmentations it draws with crayon_tokenize_sampled are reproducible.
+    Other threads keep their own state.
+    """
+    if _C_EXT_AVAILABLE:
+        _core.seed_sampling(seed)
+    _thread_rng().seed(seed)
+
+
+def crayon_tokenize_sampled(text: str, vocab: CrayonVocab, alpha: float = 1.0,
+                            unk_score: float = -100.0,
+                            seed: Optional[int] = None) -> List[int]:
+    """
+    One segmentation sampled from the unigram LM distribution of the
+    vocabulary's scores, p(segmentation) ~ exp(alpha * sum(scores)), for
+    subword regularization.
+
+    Backward filtering: beta[i] is the log of the total weight of every
+    segmentation of text[i:]. Forward sampling then draws each token among
+    those starting at the current position with probability
+    exp(alpha * score + beta[end] - beta[i]). With seed the draw uses a
+    fresh RNG; otherwise the calling thread's (see seed_sampling).
+    """
+    if _C_EXT_AVAILABLE and vocab._c_ext_available and vocab._c_tokenizer is not None:
+        return vocab._c_tokenizer.sample(text, alpha, unk_score, seed)
+
+    # Pure Python fallback over the character trie
+    rng = random.Random(seed) if seed is not None else _thread_rng()
+    scores = vocab.scores
+    n = len(text)
+    root = vocab._root
+    unk_id = vocab.unk_token_id
+
+    def edges(i):
+        node = root
+        for j in range(i, n):
+            node = node['children'].get(text[j])
+            if node is None:
+                return
+            tid = node['token_id']
+            if tid != -1:
+                score = scores[tid] if scores is not None and tid < len(scores) else 0.0
+                yield tid, j + 1, alpha * score
+
+    beta = [0.0] * (n + 1)
+    for i in range(n - 1, -1, -1):
+        weights = [w + beta[end] for _, end, w in edges(i)]
+        if weights:
+            top = max(weights)
+            beta[i] = top + math.log(sum(math.exp(w - top) for w in weights))
+        else:
+            beta[i] = alpha * unk_score + beta[i + 1]
+
+    tokens: List[int] = []
+    i = 0
+    while i < n:
+        target = rng.random()
+        cumulative = 0.0
+        pick, step = unk_id, 1
+        for tid, end, w in edges(i):
+            pick, step = tid, end - i
+            cumulative += math.exp(w + beta[end] - beta[i])
+            if cumulative > target:
+                break
+        tokens.append(pick)
+        i += step
+    return tokens
+
+
+_SPACE = frozenset(" \t\n\v\f\r")
+
+
+def _char_group(ch: str) -> int:
+    # Same groups as the native pre-tokenizer: non-ASCII counts as letters
+    if ch >= "\x80" or ch.isalpha():
+        return 0
+    if "0" <= ch <= "9":
+        return 1
+    if ch in _SPACE:
+        return 2
+    return 3
+
+
+def pretokenize(text: str) -> Iterator[str]:
+    """
+    Split text into BPE words: runs of letters, digits, whitespace or other
+    characters. A single space before a non-space run joins it (" world"),
+    so a whitespace run leaves its last space to the word after it.
+    Mirrors crayon_pretokenize_next in the C extension.
+    """
+    n = len(text)
+    start = 0
+    while start < n:
+        i = start
+        if text[i] == " " and i + 1 < n and _char_group(text[i + 1]) != 2:
+            i += 1
+        group = _char_group(text[i])
+        end = i + 1
+        while end < n and _char_group(text[end]) == group:
+            end += 1
+        if group == 2 and end < n and end - i > 1 and text[end - 1] == " ":
+            end -= 1
+        yield text[start:end]
+        start = end
+
+
+def _bpe_word(word: str, vocab: CrayonVocab) -> List[int]:
+    """Merge one word lowest rank first; heap of (rank, position) pairs."""
+    merges = vocab._bpe_ranks
+    ids = [vocab.token_to_id.get(ch, -1) for ch in word]
+    nxt = list(range(1, len(ids))) + [-1]
+    prev = list(range(-1, len(ids) - 1))
+    alive = [True] * len(ids)
+
+    heap = []
+
+    def push(pos: int) -> None:
+        right = nxt[pos]
+        if right >= 0:
+            merge = merges.get((ids[pos], ids[right]))
+            if merge is not None:
+                heapq.heappush(heap, (merge[0], pos, ids[pos], ids[right]))
+
+    for pos in range(len(ids) - 1):
+        push(pos)
+    while heap:
+        _, pos, left, right = heapq.heappop(heap)
+        if not alive[pos] or ids[pos] != left or nxt[pos] < 0 or ids[nxt[pos]] != right:
+            continue
+        gone = nxt[pos]
+        ids[pos] = merges[(left, right)][1]
+        alive[gone] = False
+        nxt[pos] = nxt[gone]
+        if nxt[gone] >= 0:
+            prev[nxt[gone]] = pos
+        if prev[pos] >= 0:
+            push(prev[pos])
+        push(pos)
+
+    unk = vocab.unk_token_id
+    out = []
+    pos = 0
+    while pos >= 0:
+        out.append(ids[pos] if ids[pos] >= 0 else unk)
+        pos = nxt[pos]
+    return out
+
+
+def crayon_tokenize_bpe(text: str, vocab: CrayonVocab) -> List[int]:
+    """
+    BPE-merge encoding with the vocabulary's ranked merges (see
+    CrayonVocab.load_merges): pre-tokenized words start as one symbol per
+    character and merge lowest rank first. Words are cached, natively in
+    the Tokenizer and here in a per-vocabulary dict.
+    """
+    if vocab._bpe_ranks is None:
+        raise ValueError("vocabulary has no merges; call load_merges() first")
+    tokenizer = vocab._bpe_tokenizer
+    if _C_EXT_AVAILABLE and vocab._c_ext_available and tokenizer is not None:
+        return tokenizer.tokenize_bpe(text)
+
+    cache = vocab._bpe_cache
+    tokens: List[int] = []
+    for word in pretokenize(text):
+        ids = cache.get(word)
+        if ids is None:
+            ids = _bpe_word(word, vocab)
+            if len(cache) < 65536:
+                cache[word] = ids
+        tokens.extend(ids)
+    return tokens
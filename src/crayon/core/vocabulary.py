@@ -12,8 +12,16 @@ Features:
 - Batteries-included default vocabulary builder
 """
 
-from typing import List, Dict, Tuple, Optional, Any, Iterator
+from typing import List, Dict, Tuple, Optional, Any, Iterator, Sequence
 import sys
+import struct
+from array import array
+
+# Binary vocabulary image: header | unk token | token offsets | token text | trie
+_IMAGE_MAGIC = b"CRYNVOC1"
+_IMAGE_VERSION = 1
+# magic, version, unk token bytes, unk ID, token count, text bytes, trie bytes
+_IMAGE_HEADER = struct.Struct("<8sIIqQQQ")
 
 
 class CrayonVocab:
@@ -28,7 +36,8 @@ class CrayonVocab:
     - C-Extension: SIMD-accelerated trie for production throughput
     """
 
-    def __init__(self, tokens: List[str], unk_token: str = "<UNK>"):
+    def __init__(self, tokens: List[str], unk_token: str = "<UNK>",
+                 scores: Optional[Sequence[float]] = None):
         """
         Initialize vocabulary from pre-computed token list.
         
@@ -39,23 +48,39 @@ class CrayonVocab:
         Args:
             tokens: List of token strings (order determines IDs)
             unk_token: Unknown token representation
+            scores: Optional unigram log-probability per token, stored in
+                the compiled trie for tokenize_optimal / tokenize_sampled
         """
-        self.size = len(tokens)
-        self.unk_token = unk_token
-        
         # 1. Standard Python mappings (for fallback/decoding)
-        self.token_to_id: Dict[str, int] = {t: i for i, t in enumerate(tokens)}
-        self.id_to_token: Dict[int, str] = {i: t for i, t in enumerate(tokens)}
-        self.unk_token_id = self.token_to_id.get(unk_token, 0)
-        
-        # 2. Build Python Trie (Fallback)
-        self._root: Dict[str, Any] = {'children': {}, 'token_id': -1}
-        self._build_python_trie(tokens)
+        self._init_tables(tokens, unk_token)
+        if scores is not None:
+            if len(scores) != len(tokens):
+                raise ValueError("scores must have one entry per token")
+            self.scores = array('f', scores)
         
-        # 3. Build C-Extension Trie (Production Path)
+        # 2. Build C-Extension Trie (Production Path)
         self._c_trie: Optional[Any] = None
+        self._c_tokenizer: Optional[Any] = None
         self._c_ext_available = False
         self._build_c_trie(tokens)
+        
+        # 3. Build Python Trie (Fallback) - deferred to first use when the
+        # C path serves tokenize(), since only the fallback walks it
+        if not self._c_ext_available:
+            self._build_python_trie(tokens)
+
+    def _init_tables(self, tokens: List[str], unk_token: str) -> None:
+        """ID mappings shared by every constructor."""
+        self.size = len(tokens)
+        self.unk_token = unk_token
+        self.token_to_id: Dict[str, int] = {t: i for i, t in enumerate(tokens)}
+        self.id_to_token: Dict[int, str] = {i: t for i, t in enumerate(tokens)}
+        self.unk_token_id = self.token_to_id.get(unk_token, 0)
+        self.scores: Optional[array] = None
+        self._fingerprint: Optional[int] = None
+        self._bpe_ranks: Optional[Dict[Tuple[int, int], Tuple[int, int]]] = None
+        self._bpe_tokenizer: Optional[Any] = None
+        self._bpe_cache: Dict[str, List[int]] = {}
 
     @classmethod
     def from_corpus(
@@ -202,6 +227,89 @@ class CrayonVocab:
         
         return cls(tokens, unk_token=unk_token)
 
+    @classmethod
+    def from_image(cls, image_path: str) -> "CrayonVocab":
+        """
+        Load a binary vocabulary image written by save(path, format="image").
+        
+        The image carries the compiled trie, so loading skips JSON parsing,
+        trie insertion and child sorting: the trie is relocated into one
+        aligned arena in a single pass.
+        
+        Args:
+            image_path: Path to the image file
+            
+        Returns:
+            CrayonVocab instance
+        """
+        with open(image_path, 'rb') as f:
+            data = f.read()
+        return cls._from_image_buffer(memoryview(data))
+
+    @classmethod
+    def from_shared_memory(cls, name: str) -> "CrayonVocab":
+        """
+        Load a vocabulary image published with to_shared_memory().
+        
+        Worker processes attach by name instead of reading and parsing
+        files, so startup does no disk I/O regardless of page-cache state.
+        
+        Args:
+            name: Shared memory segment name
+            
+        Returns:
+            CrayonVocab instance
+        """
+        import os
+        from multiprocessing import shared_memory
+        try:
+            shm = shared_memory.SharedMemory(name=name, track=False)
+        except TypeError:
+            # Python < 3.13 registers every attached POSIX segment with the
+            # resource tracker, which unlinks it when this process exits
+            shm = shared_memory.SharedMemory(name=name)
+            if os.name == 'posix':
+                from multiprocessing import resource_tracker
+                resource_tracker.unregister('/' + shm.name, 'shared_memory')
+        try:
+            return cls._from_image_buffer(shm.buf)
+        finally:
+            shm.close()
+
+    @classmethod
+    def _from_image_buffer(cls, buf: memoryview) -> "CrayonVocab":
+        magic, version, unk_len, _, count, text_len, trie_len = _IMAGE_HEADER.unpack_from(buf, 0)
+        if magic != _IMAGE_MAGIC or version != _IMAGE_VERSION:
+            raise ValueError("Not a Crayon vocabulary image")
+
+        pos = _IMAGE_HEADER.size
+        unk_token = bytes(buf[pos:pos + unk_len]).decode('utf-8')
+        pos += unk_len
+        offsets = array('I')
+        offsets.frombytes(buf[pos:pos + 4 * (count + 1)])
+        pos += 4 * (count + 1)
+        text = bytes(buf[pos:pos + text_len]).decode('utf-8')
+        pos += text_len
+        tokens = [text[offsets[i]:offsets[i + 1]] for i in range(count)]
+
+        try:
+            from ..c_ext import _core
+        except ImportError:
+            _core = None
+        if _core is None or trie_len == 0:
+            return cls(tokens, unk_token=unk_token)
+
+        pos = (pos + 7) & ~7
+        with buf[pos:pos + trie_len] as trie_image:
+            trie = _core.load_trie(trie_image)
+        vocab = cls.__new__(cls)
+        vocab._init_tables(tokens, unk_token)
+        scores = _core.trie_scores(trie, count)
+        if scores is not None:
+            vocab.scores = array('f', scores)
+        vocab._attach_c_trie(trie)
+        return vocab
+
     @classmethod
     def _stabilize_and_create(
         cls, 
@@ -232,13 +340,23 @@ class CrayonVocab:
 
     def _build_python_trie(self, tokens: List[str]) -> None:
         """Constructs pure Python trie structure for fallback."""
+        root: Dict[str, Any] = {'children': {}, 'token_id': -1}
         for i, token in enumerate(tokens):
-            node = self._root
+            node = root
             for char in token:
                 if char not in node['children']:
                     node['children'][char] = {'children': {}, 'token_id': -1}
                 node = node['children'][char]
             node['token_id'] = i
+        # Published only when complete: concurrent readers never see a partial trie
+        self.__dict__['_py_root'] = root
+
+    @property
+    def _root(self) -> Dict[str, Any]:
+        """Python fallback trie, built on first use."""
+        if '_py_root' not in self.__dict__:
+            self._build_python_trie([self.id_to_token[i] for i in range(self.size)])
+        return self.__dict__['_py_root']
 
     def _build_c_trie(self, tokens: List[str]) -> None:
         """
@@ -249,8 +367,7 @@ class CrayonVocab:
         try:
             from ..c_ext import _core
             # Call the C build_trie function
-            self._c_trie = _core.build_trie(tokens)
-            self._c_ext_available = True
+            self._attach_c_trie(_core.build_trie(tokens, self.scores))
         except ImportError:
             # C extension not compiled
             self._c_ext_available = False
@@ -262,12 +379,60 @@ class CrayonVocab:
             )
             self._c_ext_available = False
 
+    def _attach_c_trie(self, trie: Any) -> None:
+        """Binds a compiled trie capsule and its native tokenizer."""
+        from ..c_ext import _core
+        self._c_trie = trie
+        # Native tokenizer owning the trie and UNK ID
+        self._c_tokenizer = _core.Tokenizer(trie, self.unk_token_id)
+        self._c_ext_available = True
+
+    @property
+    def _c_ext_available(self) -> bool:
+        """Whether tokenize() is served by the C extension."""
+        return self.__dict__.get('_c_ext_enabled', False)
+
+    @_c_ext_available.setter
+    def _c_ext_available(self, enabled: bool) -> None:
+        self.__dict__['_c_ext_enabled'] = enabled
+        # Bind tokenize straight to the native method so a call is a single
+        # C method call; disabling restores the Python dispatch below.
+        tokenizer = self.__dict__.get('_c_tokenizer')
+        if enabled and tokenizer is not None:
+            self.__dict__['tokenize'] = tokenizer.tokenize
+        else:
+            self.__dict__.pop('tokenize', None)
+
+    def share_trie(self) -> int:
+        """
+        Lease the compiled C trie to another (sub-)interpreter.
+        
+        The trie is immutable and reference counted natively, so every
+        interpreter can tokenize with it on its own GIL without rebuilding
+        or copying the vocabulary. Each handle must be claimed exactly once
+        (or dropped with _core.release_trie):
+        
+            >>> handle = vocab.share_trie()
+            >>> # inside the other interpreter:
+            >>> tok = _core.Tokenizer(_core.attach_trie(handle), unk_token_id)
+            >>> tok.tokenize("hello")
+        
+        Returns:
+            Integer handle accepted by _core.attach_trie()
+        """
+        if not self._c_ext_available or self._c_trie is None:
+            raise RuntimeError("C extension not available; no native trie to share")
+        from ..c_ext import _core
+        return _core.share_trie(self._c_trie)
+
     def tokenize(self, text: str) -> List[int]:
         """
         Tokenize text to token IDs.
         
         Uses C-extension with SIMD acceleration if available,
         otherwise falls back to pure Python implementation.
+        When the extension is active this method is shadowed per instance
+        by the native Tokenizer.tokenize (see _c_ext_available).
         
         Args:
             text: Input text to tokenize
@@ -278,6 +443,72 @@ class CrayonVocab:
         from .tokenizer import crayon_tokenize
         return crayon_tokenize(text, self)
     
+    def tokenize_optimal(self, text: str, scores: Optional[Sequence[float]] = None,
+                         unk_score: float = -100.0) -> List[int]:
+        """
+        Tokenize with the fewest tokens instead of greedy longest-match
+        (or, when the vocabulary has scores, the most probable one).
+
+        Dynamic programming over every token match in the text (linear in
+        the text; roughly a few times the cost of greedy tokenize()). Every
+        extra token costs model compute, and greedy can commit to a long
+        token that forces short ones after it.
+
+        Args:
+            text: Input text to tokenize
+            scores: Optional per-token log-probabilities indexed by ID
+                (array('f') is passed to the C extension without copying);
+                the highest-scoring segmentation is returned instead
+            unk_score: Score of each UNK (C: byte, fallback: character)
+
+        Returns:
+            List of token IDs
+        """
+        from .tokenizer import crayon_tokenize_optimal
+        return crayon_tokenize_optimal(text, self, scores, unk_score)
+
+    def tokenize_sampled(self, text: str, alpha: float = 1.0,
+                         seed: Optional[int] = None) -> List[int]:
+        """
+        Tokenize with a segmentation sampled from the unigram LM given by
+        this vocabulary's scores (subword regularization for training).
+
+        alpha sharpens the distribution: 0 is uniform over segmentations,
+        large values approach tokenize_optimal(). Runs natively with the
+        GIL released; draws come from a per-thread RNG (see
+        crayon.core.tokenizer.seed_sampling) or, with seed, a fresh one.
+
+        Args:
+            text: Input text to tokenize
+            alpha: Inverse temperature applied to the scores
+            seed: Optional seed for this call only
+
+        Returns:
+            List of token IDs
+        """
+        from .tokenizer import crayon_tokenize_sampled
+        return crayon_tokenize_sampled(text, self, alpha, seed=seed)
+
+    def tokenize_parallel(self, text: str, threads: Optional[int] = None) -> List[int]:
+        """
+        Tokenize one large document on several native threads.
+
+        The text is cut only before whitespace bytes that no token contains
+        past its first byte, so the result is identical to tokenize().
+        Worth it for documents of several megabytes; smaller inputs and
+        vocabularies without such a byte run sequentially.
+
+        Args:
+            text: Input text to tokenize
+            threads: Worker count (default: every online CPU)
+
+        Returns:
+            List of token IDs
+        """
+        if self._c_tokenizer is None:
+            return self.tokenize(text)
+        return self._c_tokenizer.tokenize_parallel(text, threads or 0)
+
     def longest_match(
         self, 
         text: str, 
@@ -342,15 +573,77 @@ class CrayonVocab:
         """
         return self.tokenize(text)
     
+    def set_merges(self, merges: Sequence[Tuple[str, str]]) -> None:
+        """
+        Enable tokenize_bpe() with a ranked merge list, best merge first.
+
+        Both sides of every merge and their concatenation must be tokens
+        of this vocabulary. A repeated pair keeps its first rank.
+
+        Args:
+            merges: (left, right) token pairs in rank order
+        """
+        triples = array('i')
+        ranks: Dict[Tuple[int, int], Tuple[int, int]] = {}
+        for rank, (left, right) in enumerate(merges):
+            ids = (self.token_to_id.get(left), self.token_to_id.get(right),
+                   self.token_to_id.get(left + right))
+            if None in ids:
+                raise ValueError(f"merge {left!r} {right!r} (rank {rank}) is not in the vocabulary")
+            triples.extend(ids)
+            ranks.setdefault((ids[0], ids[1]), (rank, ids[2]))
+
+        self._bpe_ranks = ranks
+        self._bpe_cache = {}
+        self._bpe_tokenizer = None
+        if self._c_trie is not None:
+            from ..c_ext import _core
+            self._bpe_tokenizer = _core.Tokenizer(self._c_trie, self.unk_token_id, merges=triples)
+
+    def load_merges(self, path: str) -> None:
+        """
+        Load a merges.txt next to the vocabulary: one "left right" pair per
+        line, best first; a leading "#version" line and blank lines are
+        skipped.
+        """
+        merges = []
+        with open(path, encoding='utf-8') as f:
+            for line in f:
+                line = line.rstrip('\r\n')
+                if not line or line.startswith('#version'):
+                    continue
+                left, sep, right = line.partition(' ')
+                if not sep:
+                    raise ValueError(f"malformed merge line: {line!r}")
+                merges.append((left, right))
+        self.set_merges(merges)
+
+    def tokenize_bpe(self, text: str) -> List[int]:
+        """
+        Tokenize with BPE merges instead of greedy longest-match, for
+        models trained on merge-based segmentation (see load_merges).
+
+        Args:
+            text: Input text to tokenize
+
+        Returns:
+            List of token IDs
+        """
+        from .tokenizer import crayon_tokenize_bpe
+        return crayon_tokenize_bpe(text, self)
+
     def save(self, path: str, format: str = "txt") -> None:
         """
         Save vocabulary to file.
         
         Args:
             path: Output file path
-            format: Output format ("txt" or "json")
+            format: Output format ("txt", "json" or "image")
         """
-        if format == "txt":
+        if format == "image":
+            with open(path, 'wb') as f:
+                f.write(self.to_image())
+        elif format == "txt":
             with open(path, 'w', encoding='utf-8') as f:
                 for i in range(self.size):
                     f.write(self.id_to_token[i] + '\n')
@@ -361,6 +654,65 @@ class CrayonVocab:
         else:
             raise ValueError(f"Unsupported format: {format}")
     
+    def to_image(self) -> bytes:
+        """
+        Serialize tokens and the compiled trie into a binary image.
+        
+        Load with from_image() / from_shared_memory(). Images written
+        without the C extension carry no trie and are rebuilt on load.
+        """
+        tokens = [self.id_to_token[i] for i in range(self.size)]
+        offsets = array('I', [0])
+        total = 0
+        for token in tokens:
+            total += len(token)
+            offsets.append(total)
+        text = "".join(tokens).encode('utf-8')
+        unk = self.unk_token.encode('utf-8')
+
+        trie = b""
+        if self._c_trie is not None:
+            from ..c_ext import _core
+            trie = _core.serialize_trie(self._c_trie)
+
+        parts = [
+            _IMAGE_HEADER.pack(_IMAGE_MAGIC, _IMAGE_VERSION, len(unk), self.unk_token_id,
+                               self.size, len(text), len(trie)),
+            unk, offsets.tobytes(), text,
+        ]
+        head = sum(len(p) for p in parts)
+        parts.append(b"\x00" * (((head + 7) & ~7) - head))  # 8-byte align the trie
+        parts.append(trie)
+        return b"".join(parts)
+
+    def to_shared_memory(self, name: Optional[str] = None):
+        """
+        Publish this vocabulary's image in a named shared memory segment.
+        
+        Other processes load it with CrayonVocab.from_shared_memory(shm.name).
+        The caller owns the returned SharedMemory: keep it open while
+        workers attach, then close() and unlink() it.
+        """
+        from multiprocessing import shared_memory
+        image = self.to_image()
+        shm = shared_memory.SharedMemory(name=name, create=True, size=len(image))
+        shm.buf[:len(image)] = image
+        return shm
+
+    @property
+    def fingerprint(self) -> int:
+        """
+        64-bit identity of this vocabulary (token order + UNK ID).
+        
+        Keys persistent artifacts such as the on-disk tokenization cache,
+        so results are never reused across different vocabularies.
+        """
+        if self._fingerprint is None:
+            from ..memory.disk_cache import content_hash
+            blob = "\x00".join(self.id_to_token[i] for i in range(self.size))
+            self._fingerprint = content_hash(blob, self.unk_token_id)
+        return self._fingerprint
+
     def get_vocab(self) -> Dict[str, int]:
         """Return the token to ID mapping."""
         return self.token_to_id.copy()
@@ -5,10 +5,12 @@ Implements Zero-Copy and Pooling strategies defined in Section 7.3:
 1. ZeroCopyTokenizer (Memory mapped file processing)
 2. MemoryPool (Buffer recycling)
 3. LockFreeCache (Thread-safe lookup)
+4. PersistentTokenCache (Content-addressed on-disk tokenization cache)
 """
 
 from .pool import MemoryPool
 from .zerocopy import ZeroCopyTokenizer
 from .cache import LockFreeVocabCache
+from .disk_cache import PersistentTokenCache
 
-__all__ = ["MemoryPool", "ZeroCopyTokenizer", "LockFreeVocabCache"]
\ No newline at end of file
+__all__ = ["MemoryPool", "ZeroCopyTokenizer", "LockFreeVocabCache", "PersistentTokenCache"]
\ No newline at end of file
@@ -0,0 +1,298 @@
+import os
+import mmap
+import struct
+import hashlib
+import threading
+from array import array
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Iterator, Optional, Union
+
+try:
+    from ..c_ext import _core
+    _XXH64 = _core.xxh64
+except (ImportError, AttributeError):
+    _XXH64 = None
+
+try:
+    import fcntl
+except ImportError:  # Windows: single-process use only
+    fcntl = None
+
+Document = Union[str, bytes, bytearray, memoryview]
+
+# Segment layout: [header][slot table][append-only token data]
+_MAGIC = b"CRYNTOK1"
+_HEADER = struct.Struct("<8sQQQQ")      # magic, slot_count, data_capacity, write_offset, entries
+_HEADER_SIZE = 64
+_SLOT = struct.Struct("<QQQII")         # key, check, data offset, token count, document length
+_SLOT_SIZE = _SLOT.size                 # 32 bytes
+_CHECK_SALT = 0x9E3779B97F4A7C15
+_MAX_LOAD = 0.7
+
+
+def content_hash(data: Document, seed: int = 0) -> int:
+    """
+    64-bit content hash used for cache keys and vocabulary fingerprints.
+
+    XXH64 from the C extension (str is hashed via its cached UTF-8 buffer,
+    no copy); falls back to keyed BLAKE2b when the extension is missing.
+    """
+    if _XXH64 is not None:
+        return _XXH64(data, seed)
+    if isinstance(data, str):
+        data = data.encode("utf-8")
+    digest = hashlib.blake2b(data, digest_size=8, key=seed.to_bytes(8, "little"))
+    return int.from_bytes(digest.digest(), "little")
+
+
+class _Segment:
+    """One generation: a fixed-size mmapped file with its own hash index."""
+
+    def __init__(self, path: Path, slot_count: int, data_capacity: int):
+        self.path = path
+        if not path.exists():
+            with open(path, "wb") as f:
+                # Sparse file: pages are only materialized as data is appended
+                f.truncate(_HEADER_SIZE + slot_count * _SLOT_SIZE + data_capacity)
+                f.write(_HEADER.pack(_MAGIC, slot_count, data_capacity, 0, 0))
+
+        with open(path, "r+b") as f:
+            self.mm = mmap.mmap(f.fileno(), 0)
+        magic, self.slot_count, self.data_capacity, _, _ = _HEADER.unpack_from(self.mm, 0)
+        if magic != _MAGIC:
+            raise ValueError(f"Not a Crayon token cache segment: {path}")
+        self.mask = self.slot_count - 1
+        self.data_start = _HEADER_SIZE + self.slot_count * _SLOT_SIZE
+        self.view = memoryview(self.mm)
+
+    @property
+    def write_offset(self) -> int:
+        return _HEADER.unpack_from(self.mm, 0)[3]
+
+    @property
+    def entries(self) -> int:
+        return _HEADER.unpack_from(self.mm, 0)[4]
+
+    def lookup(self, key: int, check: int, doc_length: int) -> Optional[memoryview]:
+        """Linear probing; returns a zero-copy int32 view on hit."""
+        idx = key & self.mask
+        for _ in range(self.slot_count):
+            s_key, s_check, offset, count, s_len = _SLOT.unpack_from(
+                self.mm, _HEADER_SIZE + idx * _SLOT_SIZE
+            )
+            if s_key == 0:
+                return None
+            if s_key == key and s_check == check and s_len == doc_length:
+                start = self.data_start + offset
+                return self.view[start:start + count * 4].cast("i")
+            idx = (idx + 1) & self.mask
+        return None
+
+    def has_room(self, nbytes: int) -> bool:
+        return (self.write_offset + nbytes <= self.data_capacity and
+                self.entries + 1 <= self.slot_count * _MAX_LOAD)
+
+    def append(self, key: int, check: int, doc_length: int, payload: bytes) -> memoryview:
+        """Appends token bytes, then publishes the slot (key written last)."""
+        _, _, _, offset, entries = _HEADER.unpack_from(self.mm, 0)
+        start = self.data_start + offset
+        self.mm[start:start + len(payload)] = payload
+
+        idx = key & self.mask
+        while _SLOT.unpack_from(self.mm, _HEADER_SIZE + idx * _SLOT_SIZE)[0] != 0:
+            idx = (idx + 1) & self.mask
+        slot_pos = _HEADER_SIZE + idx * _SLOT_SIZE
+        struct.pack_into("<QQII", self.mm, slot_pos + 8, check, offset, len(payload) // 4, doc_length)
+        struct.pack_into("<Q", self.mm, slot_pos, key)
+
+        struct.pack_into("<QQ", self.mm, 24, offset + len(payload), entries + 1)
+        return self.view[start:start + len(payload)].cast("i")
+
+    def release(self) -> None:
+        """Drops our references; outstanding views keep the mapping alive."""
+        self.view = None
+        self.mm = None
+
+
+class PersistentTokenCache:
+    """
+    Content-addressed, on-disk cache of tokenization results.
+
+    Keys are (vocabulary fingerprint, XXH64 of the document bytes), so the
+    cache can be shared by every job and epoch that uses the same vocab.
+    Token arrays live in mmapped, append-only segment files with an on-disk
+    open-addressing index; hits are zero-copy int32 memoryviews.
+
+    Eviction is size-bounded and generational: the cache holds two segments
+    of max_bytes / 2. When the active one fills up, the previous generation
+    is deleted and a fresh active segment is started. Hits in the previous
+    generation are promoted so hot documents survive rotation.
+
+    Writers in different processes are serialized with flock() where
+    available; readers never take it. Within a process one lock guards the
+    segment swap, so an instance may be shared by threads. A miss re-reads
+    HEAD and reopens the segments if another process rotated the cache.
+    """
+
+    def __init__(
+        self,
+        directory: Union[str, Path],
+        vocab,
+        max_bytes: int = 1 << 30,
+        slot_count: int = 1 << 20
+    ):
+        if slot_count & (slot_count - 1):
+            raise ValueError("slot_count must be a power of 2")
+        self.directory = Path(directory)
+        self.directory.mkdir(parents=True, exist_ok=True)
+        self.vocab = vocab
+        self.fingerprint = vocab.fingerprint
+        self.segment_capacity = max_bytes // 2
+        self.slot_count = slot_count
+
+        self.hits = 0
+        self.misses = 0
+
+        self._head_path = self.directory / "HEAD"
+        self._lock_path = self.directory / "LOCK"
+        # Reentrant: a promoting get() stores while holding it
+        self._lock = threading.RLock()
+        self._generation = -1
+        self._active: Optional[_Segment] = None
+        self._previous: Optional[_Segment] = None
+        with self._locked():
+            self._refresh()
+
+    # ------------------------------------------------------------------
+    # Public API
+    # ------------------------------------------------------------------
+
+    def get(self, document: Document) -> Optional[memoryview]:
+        """Returns the cached token IDs for a document, or None."""
+        key, check, length = self._key(document)
+        with self._lock:
+            hit = self._lookup(key, check, length)
+            if hit is None and self._read_head() != self._generation:
+                with self._locked():
+                    self._refresh()
+                hit = self._lookup(key, check, length)
+            if hit is None:
+                self.misses += 1
+            else:
+                self.hits += 1
+            return hit
+
+    def put(self, document: Document, token_ids) -> memoryview:
+        """Stores token IDs for a document and returns the cached view."""
+        key, check, length = self._key(document)
+        payload = array("i", token_ids).tobytes()
+        stored = self._store(key, check, length, payload)
+        return stored if stored is not None else memoryview(payload).cast("i")
+
+    def tokenize(self, text: str) -> memoryview:
+        """Cache-through tokenization: tokenizes and stores on miss."""
+        hit = self.get(text)
+        if hit is not None:
+            return hit
+        return self.put(text, self.vocab.tokenize(text))
+
+    def tokenize_many(self, texts) -> Iterator[memoryview]:
+        """Cache-through tokenization of an iterable of documents."""
+        for text in texts:
+            yield self.tokenize(text)
+
+    def close(self) -> None:
+        with self._lock:
+            for seg in (self._active, self._previous):
+                if seg is not None:
+                    seg.release()
+            self._active = self._previous = None
+
+    def __enter__(self) -> "PersistentTokenCache":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    # ------------------------------------------------------------------
+    # Internals
+    # ------------------------------------------------------------------
+
+    def _key(self, document: Document):
+        if isinstance(document, str):
+            length = len(document.encode("utf-8")) if not document.isascii() else len(document)
+        else:
+            length = memoryview(document).nbytes
+        key = content_hash(document, self.fingerprint) or 1  # 0 marks empty slots
+        check = content_hash(document, self.fingerprint ^ _CHECK_SALT)
+        return key, check, length
+
+    def _lookup(self, key: int, check: int, length: int) -> Optional[memoryview]:
+        """Active segment first; hits in the previous one are promoted."""
+        hit = self._active.lookup(key, check, length)
+        if hit is None and self._previous is not None:
+            hit = self._previous.lookup(key, check, length)
+            if hit is not None:
+                hit = self._store(key, check, length, hit.tobytes()) or hit
+        return hit
+
+    def _store(self, key: int, check: int, length: int, payload: bytes) -> Optional[memoryview]:
+        if len(payload) > self.segment_capacity or length >= 1 << 32:
+            return None
+        with self._locked():
+            self._refresh()
+            if not self._active.has_room(len(payload)):
+                self._rotate()
+            # Another process may have stored it while we waited for the lock
+            existing = self._active.lookup(key, check, length)
+            if existing is not None:
+                return existing
+            return self._active.append(key, check, length, payload)
+
+    def _segment_path(self, generation: int) -> Path:
+        return self.directory / f"gen-{generation:08d}.seg"
+
+    def _read_head(self) -> int:
+        try:
+            return int(self._head_path.read_text().strip())
+        except (FileNotFoundError, ValueError):
+            return 0
+
+    def _refresh(self) -> None:
+        """(Re)opens segments if another process rotated the cache."""
+        generation = self._read_head()
+        if generation == self._generation:
+            return
+        self.close()
+        self._generation = generation
+        self._active = _Segment(self._segment_path(generation), self.slot_count,
+                                self.segment_capacity)
+        previous = self._segment_path(generation - 1)
+        self._previous = _Segment(previous, 0, 0) if previous.exists() else None
+        if not self._head_path.exists():
+            self._head_path.write_text(str(generation))
+
+    def _rotate(self) -> None:
+        """Evicts the oldest generation and starts a new active segment."""
+        stale = self._segment_path(self._generation - 1)
+        self._head_path.write_text(str(self._generation + 1))
+        self._refresh()
+        try:
+            stale.unlink()
+        except (FileNotFoundError, PermissionError):
+            pass  # Windows keeps mapped files; removed on a later rotation
+
+    @contextmanager
+    def _locked(self):
+        """Thread lock, then the cross-process flock (never nested)."""
+        with self._lock:
+            if fcntl is None:
+                yield
+                return
+            with open(self._lock_path, "a+b") as f:
+                fcntl.flock(f.fileno(), fcntl.LOCK_EX)
+                try:
+                    yield
+                finally:
+                    fcntl.flock(f.fileno(), fcntl.LOCK_UN)
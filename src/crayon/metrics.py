@@ -0,0 +1,210 @@
+"""
+Crayon Metrics Module.
+
+Live throughput and latency metrics for services that embed the tokenizer.
+The counting happens natively (see c_ext/crayon_metrics.h): every native
+entry point records calls, bytes in, tokens out, UNK tokens and a
+log-linear latency histogram into a per-thread shard, and a scrape sums the
+shards without blocking any tokenizing thread.
+
+Recording is off by default; turn it on with enable() or by setting the
+CRAYON_METRICS=1 environment variable before importing crayon.
+
+    >>> from crayon import metrics
+    >>> metrics.enable()
+    >>> ...                                   # tokenize as usual
+    >>> metrics.snapshot()["tokenize"]["unk_rate"]
+    >>> print(metrics.prometheus_text())      # serve from /metrics
+
+The sampling profiler is a separate switch: every Nth native call per
+thread is timed together with the bytes its trie walk examined, and calls
+above a cost threshold land in a bounded ring buffer keyed by input hash.
+
+    >>> metrics.enable_profiler(sample_every=1000, ns_per_byte=50)
+    >>> for rec in metrics.dump_outliers():
+    ...     print(rec["hash"], rec["ns_per_byte"], rec["invalid_utf8"])
+"""
+
+import os
+from typing import Dict, Iterable, List, Optional, Tuple
+
+try:
+    from .c_ext import _core
+    _C_EXT_AVAILABLE = True
+except ImportError:
+    _C_EXT_AVAILABLE = False
+
+# Prometheus bucket bounds: powers of two from 256 ns to ~17 s. Every native
+# bucket lies inside one power-of-two range, so these sums are exact.
+PROMETHEUS_BOUNDS_NS = [1 << k for k in range(8, 35)]
+
+
+def _require_core():
+    if not _C_EXT_AVAILABLE:
+        raise RuntimeError("metrics require the C extension")
+    return _core
+
+
+def enable(flag: bool = True) -> None:
+    """Start (or stop) recording native tokenizer calls."""
+    _require_core().set_metrics_enabled(flag)
+
+
+def disable() -> None:
+    enable(False)
+
+
+def enabled() -> bool:
+    return _C_EXT_AVAILABLE and _core.metrics_enabled()
+
+
+def reset() -> None:
+    """Rebase all totals to zero (cheap; tokenizing threads are not touched)."""
+    _require_core().reset_metrics()
+
+
+def percentile(buckets: List[Tuple[int, int, int]], p: float) -> float:
+    """Approximate p-th percentile (ns) from (floor, ceil, count) buckets."""
+    total = sum(c for _, _, c in buckets)
+    if not total:
+        return 0.0
+    target = total * p / 100.0
+    seen = 0
+    for floor, ceil, count in buckets:
+        if seen + count >= target:
+            # Interpolate linearly inside the bucket
+            return floor + (ceil - floor) * max(target - seen, 0) / count
+        seen += count
+    return float(buckets[-1][1])
+
+
+def snapshot() -> Dict[str, Dict]:
+    """
+    Totals per entry point since the last reset.
+
+    Each entry has the raw native counters plus derived unk_rate,
+    mean_latency_ns and p50/p99/p999 latency estimates.
+    """
+    result = _require_core().get_metrics()
+    for series in result.values():
+        calls = series["calls"]
+        series["unk_rate"] = series["unk_tokens"] / series["tokens_out"] if series["tokens_out"] else 0.0
+        series["mean_latency_ns"] = series["latency_sum_ns"] / calls if calls else 0.0
+        for name, p in (("p50_ns", 50), ("p99_ns", 99), ("p999_ns", 99.9)):
+            series[name] = percentile(series["latency"], p)
+    return result
+
+
+def enable_profiler(sample_every: int = 1000, ns_per_byte: float = 0.0,
+                    lookahead_per_token: float = 0.0, capacity: int = 256) -> None:
+    """
+    Profile one call in every sample_every per thread.
+
+    A sampled call is kept as an outlier when its ns per byte exceeds
+    ns_per_byte or its trie lookahead per token exceeds lookahead_per_token
+    (0 disables a threshold; with both 0 every sampled call is kept). The
+    newest capacity outliers are retained.
+    """
+    _require_core().configure_profiler(sample_every, ns_per_byte, lookahead_per_token, capacity)
+
+
+def disable_profiler() -> None:
+    _require_core().configure_profiler(0)
+
+
+def profiler_stats() -> Dict[str, int]:
+    """sampled / outliers / overwritten counts and the current sample_every."""
+    return _require_core().profiler_stats()
+
+
+def dump_outliers(clear: bool = False) -> List[Dict]:
+    """
+    Outlier records, oldest first, with derived ns_per_byte,
+    lookahead_per_token and wasted_lookahead (bytes walked past the
+    matched tokens; each UNK token covers one byte the walk never entered).
+    hash is _core.xxh64 of the input bytes.
+    """
+    records = _require_core().profiler_dump(clear=clear)
+    for rec in records:
+        rec["ns_per_byte"] = rec["elapsed_ns"] / max(rec["bytes"], 1)
+        rec["lookahead_per_token"] = rec["lookahead_bytes"] / max(rec["tokens"], 1)
+        matched = rec["bytes"] - rec["unk_tokens"]
+        rec["wasted_lookahead"] = max(rec["lookahead_bytes"] - matched, 0)
+    return records
+
+
+def match_outliers(records: Iterable[Dict], documents: Iterable) -> List[Tuple[Dict, object]]:
+    """Pair outlier records with the documents (str or bytes) whose hash matches."""
+    core = _require_core()
+    wanted: Dict[int, List[Dict]] = {}
+    for rec in records:
+        wanted.setdefault(rec["hash"], []).append(rec)
+    matches = []
+    for doc in documents:
+        for rec in wanted.get(core.xxh64(doc), ()):
+            matches.append((rec, doc))
+    return matches
+
+
+def _cumulative(buckets: List[Tuple[int, int, int]]) -> List[Tuple[str, int]]:
+    rows, seen, i = [], 0, 0
+    for bound in PROMETHEUS_BOUNDS_NS:
+        while i < len(buckets) and buckets[i][1] <= bound:
+            seen += buckets[i][2]
+            i += 1
+        rows.append((repr(bound / 1e9), seen))
+    rows.append(("+Inf", sum(c for _, _, c in buckets)))
+    return rows
+
+
+def prometheus_text(prefix: str = "crayon", pipelines: Iterable = ()) -> str:
+    """
+    Metrics in the Prometheus text exposition format (version 0.0.4).
+
+    Args:
+        prefix: Metric name prefix.
+        pipelines: Optional PipelineTokenizer instances whose stage timings
+            are exported as summaries (labelled by pipeline index).
+    """
+    data = _require_core().get_metrics()
+    lines: List[str] = []
+
+    counters = (
+        ("calls_total", "calls", "Native tokenizer calls"),
+        ("input_bytes_total", "bytes_in", "UTF-8 bytes tokenized"),
+        ("tokens_total", "tokens_out", "Token IDs produced"),
+        ("unk_tokens_total", "unk_tokens", "UNK tokens produced"),
+    )
+    for name, key, help_text in counters:
+        lines.append(f"# HELP {prefix}_{name} {help_text}")
+        lines.append(f"# TYPE {prefix}_{name} counter")
+        for entry, series in data.items():
+            lines.append(f'{prefix}_{name}{{entry="{entry}"}} {series[key]}')
+
+    name = f"{prefix}_call_duration_seconds"
+    lines.append(f"# HELP {name} Native call latency")
+    lines.append(f"# TYPE {name} histogram")
+    for entry, series in data.items():
+        for le, count in _cumulative(series["latency"]):
+            lines.append(f'{name}_bucket{{entry="{entry}",le="{le}"}} {count}')
+        lines.append(f'{name}_sum{{entry="{entry}"}} {series["latency_sum_ns"] / 1e9!r}')
+        lines.append(f'{name}_count{{entry="{entry}"}} {series["calls"]}')
+
+    pipelines = list(pipelines)
+    if pipelines:
+        name = f"{prefix}_pipeline_stage_seconds"
+        lines.append(f"# HELP {name} Recent PipelineTokenizer stage durations")
+        lines.append(f"# TYPE {name} summary")
+        for index, pipeline in enumerate(pipelines):
+            for stage, summary in pipeline.stage_summary().items():
+                labels = f'pipeline="{index}",stage="{stage}"'
+                for q, key in (("0.5", "p50"), ("0.99", "p99")):
+                    lines.append(f'{name}{{{labels},quantile="{q}"}} {summary[key]!r}')
+                lines.append(f'{name}_sum{{{labels}}} {summary["sum"]!r}')
+                lines.append(f'{name}_count{{{labels}}} {summary["count"]}')
+
+    return "\n".join(lines) + "\n"
+
+
+if _C_EXT_AVAILABLE and os.environ.get("CRAYON_METRICS", "") not in ("", "0"):
+    enable()
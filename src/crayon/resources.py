@@ -15,7 +15,8 @@ import logging
 import csv
 import json
 from pathlib import Path
-from typing import Iterator, List, Optional
+from array import array
+from typing import Any, Iterator, List, Optional, Tuple
 from itertools import chain
 
 # Configure module logger
@@ -139,6 +140,110 @@ def yield_local_resources(max_grad_entries: int = 5000) -> Iterator[str]:
             logger.warning(f"Error reading local GRAD dataset: {e}")
 
 
+# ============================================================================
+# Native Token Shards (Local Resources -> Token IDs)
+# ============================================================================
+
+# (File name, list of fields/columns) for the structured local datasets
+LOCAL_SHARD_SOURCES: List[tuple] = [
+    ("data.csv", ["text"]),
+    ("physics_detailed_dataset_700_rows.csv", ["Question", "Answer", "Reasoning"]),
+    ("graduate_math.jsonl", ["question", "solution"]),
+]
+
+
+def tokenize_local_dataset(
+    path: Path,
+    field: str,
+    vocab: Any,
+    max_records: Optional[int] = None
+) -> Tuple[memoryview, memoryview]:
+    """
+    Tokenizes one field of a JSONL or CSV file straight into a token shard.
+    
+    With the C extension the file is scanned with AVX2 for quotes and
+    newlines, fields are unescaped in place and fed to the trie directly;
+    no per-record Python objects are created.
+    
+    Args:
+        path: .jsonl or .csv file
+        field: JSON key path ("a.b" descends into objects) or CSV column name
+        vocab: CrayonVocab used for tokenization
+        max_records: Optional cap on the number of fields tokenized
+        
+    Returns:
+        (ids, offsets): int32 token IDs of all fields back to back, and int64
+        boundaries such that field k is ids[offsets[k]:offsets[k + 1]].
+    """
+    path = Path(path)
+    is_csv = path.suffix.lower() == ".csv"
+    limit = -1 if max_records is None else max_records
+    
+    if vocab._c_ext_available and vocab._c_trie is not None:
+        from .c_ext import _core
+        native = _core.tokenize_csv if is_csv else _core.tokenize_jsonl
+        ids, offsets = native(str(path), field, vocab._c_trie, vocab.unk_token_id, limit)
+        return memoryview(ids).cast('i'), memoryview(offsets).cast('q')
+    
+    # Python fallback: same shard layout via the stdlib parsers
+    ids = array('i')
+    offsets = array('q', [0])
+    # newline='' as the csv module requires: quoted "\r\n" stays intact, as
+    # in the native reader
+    with open(path, 'r', encoding='utf-8', errors='ignore', newline='') as f:
+        if is_csv:
+            reader = csv.DictReader(f)
+            if field not in (reader.fieldnames or []):
+                raise KeyError(f"CSV column '{field}' not found in header")
+            values = (row[field] for row in reader)
+        else:
+            values = (_json_path(line, field) for line in f)
+        for value in values:
+            if limit >= 0 and len(offsets) > limit:
+                break
+            if isinstance(value, str) and value:
+                ids.extend(vocab.tokenize(value))
+                offsets.append(len(ids))
+    return memoryview(ids), memoryview(offsets)
+
+
+def _json_path(line: str, field: str) -> Any:
+    """Resolves a dotted key path in one JSONL line (None if absent/invalid)."""
+    try:
+        value = json.loads(line)
+    except json.JSONDecodeError:
+        return None
+    for key in field.split('.'):
+        if not isinstance(value, dict):
+            return None
+        value = value.get(key)
+    return value
+
+
+def yield_local_token_shards(
+    vocab: Any,
+    max_grad_entries: int = 5000
+) -> Iterator[Tuple[str, str, memoryview, memoryview]]:
+    """
+    Yields (file name, field, ids, offsets) for every structured local dataset.
+    
+    Native counterpart of yield_local_resources() for the CSV/JSONL sources:
+    files go to token shards without materializing the text in Python.
+    """
+    for name, fields in LOCAL_SHARD_SOURCES:
+        path = RESOURCE_DIR / name
+        if not path.exists():
+            continue
+        limit = max_grad_entries if path.suffix == ".jsonl" else None
+        for field in fields:
+            try:
+                ids, offsets = tokenize_local_dataset(path, field, vocab, limit)
+            except (OSError, KeyError) as e:
+                logger.warning(f"Error tokenizing {name}:{field}: {e}")
+                continue
+            yield name, field, ids, offsets
+
+
 # ============================================================================
 # Streaming Iterators (Priority 2)
 # ============================================================================
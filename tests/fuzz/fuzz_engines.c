@@ -0,0 +1,416 @@
+/*
+ * Differential fuzz harness for the Crayon tokenizer engines.
+ *
+ * Every input is decoded into a small random vocabulary plus a text, and
+ * each engine's token IDs and byte offsets are compared against a naive
+ * oracle that scans the vocabulary list directly (no trie at all). Any
+ * mismatch aborts, which libFuzzer and AFL both report as a crash.
+ *
+ * Engines checked:
+ *   into      crayon_tokenize_into on the builder trie (what
+ *             crayon_tokenize_fast and Tokenizer.tokenize run)
+ *   count     crayon_count_tokens
+ *   bounded   crayon_tokenize_bounded resumed with a tiny output capacity;
+ *             every resume offset must land on an oracle token boundary
+ *   split     input cut at an oracle token boundary and tokenized as two
+ *             chunks (what a split-safe file splitter does)
+ *   image     crayon_trie_serialize -> crayon_trie_load round trip
+ *   table     every crayon_kernels[] instance (u16, count, offsets and
+ *             lookahead sinks) over the trie and the hashed prefix
+ *             matcher, through the dispatch table
+ *   classify  classify_characters_avx2 against the generated byte table
+ *   optimal   crayon_segment_optimal: a valid segmentation whose length is
+ *             the oracle's fewest-token count (never more than greedy)
+ *   sample    crayon_segment_sample over a scored trie spells the text back
+ *   scores    log-probabilities survive the image round trip
+ *   parallel  crayon_tokenize_parallel with 1-4 threads and segments of a
+ *             few bytes, over the trie and the hashed prefix matcher;
+ *             crayon_split_safe agrees with a scan of the vocabulary
+ *
+ * The raw input is also handed to crayon_trie_load as an untrusted image;
+ * it must either be rejected or tokenize without faulting.
+ *
+ * Input layout: [n_tokens] [capacity] then n_tokens x ([len] bytes...),
+ * and the rest is the text (arbitrary bytes, invalid UTF-8 included).
+ *
+ * Build:
+ *   make            standalone driver (files or stdin, AFL compatible)
+ *   make libfuzzer  clang -fsanitize=fuzzer,address,undefined
+ *   make smoke      standalone driver over seeded random inputs
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "byte_tables.h"
+#include "crayon_parallel.h"
+#include "crayon_segment.h"
+#include "simd_ops.h"
+#include "trie_builder.h"
+#include "trie_image.h"
+#include "trie_match.h"
+
+#define MAX_TOKENS 48
+#define MAX_TOKEN_LEN 12
+#define MAX_TEXT 8192
+
+typedef struct {
+    const uint8_t* bytes[MAX_TOKENS];
+    size_t lengths[MAX_TOKENS];
+    int count;
+} FuzzVocab;
+
+typedef struct {
+    int32_t id;
+    size_t start;
+    size_t end;
+} Span;
+
+static void fail(const char* engine, size_t index) {
+    fprintf(stderr, "engine '%s' diverges from the oracle at token %zu\n", engine, index);
+    abort();
+}
+
+// Greedy longest match by brute force; later duplicates win like the builder
+static size_t oracle_tokenize(const FuzzVocab* vocab, const uint8_t* text, size_t length,
+                              int32_t unk_id, Span* out) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < length) {
+        int32_t best_id = unk_id;
+        size_t best_len = 0;
+        for (int t = 0; t < vocab->count; t++) {
+            size_t len = vocab->lengths[t];
+            if (len >= best_len && len <= length - pos &&
+                memcmp(vocab->bytes[t], text + pos, len) == 0) {
+                best_id = t;
+                best_len = len;
+            }
+        }
+        size_t step = best_len ? best_len : 1;
+        out[count++] = (Span){best_id, pos, pos + step};
+        pos += step;
+    }
+    return count;
+}
+
+// Fewest tokens by brute-force DP, with the same UNK rule as the kernels
+// (a one-byte UNK only where no token starts)
+static size_t oracle_fewest(const FuzzVocab* vocab, const uint8_t* text, size_t length) {
+    static size_t best[MAX_TEXT + 1];
+    best[length] = 0;
+    for (size_t i = length; i-- > 0;) {
+        size_t cost = 0;
+        for (int t = 0; t < vocab->count; t++) {
+            size_t len = vocab->lengths[t];
+            if (len <= length - i && memcmp(vocab->bytes[t], text + i, len) == 0 &&
+                (cost == 0 || 1 + best[i + len] < cost)) {
+                cost = 1 + best[i + len];
+            }
+        }
+        best[i] = cost ? cost : 1 + best[i + 1];
+    }
+    return best[0];
+}
+
+// IDs must spell the text back; the builder keeps the last duplicate,
+// whose bytes equal every earlier copy's
+static void expect_spelling(const char* engine, const FuzzVocab* vocab, const uint8_t* text,
+                            size_t length, int32_t unk_id, const int32_t* ids, size_t count) {
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == unk_id) {
+            pos += 1;
+            continue;
+        }
+        size_t len = vocab->lengths[ids[i]];
+        if (len > length - pos || memcmp(vocab->bytes[ids[i]], text + pos, len) != 0) {
+            fail(engine, i);
+        }
+        pos += len;
+    }
+    if (pos != length) fail(engine, count);
+}
+
+static void check_optimal(const FuzzVocab* vocab, const TrieNode* root, const uint8_t* text,
+                          size_t length, int32_t unk_id, size_t greedy, int32_t* ids) {
+    size_t count;
+    if (crayon_segment_optimal(root, text, length, unk_id, NULL, ids, &count) != 0) {
+        fail("optimal", 0);
+    }
+    if (count != oracle_fewest(vocab, text, length) || count > greedy) fail("optimal", count);
+    expect_spelling("optimal", vocab, text, length, unk_id, ids, count);
+
+    CrayonRng rng;
+    crayon_rng_seed(&rng, length);
+    if (crayon_segment_sample(root, text, length, unk_id, -10.0f, 1.0f, &rng, ids, &count) != 0) {
+        fail("sample", 0);
+    }
+    expect_spelling("sample", vocab, text, length, unk_id, ids, count);
+}
+
+static void expect_ids(const char* engine, const int32_t* ids, size_t count,
+                       const Span* spans, size_t expected) {
+    if (count != expected) fail(engine, count < expected ? count : expected);
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] != spans[i].id) fail(engine, i);
+    }
+}
+
+static void check_kernel_table(CrayonViewKind view, const void* root, const uint8_t* text,
+                               size_t length, int32_t unk_id, const Span* spans,
+                               size_t expected, int32_t* ids) {
+    const char* engine = view == CRAYON_VIEW_HASH ? "table/hash" : "table/node";
+    static uint16_t narrow[MAX_TEXT];
+    static size_t offsets[MAX_TEXT];
+    size_t matched = 0;
+    for (size_t i = 0; i < expected; i++) {
+        if (spans[i].id != unk_id) matched += spans[i].end - spans[i].start;
+    }
+
+    for (int kind = 0; kind < CRAYON_SINK_KINDS; kind++) {
+        void* out = kind == CRAYON_SINK_U16 ? (void*)narrow : (void*)ids;
+        CrayonSink sink = {out, offsets, length, 0, 0, 0};
+        size_t consumed = crayon_kernels[view][kind](root, text, length, unk_id, &sink);
+        if (consumed != length || sink.count != expected) fail(engine, (size_t)kind);
+        for (size_t i = 0; i < expected; i++) {
+            int ok = 1;
+            switch (kind) {
+            case CRAYON_SINK_U16:
+                ok = narrow[i] == (uint16_t)spans[i].id;
+                break;
+            case CRAYON_SINK_COUNT:
+                break;
+            case CRAYON_SINK_OFFSETS:
+                ok = ids[i] == spans[i].id && offsets[i] == spans[i].start;
+                break;
+            default:
+                ok = ids[i] == spans[i].id;
+            }
+            if (!ok) fail(engine, i);
+        }
+        // The walk covers every matched byte, plus any lookahead past it
+        if (kind == CRAYON_SINK_LOOKAHEAD && sink.lookahead < matched) fail(engine, 0);
+    }
+}
+
+static void check_engines(const TrieNode* root, const TrieNode* image_root,
+                          const uint8_t* text, size_t length, int32_t unk_id,
+                          size_t capacity, const Span* spans, size_t expected,
+                          int32_t* ids) {
+    size_t count = crayon_tokenize_into(root, text, length, unk_id, ids);
+    expect_ids("into", ids, count, spans, expected);
+
+    if (crayon_count_tokens(root, text, length) != expected) fail("count", 0);
+
+    // Resume until done; each stop must sit on the oracle's next boundary
+    size_t position = 0;
+    count = 0;
+    while (position < length) {
+        size_t consumed;
+        size_t n = crayon_tokenize_bounded(root, text + position, length - position,
+                                           unk_id, ids + count, capacity, &consumed);
+        count += n;
+        position += consumed;
+        if (n == 0 || count > expected || spans[count - 1].end != position) {
+            fail("bounded", count);
+        }
+    }
+    expect_ids("bounded", ids, count, spans, expected);
+
+    if (expected > 1) {
+        size_t cut = spans[expected / 2].start;
+        count = crayon_tokenize_into(root, text, cut, unk_id, ids);
+        count += crayon_tokenize_into(root, text + cut, length - cut, unk_id, ids + count);
+        expect_ids("split", ids, count, spans, expected);
+    }
+
+    if (image_root) {
+        count = crayon_tokenize_into(image_root, text, length, unk_id, ids);
+        expect_ids("image", ids, count, spans, expected);
+    }
+
+    check_kernel_table(CRAYON_VIEW_NODE, root, text, length, unk_id, spans, expected, ids);
+
+    // Fuzz tokens are at most MAX_TOKEN_LEN <= 16 bytes, so this always builds
+    int too_long;
+    CrayonHashMatcher* hash = crayon_hash_matcher_build(root, &too_long);
+    if (!hash) fail("hash", 0);
+    check_kernel_table(CRAYON_VIEW_HASH, hash, text, length, unk_id, spans, expected, ids);
+    crayon_hash_matcher_free(hash);
+
+    static uint8_t classes[MAX_TEXT];
+    classify_characters_avx2(text, classes, length);
+    for (size_t i = 0; i < length; i++) {
+        uint8_t want = crayon_byte_class[text[i]] &
+                       (CRAYON_BYTE_ALPHA | CRAYON_BYTE_DIGIT | CRAYON_BYTE_SPACE);
+        if (classes[i] != want) fail("classify", i);
+    }
+}
+
+static void check_parallel(const FuzzVocab* vocab, const CrayonTrie* trie, const uint8_t* text,
+                           size_t length, int32_t unk_id, size_t capacity, const Span* spans,
+                           size_t expected, int32_t* ids) {
+    // A whitespace byte is a safe cut iff no token has it past its first byte
+    for (int b = 0; b < 256; b++) {
+        int inner = 0;
+        for (int t = 0; t < vocab->count; t++) {
+            for (size_t i = 1; i < vocab->lengths[t]; i++) inner |= vocab->bytes[t][i] == b;
+        }
+        int want = (crayon_byte_class[b] & CRAYON_BYTE_SPACE) && !inner;
+        if (crayon_split_safe(trie, (uint8_t)b) != want) fail("parallel", (size_t)b);
+    }
+
+    int too_long;
+    CrayonHashMatcher* hash = crayon_hash_matcher_build(trie->root, &too_long);
+    if (!hash) fail("parallel", 0);
+    for (int threads = 1; threads <= 4; threads++) {
+        size_t count;
+        size_t segment = capacity + (size_t)threads;
+        if (crayon_tokenize_parallel(trie, CRAYON_VIEW_NODE, trie->root, text, length, unk_id,
+                                     threads, segment, ids, &count) != 0) {
+            fail("parallel", 0);
+        }
+        expect_ids("parallel", ids, count, spans, expected);
+        if (crayon_tokenize_parallel(trie, CRAYON_VIEW_HASH, hash, text, length, unk_id,
+                                     threads, segment, ids, &count) != 0) {
+            fail("parallel", 0);
+        }
+        expect_ids("parallel", ids, count, spans, expected);
+    }
+    crayon_hash_matcher_free(hash);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static Span spans[MAX_TEXT];
+    static int32_t ids[MAX_TEXT];
+
+    if (size < 2) return 0;
+    FuzzVocab vocab = {.count = 0};
+    int wanted = data[0] % (MAX_TOKENS + 1);
+    size_t capacity = (size_t)(data[1] % 7) + 1;
+    size_t pos = 2;
+    while (vocab.count < wanted && pos < size) {
+        size_t len = (size_t)(data[pos++] % MAX_TOKEN_LEN) + 1;
+        if (len > size - pos) break;
+        vocab.bytes[vocab.count] = data + pos;
+        vocab.lengths[vocab.count++] = len;
+        pos += len;
+    }
+    const uint8_t* text = data + pos;
+    size_t length = size - pos;
+    if (length > MAX_TEXT) length = MAX_TEXT;
+    int32_t unk_id = vocab.count;  // Never collides with a real token
+
+    CrayonTrieBuilder* builder = crayon_builder_new();
+    if (!builder) abort();
+    for (int t = 0; t < vocab.count; t++) {
+        if (crayon_builder_insert(builder, vocab.bytes[t], vocab.lengths[t], t) != 0) abort();
+    }
+    CrayonTrie* trie = crayon_builder_finish(builder);
+    if (!trie) abort();
+    float scores[MAX_TOKENS];
+    for (int t = 0; t < vocab.count; t++) scores[t] = -(float)(vocab.bytes[t][0] % 13) - 0.5f;
+    crayon_trie_set_scores(trie, scores, (size_t)vocab.count);
+
+    uint8_t* image;
+    size_t image_length;
+    CrayonTrie* loaded = NULL;
+    int malformed;
+    if (crayon_trie_serialize(trie, &image, &image_length) != 0) abort();
+    loaded = crayon_trie_load(image, image_length, &malformed);
+    free(image);
+    if (!loaded) fail("image", 0);
+
+    size_t expected = oracle_tokenize(&vocab, text, length, unk_id, spans);
+    check_engines(trie->root, loaded->root, text, length, unk_id, capacity,
+                  spans, expected, ids);
+    check_optimal(&vocab, trie->root, text, length, unk_id, expected, ids);
+    check_parallel(&vocab, trie, text, length, unk_id, capacity, spans, expected, ids);
+    if (!loaded->scored) fail("scores", 0);
+    for (int t = 0; t < vocab.count; t++) {
+        const TrieNode* node = loaded->root;
+        for (size_t i = 0; i < vocab.lengths[t]; i++) {
+            node = &node->children[find_child_simd(node, vocab.bytes[t][i])];
+        }
+        if (node->log_prob != scores[node->token_id]) fail("scores", (size_t)t);
+    }
+    crayon_trie_decref(loaded);
+    crayon_trie_decref(trie);
+
+    // Untrusted image: rejection is fine, faults are not
+    uint8_t* raw = malloc(CRAYON_TRIE_IMAGE_HEADER + size);
+    if (!raw) abort();
+    memcpy(raw, CRAYON_TRIE_IMAGE_MAGIC, 8);
+    // Odd capacity bytes exercise the scored layout (nodes + log_prob table)
+    uint32_t flags = data[1] & CRAYON_TRIE_IMAGE_SCORED;
+    size_t record = sizeof(CrayonImageNode) + (flags ? sizeof(float) : 0);
+    uint32_t nodes = (uint32_t)((size - 2) / record);
+    memcpy(raw + 8, &nodes, sizeof(nodes));
+    memcpy(raw + 12, &flags, sizeof(flags));
+    memcpy(raw + CRAYON_TRIE_IMAGE_HEADER, data + 2, size - 2);
+    loaded = crayon_trie_load(raw, CRAYON_TRIE_IMAGE_HEADER + size - 2, &malformed);
+    if (loaded) {
+        crayon_tokenize_into(loaded->root, text, length, unk_id, ids);
+        crayon_trie_decref(loaded);
+    }
+    free(raw);
+    return 0;
+}
+
+#ifndef CRAYON_LIBFUZZER
+// Standalone driver: input files, stdin (AFL), or --random N [seed]
+static int run_file(FILE* f) {
+    static uint8_t buf[1 << 20];
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    return LLVMFuzzerTestOneInput(buf, n);
+}
+
+// Small alphabets make tokens overlap and nest, so matches actually happen
+static int run_random(long iterations, unsigned seed) {
+    static uint8_t buf[4096];
+    static const uint8_t alphabets[][8] = {
+        "ab", "abc\n ", {0xC3, 0xA9, 0xE2, 0x82, 0xAC, 'a', 0xFF, 0x80},
+    };
+    srand(seed);
+    for (long it = 0; it < iterations; it++) {
+        const uint8_t* alphabet = alphabets[it % 3];
+        size_t letters = strnlen((const char*)alphabet, 8);
+        size_t size = 2 + (size_t)(rand() % (int)(sizeof(buf) - 2));
+        for (size_t i = 0; i < size; i++) buf[i] = alphabet[rand() % letters];
+        buf[0] = (uint8_t)rand();
+        buf[1] = (uint8_t)rand();
+        // Short token length bytes keep the vocabulary in the first part
+        size_t pos = 2;
+        for (int t = 0; t < buf[0] % (MAX_TOKENS + 1) && pos < size; t++) {
+            size_t len = (size_t)(rand() % 4);
+            buf[pos] = (uint8_t)len;
+            pos += len + 2;
+        }
+        LLVMFuzzerTestOneInput(buf, size);
+    }
+    printf("%ld random inputs ok\n", iterations);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return run_file(stdin);
+    if (strcmp(argv[1], "--random") == 0) {
+        long iterations = argc > 2 ? atol(argv[2]) : 10000;
+        return run_random(iterations, argc > 3 ? (unsigned)atol(argv[3]) : 88);
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE* f = fopen(argv[i], "rb");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        run_file(f);
+        fclose(f);
+    }
+    printf("%d inputs ok\n", argc - 1);
+    return 0;
+}
+#endif
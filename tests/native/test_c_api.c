@@ -0,0 +1,206 @@
+/*
+ * libcrayon public API test (run by ctest against both the shared and the
+ * static library). Only crayon.h is included: anything this file needs
+ * beyond it is a gap in the installed interface.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crayon.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static const char* const VOCAB[] = {"apple", "app", "application", "banana", "band", "b", "<UNK>"};
+#define VOCAB_SIZE (sizeof(VOCAB) / sizeof(VOCAB[0]))
+#define UNK 6
+
+static void check_ids(const int32_t* got, size_t n, const int32_t* want, size_t want_n) {
+    CHECK(n == want_n);
+    for (size_t i = 0; i < n && i < want_n; i++) CHECK(got[i] == want[i]);
+}
+
+static void test_tokenize(const crayon_trie* trie) {
+    const char* text = "applicationband\x01" "apple";
+    size_t length = strlen(text);
+    const int32_t want[] = {2, 4, UNK, 0};
+    int32_t out[32];
+    size_t consumed;
+
+    size_t n = crayon_tokenize(trie, text, length, UNK, out, length, &consumed);
+    check_ids(out, n, want, 4);
+    CHECK(consumed == length);
+    CHECK(crayon_count(trie, text, length) == 4);
+
+    // Resume with a one-slot buffer: every step lands on a token boundary
+    size_t position = 0;
+    size_t total = 0;
+    while (position < length) {
+        n = crayon_tokenize(trie, text + position, length - position, UNK, out, 1, &consumed);
+        CHECK(n == 1 && consumed > 0);
+        if (n != 1 || consumed == 0) break;
+        CHECK(total < 4 && out[0] == want[total]);
+        total++;
+        position += consumed;
+    }
+    CHECK(total == 4);
+
+    size_t offsets[32];
+    const size_t want_offsets[] = {0, 11, 15, 16};
+    n = crayon_tokenize_offsets(trie, text, length, UNK, out, offsets, 32, &consumed);
+    check_ids(out, n, want, 4);
+    for (size_t i = 0; i < n && i < 4; i++) CHECK(offsets[i] == want_offsets[i]);
+    CHECK(consumed == length);
+    CHECK(crayon_max_token_length(trie) == strlen("application"));
+
+    // Embedded NUL bytes are ordinary input
+    n = crayon_tokenize(trie, "b\0b", 3, UNK, out, 3, NULL);
+    const int32_t nul[] = {5, UNK, 5};
+    check_ids(out, n, nul, 3);
+}
+
+static void test_image(const crayon_trie* trie) {
+    uint8_t* image;
+    size_t image_length;
+    CHECK(crayon_save_image(trie, &image, &image_length) == CRAYON_OK);
+
+    crayon_trie* loaded = NULL;
+    CHECK(crayon_load_image(image, image_length, &loaded) == CRAYON_OK);
+    if (loaded) {
+        test_tokenize(loaded);
+        crayon_free(loaded);
+    }
+
+    // Truncated and corrupted images are rejected, not crashed on
+    crayon_trie* bad = NULL;
+    CHECK(crayon_load_image(image, image_length - 1, &bad) == CRAYON_EMALFORMED && !bad);
+    image[0] ^= 0xFF;
+    CHECK(crayon_load_image(image, image_length, &bad) == CRAYON_EMALFORMED && !bad);
+    crayon_buffer_free(image);
+}
+
+static void put_le(uint8_t* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+/*
+ * CrayonVocab.save(format="image") layout: header | unk | offsets (code
+ * points) | text | pad to 8 | trie. Written by hand here so the test
+ * needs no Python; tests/test_cli.py loads a real saved file.
+ */
+static size_t wrap_vocab_image(uint8_t* buf, const uint8_t* trie, size_t trie_length) {
+    const char* unk = VOCAB[UNK];
+    size_t pos = 48;
+    memcpy(buf + pos, unk, strlen(unk));
+    pos += strlen(unk);
+    size_t text_length = 0;
+    put_le(buf + pos, 0, 4);
+    for (size_t i = 0; i < VOCAB_SIZE; i++) {
+        text_length += strlen(VOCAB[i]);
+        put_le(buf + pos + 4 * (i + 1), text_length, 4);
+    }
+    pos += 4 * (VOCAB_SIZE + 1);
+    for (size_t i = 0; i < VOCAB_SIZE; i++) {
+        memcpy(buf + pos, VOCAB[i], strlen(VOCAB[i]));
+        pos += strlen(VOCAB[i]);
+    }
+    while (pos % 8) buf[pos++] = 0;
+    if (trie_length) memcpy(buf + pos, trie, trie_length);
+    pos += trie_length;
+
+    memcpy(buf, "CRYNVOC1", 8);
+    put_le(buf + 8, 1, 4);
+    put_le(buf + 12, strlen(unk), 4);
+    put_le(buf + 16, UNK, 8);
+    put_le(buf + 24, VOCAB_SIZE, 8);
+    put_le(buf + 32, text_length, 8);
+    put_le(buf + 40, trie_length, 8);
+    return pos;
+}
+
+static void test_vocab_image(const crayon_trie* trie) {
+    uint8_t* image;
+    size_t image_length;
+    CHECK(crayon_save_image(trie, &image, &image_length) == CRAYON_OK);
+    uint8_t* buf = (uint8_t*)malloc(image_length + 256);
+    if (!buf) {
+        crayon_buffer_free(image);
+        return;
+    }
+
+    // With the compiled trie, and without (rebuilt from the tokens)
+    for (int with_trie = 1; with_trie >= 0; with_trie--) {
+        size_t length = with_trie ? wrap_vocab_image(buf, image, image_length)
+                                  : wrap_vocab_image(buf, NULL, 0);
+        crayon_trie* loaded = NULL;
+        CHECK(crayon_load_image(buf, length, &loaded) == CRAYON_OK);
+        if (loaded) {
+            test_tokenize(loaded);
+            crayon_free(loaded);
+        }
+        crayon_trie* bad = NULL;
+        CHECK(crayon_load_image(buf, 60, &bad) == CRAYON_EMALFORMED && !bad);
+    }
+    free(buf);
+    crayon_buffer_free(image);
+}
+
+static void test_arguments(void) {
+    crayon_trie* trie = NULL;
+    CHECK(crayon_build(NULL, NULL, 1, &trie) == CRAYON_EINVAL);
+    CHECK(crayon_build(VOCAB, NULL, VOCAB_SIZE, NULL) == CRAYON_EINVAL);
+    CHECK(crayon_load_image(NULL, 16, &trie) == CRAYON_EINVAL);
+    CHECK(crayon_tokenize(NULL, "x", 1, UNK, NULL, 0, NULL) == 0);
+    CHECK(crayon_count(NULL, "x", 1) == 0);
+    crayon_free(NULL);
+
+    // Empty vocabulary: every byte is UNK
+    CHECK(crayon_build(NULL, NULL, 0, &trie) == CRAYON_OK);
+    if (trie) {
+        CHECK(crayon_count(trie, "abc", 3) == 3);
+        crayon_free(trie);
+    }
+
+    // Explicit lengths, later duplicates win
+    const char* dup[] = {"abXX", "ab"};
+    const size_t lengths[] = {2, 2};
+    CHECK(crayon_build(dup, lengths, 2, &trie) == CRAYON_OK);
+    if (trie) {
+        int32_t out[2];
+        CHECK(crayon_tokenize(trie, "ab", 2, -1, out, 2, NULL) == 1 && out[0] == 1);
+        crayon_free(trie);
+    }
+}
+
+int main(void) {
+    CHECK(strcmp(crayon_version(), CRAYON_VERSION_STRING) == 0);
+
+    crayon_trie* trie = NULL;
+    CHECK(crayon_build(VOCAB, NULL, VOCAB_SIZE, &trie) == CRAYON_OK);
+    if (!trie) return 1;
+
+    // A retained reference outlives the builder's
+    crayon_trie* second = crayon_retain(trie);
+    crayon_free(trie);
+    test_tokenize(second);
+    test_image(second);
+    test_vocab_image(second);
+    crayon_free(second);
+
+    test_arguments();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("libcrayon %s: all checks passed\n", crayon_version());
+    return 0;
+}
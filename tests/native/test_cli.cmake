@@ -0,0 +1,70 @@
+# crayon-tokenize chunking test (ctest -R cli_chunking).
+#
+# Tokenizes the same corpus single-threaded in one block (the reference)
+# and again with tiny chunks across several threads, from a mapped file
+# and from stdin, and requires byte-identical IDs. Chunks of ~100 bytes put
+# a chunk boundary inside most long tokens, so the merge's resync path and
+# the streaming carry are exercised on every run.
+#
+#   cmake -DCLI=... -DSOURCE_DIR=... -DWORK_DIR=... -P test_cli.cmake
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(VOCAB ${SOURCE_DIR}/trained_vocab.txt)
+set(CORPUS ${WORK_DIR}/corpus.txt)
+
+file(READ ${SOURCE_DIR}/README.md readme)
+file(READ ${SOURCE_DIR}/src/crayon/core/vocabulary.py code)
+file(WRITE ${CORPUS} "${readme}${code}${readme}")
+
+function(run)
+    execute_process(COMMAND ${CLI} -q -v ${VOCAB} ${ARGN} RESULT_VARIABLE rc ERROR_VARIABLE err)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "crayon-tokenize ${ARGN} failed (${rc}): ${err}")
+    endif()
+endfunction()
+
+function(expect_same a b)
+    file(SHA256 ${a} ha)
+    file(SHA256 ${b} hb)
+    if(NOT ha STREQUAL hb)
+        message(FATAL_ERROR "${b} differs from ${a}")
+    endif()
+endfunction()
+
+run(-t 1 --chunk-size 64M -f u32 -o ${WORK_DIR}/ref.u32 ${CORPUS})
+file(SIZE ${WORK_DIR}/ref.u32 ref_size)
+if(ref_size EQUAL 0)
+    message(FATAL_ERROR "reference output is empty")
+endif()
+
+run(-t 4 --chunk-size 97 -f u32 -o ${WORK_DIR}/mapped.u32 ${CORPUS})
+expect_same(${WORK_DIR}/ref.u32 ${WORK_DIR}/mapped.u32)
+
+# stdin: blocks of 3 x 113 bytes with the lookahead tail carried over
+execute_process(COMMAND ${CLI} -q -v ${VOCAB} -t 3 --chunk-size 113 -f u32
+                INPUT_FILE ${CORPUS} OUTPUT_FILE ${WORK_DIR}/stream.u32 RESULT_VARIABLE rc)
+if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "crayon-tokenize from stdin failed (${rc})")
+endif()
+expect_same(${WORK_DIR}/ref.u32 ${WORK_DIR}/stream.u32)
+
+# Text shards: every shard within the limit, cut between lines, same IDs
+run(-t 1 -f text -o ${WORK_DIR}/ref.txt ${CORPUS})
+file(GLOB old_shards ${WORK_DIR}/shard.*)
+if(old_shards)
+    file(REMOVE ${old_shards})
+endif()
+run(-t 2 --chunk-size 1000 -f text -o ${WORK_DIR}/shard --shard-size 1000 ${CORPUS})
+file(GLOB shards ${WORK_DIR}/shard.*)
+list(SORT shards)
+set(joined "")
+foreach(shard ${shards})
+    file(SIZE ${shard} size)
+    file(READ ${shard} content)
+    if(size GREATER 1000 OR NOT content MATCHES "\n$")
+        message(FATAL_ERROR "bad shard ${shard} (${size} bytes)")
+    endif()
+    string(APPEND joined "${content}")
+endforeach()
+file(WRITE ${WORK_DIR}/joined.txt "${joined}")
+expect_same(${WORK_DIR}/ref.txt ${WORK_DIR}/joined.txt)
@@ -0,0 +1,63 @@
+"""
+Generated byte tables (tools/gen_byte_tables.py) against their definitions.
+"""
+
+import importlib.util
+import os
+import unittest
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+spec = importlib.util.spec_from_file_location(
+    "gen_byte_tables", os.path.join(ROOT, "tools", "gen_byte_tables.py"))
+gen = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(gen)
+
+
+class TestByteTables(unittest.TestCase):
+
+    def test_checked_in_files_are_current(self):
+        for path, content in gen.outputs().items():
+            with open(path, encoding="utf-8") as f:
+                self.assertEqual(f.read(), content, f"{path} is stale")
+
+    def test_nibble_tables_match_byte_classes(self):
+        lo, hi, masks = gen.nibble_tables()
+        classes = gen.byte_class()
+        bits = {name: bit for name, bit, _, _ in gen.CLASSES}
+        for b in range(256):
+            hit = lo[b & 15] & hi[b >> 4]
+            for name in gen.VECTOR_CLASSES:
+                self.assertEqual(bool(hit & masks[name]), bool(classes[b] & bits[name]),
+                                 f"{name} 0x{b:02X}")
+
+    def test_utf8_tables_accept_exactly_well_formed_sequences(self):
+        length = gen.utf8_length()
+        second_min, second_max = gen.utf8_second_range()
+
+        def table_valid(seq: bytes) -> bool:
+            n = length[seq[0]]
+            if n != len(seq):
+                return False
+            if n > 1 and not second_min[seq[0] - 0xC0] <= seq[1] <= second_max[seq[0] - 0xC0]:
+                return False
+            return all(0x80 <= c <= 0xBF for c in seq[2:])
+
+        def python_valid(seq: bytes) -> bool:
+            try:
+                return len(seq.decode("utf-8")) == 1
+            except UnicodeDecodeError:
+                return False
+
+        # Every lead with every second byte; later bytes only matter as
+        # continuation checks, so one valid and one invalid tail suffice
+        for lead in range(256):
+            for second in range(256):
+                for tail in (b"", b"\x80", b"\x80\xbf", b"\x41", b"\x80\x41"):
+                    seq = bytes([lead, second]) + tail
+                    self.assertEqual(table_valid(seq), python_valid(seq), seq.hex())
+            self.assertEqual(table_valid(bytes([lead])), python_valid(bytes([lead])))
+
+
+if __name__ == "__main__":
+    unittest.main()
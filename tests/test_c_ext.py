@@ -1,6 +1,13 @@
 import unittest
 import sys
+import os
+import json
+import shutil
+import subprocess
+import tempfile
+import threading
 from crayon.core.vocabulary import CrayonVocab
+from crayon.resources import tokenize_local_dataset
 
 # Check availability
 try:
@@ -9,6 +16,14 @@ try:
 except ImportError:
     C_EXT_AVAILABLE = False
 
+try:
+    import _interpreters as SUBINTERPRETERS
+except ImportError:
+    try:
+        import _xxsubinterpreters as SUBINTERPRETERS
+    except ImportError:
+        SUBINTERPRETERS = None
+
 class TestCExtension(unittest.TestCase):
     
     def setUp(self):
@@ -68,4 +83,449 @@ class TestCExtension(unittest.TestCase):
         c_result = self.vocab.tokenize(text)
         
         # Results should be identical
-        self.assertEqual(python_result, c_result)
\ No newline at end of file
+        self.assertEqual(python_result, c_result)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_native_tokenizer_binding(self):
+        """vocab.tokenize is the native Tokenizer method while the C path is active."""
+        tokenizer = self.vocab._c_tokenizer
+        self.assertIsInstance(tokenizer, _core.Tokenizer)
+        self.assertEqual(tokenizer.unk_token_id, self.vocab.unk_token_id)
+        self.assertEqual(self.vocab.tokenize, tokenizer.tokenize)
+        # bytes input is tokenized without decoding
+        self.assertEqual(tokenizer.tokenize(b"appleband"), self.vocab.tokenize("appleband"))
+
+        self.vocab._c_ext_available = False
+        self.assertNotEqual(self.vocab.tokenize, tokenizer.tokenize)
+        self.vocab._c_ext_available = True
+        self.assertEqual(self.vocab.tokenize, tokenizer.tokenize)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_native_entry_points(self):
+        """count, tokenize_into and tokenize_batch agree with tokenize."""
+        from array import array
+        tokenizer = self.vocab._c_tokenizer
+        texts = ["appleband", b"application b", "x" * 5000, ""]
+        expected = [tokenizer.tokenize(t) for t in texts]
+
+        self.assertEqual([tokenizer.count(t) for t in texts], [len(e) for e in expected])
+        self.assertEqual(tokenizer.tokenize_batch(texts), expected)
+        self.assertEqual(tokenizer.tokenize_batch(iter(texts)), expected)
+
+        out = array("i", bytes(4 * 5000))
+        for text, ids in zip(texts, expected):
+            n = tokenizer.tokenize_into(text, out)
+            self.assertEqual(out[:n].tolist(), ids)
+        with self.assertRaises(ValueError):
+            tokenizer.tokenize_into("appleband", array("i", [0]))
+        with self.assertRaises(TypeError):
+            tokenizer.tokenize_into("appleband", array("d", [0.0] * 8))
+
+        # 16-bit buffers go through the uint16 kernel
+        narrow = array("H", bytes(2 * 5000))
+        for text, ids in zip(texts, expected):
+            n = tokenizer.tokenize_into(text, narrow)
+            self.assertEqual(narrow[:n].tolist(), ids)
+        wide_ids = _core.Tokenizer(self.vocab._c_trie, 70000)
+        with self.assertRaises(OverflowError):
+            wide_ids.tokenize_into("\x01", narrow)
+        # IDs up to 0xFFFF fit uint16; a signed 'h' buffer would wrap them
+        high_ids = _core.Tokenizer(self.vocab._c_trie, 0xFFFF)
+        self.assertEqual(high_ids.tokenize_into("\x01", narrow), 1)
+        self.assertEqual(narrow[0], 0xFFFF)
+        with self.assertRaises(TypeError):
+            high_ids.tokenize_into("\x01", array("h", [0] * 8))
+        with self.assertRaises(TypeError):
+            tokenizer.tokenize_batch(["apple", 3])
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_hash_engine(self):
+        """engine='hash' (hashed prefix lookup) agrees with the trie walk."""
+        from array import array
+        trie = self.vocab._c_tokenizer
+        hashed = _core.Tokenizer(trie.trie, trie.unk_token_id, engine="hash")
+        self.assertEqual((trie.engine, hashed.engine), ("trie", "hash"))
+
+        texts = ["appleband", b"application b\x00\xff", "bananabandapp" * 40, "a", ""]
+        for text in texts:
+            ids = trie.tokenize(text)
+            self.assertEqual(hashed.tokenize(text), ids)
+            self.assertEqual(hashed.count(text), len(ids))
+            out = array("i", bytes(4 * (len(ids) + 1)))
+            n = hashed.tokenize_into(text, out)
+            self.assertEqual(out[:n].tolist(), ids)
+        self.assertEqual(hashed.tokenize_batch(texts), trie.tokenize_batch(texts))
+
+        long_trie = _core.build_trie(["x" * 17])
+        with self.assertRaises(ValueError):
+            _core.Tokenizer(long_trie, 0, engine="hash")
+        with self.assertRaises(ValueError):
+            _core.Tokenizer(trie.trie, 0, engine="btree")
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_parallel_tokenization(self):
+        """tokenize_parallel cuts only at split-safe bytes and matches tokenize."""
+        tok = self.vocab._c_tokenizer
+        self.assertIn(b" ", _core.split_bytes(tok.trie))
+        text = "applicationbanana band app\n\tbandapple " * 300
+        expected = tok.tokenize(text)
+        for threads in (1, 2, 4):
+            for segment_size in (0, 1, 7, 100):
+                self.assertEqual(tok.tokenize_parallel(text, threads, segment_size), expected)
+        self.assertEqual(self.vocab.tokenize_parallel(text, threads=3), expected)
+        self.assertEqual(tok.tokenize_parallel(""), [])
+
+        # A space inside a token makes it unsafe; cutting there would split "a b"
+        spaced = CrayonVocab(["a b", "a", "b", "\t\n\x0b\x0c\r"])
+        self.assertEqual(_core.split_bytes(spaced._c_tokenizer.trie), b"\t")
+        text = "a ba b\ta b " * 200
+        self.assertEqual(spaced._c_tokenizer.tokenize_parallel(text, 4, 5), spaced.tokenize(text))
+
+        # No safe byte at all: falls back to one sequential pass
+        blank = CrayonVocab(["a b", "a\tb", "a\nb", "a\x0bb", "a\x0cb", "a\rb"])
+        self.assertEqual(_core.split_bytes(blank._c_tokenizer.trie), b"")
+        text = "a b a\tb a\rb x " * 200
+        self.assertEqual(blank._c_tokenizer.tokenize_parallel(text, 4, 3), blank.tokenize(text))
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_concurrent_tokenization(self):
+        """Threads share one immutable trie; large inputs run without the GIL."""
+        text = "applicationbanana band app " * 2000  # Above the GIL release threshold
+        expected = self.vocab.tokenize(text)
+        results = [None] * 8
+
+        def worker(slot):
+            for _ in range(20):
+                results[slot] = self.vocab.tokenize(text)
+
+        threads = [threading.Thread(target=worker, args=(i,)) for i in range(8)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertTrue(all(r == expected for r in results))
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_concurrent_bpe_cache(self):
+        """Threads share one BPE word cache; every lookup is counted once."""
+        from array import array
+        from crayon.core.tokenizer import pretokenize
+        vocab = CrayonVocab(["<UNK>", "a", "b", "c", " ", "ab", " ab", "abc"])
+        vocab.set_merges([("a", "b"), (" ", "ab"), ("ab", "c")])
+        tok = vocab._bpe_tokenizer
+        text = "abc ab cab ba " * 1000  # Above the GIL release threshold
+        expected = tok.tokenize_bpe(text)
+        words = len(list(pretokenize(text)))
+        results = [None] * 4
+
+        def worker(slot):
+            for _ in range(10):
+                results[slot] = tok.tokenize_bpe(text)
+
+        threads = [threading.Thread(target=worker, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertTrue(all(r == expected for r in results))
+        stats = tok.bpe_cache_stats()
+        self.assertEqual(stats["hits"] + stats["misses"], words * 41)
+        self.assertGreater(stats["hits"], stats["misses"])
+        with self.assertRaises(TypeError):
+            _core.Tokenizer(vocab._c_trie, 0, merges=array("f", [0.0] * 3))
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_shared_trie_handles(self):
+        """share_trie leases are claimed exactly once and keep the trie alive."""
+        handle = self.vocab.share_trie()
+        capsule = _core.attach_trie(handle)
+        with self.assertRaises(ValueError):
+            _core.attach_trie(handle)
+
+        # The attached reference outlives the vocabulary that built it
+        expected = self.vocab.tokenize("appleband")
+        unk_id = self.vocab.unk_token_id
+        del self.vocab
+        self.assertEqual(_core.Tokenizer(capsule, unk_id).tokenize("appleband"), expected)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE and SUBINTERPRETERS, "sub-interpreters unavailable")
+    def test_shared_trie_in_subinterpreter(self):
+        """A sub-interpreter tokenizes with the parent's trie via a handle."""
+        handle = self.vocab.share_trie()
+        tmpdir = tempfile.mkdtemp()
+        self.addCleanup(shutil.rmtree, tmpdir, ignore_errors=True)
+        out_path = os.path.join(tmpdir, "ids.json")
+        interp = SUBINTERPRETERS.create()
+        try:
+            SUBINTERPRETERS.run_string(interp, (
+                "import sys, json\n"
+                f"sys.path[:0] = {sys.path!r}\n"
+                "from crayon.c_ext import _core\n"
+                f"tok = _core.Tokenizer(_core.attach_trie({handle}), {self.vocab.unk_token_id})\n"
+                f"with open({out_path!r}, 'w') as f:\n"
+                "    json.dump(tok.tokenize('appleband'), f)\n"
+            ))
+        finally:
+            SUBINTERPRETERS.destroy(interp)
+        with open(out_path) as f:
+            self.assertEqual(json.load(f), self.vocab.tokenize("appleband"))
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_traversal_stats(self):
+        """get_stats() counts traversal in CRAYON_STATS builds, raises otherwise."""
+        if not _core.STATS_ENABLED:
+            with self.assertRaises(RuntimeError):
+                _core.get_stats()
+            return
+        _core.reset_stats()
+        tokens = self.vocab.tokenize("appleband\x01")
+        stats = _core.get_stats()
+        self.assertEqual(stats["calls"], 1)
+        self.assertEqual(stats["tokens"], len(tokens))
+        self.assertEqual(stats["unk_tokens"], 1)  # Only "\x01" has no match
+        self.assertEqual(sum(stats["depth_histogram"]), len(tokens))
+        self.assertGreaterEqual(stats["steps"], stats["simd_lookups"] + stats["bsearch_lookups"])
+        _core.reset_stats()
+        self.assertEqual(_core.get_stats()["steps"], 0)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_parallel_stats(self):
+        """Counts made on tokenize_parallel worker threads reach get_stats()."""
+        probe = (
+            "from crayon.c_ext import _core\n"
+            "tok = _core.Tokenizer(_core.build_trie(['ab', 'abc', ' ']), 0)\n"
+            "_core.reset_stats()\n"
+            "ids = tok.tokenize_parallel('ab abc ' * 100000, 4, 1000)\n"
+            "assert _core.STATS_ENABLED\n"
+            "assert _core.get_stats()['tokens'] == len(ids), _core.get_stats()['tokens']\n"
+        )
+        if _core.STATS_ENABLED:
+            exec(probe, {})
+            return
+        # Build a CRAYON_STATS copy of the extension and probe it out of process
+        root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        with tempfile.TemporaryDirectory() as work:
+            lib = os.path.join(work, "lib")
+            build = subprocess.run(
+                [sys.executable, "setup.py", "build_ext", "--build-lib", lib,
+                 "--build-temp", os.path.join(work, "tmp")],
+                cwd=root, env={**os.environ, "CRAYON_STATS": "1"},
+                capture_output=True, text=True)
+            if build.returncode != 0:
+                self.skipTest("CRAYON_STATS build failed: " + build.stderr[-200:])
+            result = subprocess.run([sys.executable, "-c", probe], cwd=work,
+                                    env={**os.environ, "PYTHONPATH": lib},
+                                    capture_output=True, text=True)
+            self.assertEqual(result.returncode, 0, result.stderr)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_perf_counters(self):
+        """PerfCounters counts what the host allows, or refuses with OSError."""
+        try:
+            counters = _core.PerfCounters()
+        except OSError:
+            self.skipTest("perf_event_open unavailable")
+        with self.assertRaises(RuntimeError):
+            counters.stop()
+        counters.start()
+        self.vocab.tokenize("appleband" * 100)
+        values = counters.stop()
+        self.assertTrue(set(values) <= {"cycles", "instructions", "l1d_misses",
+                                        "llc_misses", "dtlb_misses", "branch_misses"})
+        self.assertTrue(all(v >= 0 for v in values.values()))
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_runtime_metrics(self):
+        """The metrics registry sums per-thread shards and exports Prometheus text."""
+        from crayon import metrics
+        vocab = CrayonVocab(self.vocab_list + ["<UNK>"], unk_token="<UNK>")
+        tokenizer = vocab._c_tokenizer
+        metrics.enable()
+        try:
+            metrics.reset()
+            threads = [threading.Thread(target=lambda: [tokenizer.tokenize("appleband\x01")
+                                                        for _ in range(50)])
+                       for _ in range(4)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+            tokenizer.count("appleband")
+            snap = metrics.snapshot()
+        finally:
+            metrics.disable()
+
+        tokenize = snap["tokenize"]
+        self.assertEqual(tokenize["calls"], 200)
+        self.assertEqual(tokenize["bytes_in"], 200 * 10)
+        self.assertEqual(tokenize["tokens_out"], 200 * 3)
+        self.assertEqual(tokenize["unk_tokens"], 200)
+        self.assertEqual(sum(c for _, _, c in tokenize["latency"]), 200)
+        self.assertEqual(snap["count"]["calls"], 1)
+
+        text = metrics.prometheus_text()
+        self.assertIn('crayon_calls_total{entry="tokenize"} 200', text)
+        self.assertIn('crayon_call_duration_seconds_bucket{entry="tokenize",le="+Inf"} 200', text)
+
+        # Disabled: nothing is recorded
+        vocab.tokenize("apple")
+        self.assertEqual(metrics.snapshot()["tokenize"]["calls"], 200)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_sampling_profiler(self):
+        """Sampled calls land in the outlier ring keyed by input hash."""
+        from crayon import metrics
+        tokenizer = CrayonVocab(self.vocab_list + ["<UNK>"], unk_token="<UNK>")._c_tokenizer
+        docs = ["applicationband", b"app\xffband", "banana"]
+        try:
+            metrics.enable_profiler(sample_every=1)
+            for doc in docs:
+                tokenizer.tokenize(doc)
+            records = metrics.dump_outliers(clear=True)
+            self.assertEqual(len(records), 3)
+            for rec, doc in zip(records, docs):
+                self.assertEqual(rec["hash"], _core.xxh64(doc))
+                self.assertEqual(rec["entry"], "tokenize")
+                self.assertGreaterEqual(rec["lookahead_bytes"], rec["bytes"] - rec["unk_tokens"])
+            self.assertEqual([r["invalid_utf8"] for r in records], [False, True, False])
+            self.assertEqual(records[1]["unk_tokens"], 1)
+            self.assertEqual([d for _, d in metrics.match_outliers(records, docs)], docs)
+
+            # Every other call, into a ring that holds two
+            metrics.enable_profiler(sample_every=2, capacity=2)
+            for _ in range(10):
+                tokenizer.tokenize("band")
+            stats = metrics.profiler_stats()
+            self.assertEqual((stats["sampled"], stats["outliers"], stats["overwritten"]), (5, 5, 3))
+            self.assertEqual(len(metrics.dump_outliers()), 2)
+
+            # A threshold nothing reaches keeps the ring empty
+            metrics.enable_profiler(sample_every=1, lookahead_per_token=1000)
+            tokenizer.tokenize("banana")
+            self.assertEqual(metrics.dump_outliers(), [])
+        finally:
+            metrics.disable_profiler()
+        self.assertEqual(metrics.profiler_stats()["sample_every"], 0)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_vocab_image_round_trip(self):
+        """Binary images and shared-memory attach reproduce the vocabulary."""
+        text = "applicationbandapp\x01banana"
+        expected = self.vocab.tokenize(text)
+        tmpdir = tempfile.mkdtemp()
+        self.addCleanup(shutil.rmtree, tmpdir, ignore_errors=True)
+        path = os.path.join(tmpdir, "vocab.img")
+        self.vocab.save(path, format="image")
+        loaded = CrayonVocab.from_image(path)
+        self.assertEqual(loaded.id_to_token, self.vocab.id_to_token)
+        self.assertEqual(loaded.unk_token, "<UNK>")
+        self.assertEqual(loaded.tokenize(text), expected)
+
+        shm = self.vocab.to_shared_memory()
+        try:
+            attached = CrayonVocab.from_shared_memory(shm.name)
+            self.assertEqual(attached.tokenize(text), expected)
+            # A worker that attaches and exits leaves the segment in place
+            worker = subprocess.run(
+                [sys.executable, "-c",
+                 "import sys; from crayon.core.vocabulary import CrayonVocab; "
+                 "CrayonVocab.from_shared_memory(sys.argv[1])", shm.name],
+                env={**os.environ, "PYTHONPATH": os.pathsep.join(sys.path)},
+                capture_output=True, text=True)
+            self.assertEqual(worker.returncode, 0, worker.stderr)
+            self.assertNotIn("leaked", worker.stderr)
+            attached = CrayonVocab.from_shared_memory(shm.name)
+            self.assertEqual(attached.tokenize(text), expected)
+        finally:
+            shm.close()
+            shm.unlink()
+
+        image = bytearray(self.vocab.to_image())
+        root = image.index(b"CRYTRIE1") + 16
+        image[root + 4:root + 6] = b"\xff\xff"  # Root child_count out of range
+        with self.assertRaises(ValueError):
+            CrayonVocab._from_image_buffer(memoryview(image))
+        with self.assertRaises(ValueError):
+            _core.load_trie(b"CRYTRIE1" + bytes(4))
+
+
+class TestNativeCorpusReaders(unittest.TestCase):
+
+    def setUp(self):
+        self.vocab_tokens = ["<UNK>", "a", "b", "ab", "\"", ",", "\n", "\r", "é", "😀"]
+        self.vocab = CrayonVocab(self.vocab_tokens)
+        self.tmpdir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir, ignore_errors=True)
+
+    def _write(self, name, content):
+        path = os.path.join(self.tmpdir, name)
+        with open(path, 'w', encoding='utf-8', newline='') as f:
+            f.write(content)
+        return path
+
+    def _expected(self, values):
+        ids, offsets = [], [0]
+        for value in values:
+            ids.extend(self.vocab.tokenize(value))
+            offsets.append(len(ids))
+        return ids, offsets
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_jsonl_field_unescaping(self):
+        """JSONL escapes (incl. surrogate pairs) decode exactly like json.loads."""
+        lines = [
+            {"q": "ab\"a,b\nab", "x": [1, {"q": "no"}]},
+            {"x": "skip", "meta": {"q": "nested"}, "q": "é\U0001F600b"},
+            {"q": 42},
+            {"other": "missing"},
+        ]
+        path = self._write("d.jsonl", "\n".join(json.dumps(l) for l in lines) + "\nnot json\n")
+
+        ids, offsets = tokenize_local_dataset(path, "q", self.vocab)
+        expected = self._expected([lines[0]["q"], lines[1]["q"]])
+        self.assertEqual((list(ids), list(offsets)), expected)
+
+        ids, offsets = tokenize_local_dataset(path, "meta.q", self.vocab)
+        self.assertEqual((list(ids), list(offsets)), self._expected(["nested"]))
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_csv_column_quoting(self):
+        """Quoted CSV fields with embedded quotes, commas and newlines."""
+        path = self._write(
+            "d.csv",
+            'id,text\r\n1,ab\r\n2,"a ""b"", \nab"\r\n\r\n3,\n4,"é,😀"\n'
+        )
+        ids, offsets = tokenize_local_dataset(path, "text", self.vocab, max_records=2)
+        self.assertEqual((list(ids), list(offsets)), self._expected(["ab", 'a "b", \nab']))
+
+        ids, offsets = tokenize_local_dataset(path, "text", self.vocab)
+        self.assertEqual(len(offsets) - 1, 3)
+
+        with self.assertRaises(KeyError):
+            tokenize_local_dataset(path, "missing", self.vocab)
+
+    @unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+    def test_native_matches_python_fallback(self):
+        """Native readers and the stdlib fallback yield the same shards."""
+        fallback = CrayonVocab(self.vocab_tokens)
+        fallback._c_ext_available = False
+        csv_path = self._write("p.csv", 'text,n\r\n"a\r\nb",1\r\nab\r\n"b\rb\n"\r\n')
+        jsonl_path = self._write("p.jsonl", "\n".join([
+            '{"q": "a", "q": "b"}',
+            '{"q": "ab", "q": 1}',
+            '{"m": {"q": "a"}, "m": {"x": "b"}}',
+            '{"m": {"q": "a", "q": "ab"}, "q": "b", "q": "ab"}',
+            '{"q": "a", "q": "b"',
+        ]) + "\n")
+        for path, field, values in [
+            (csv_path, "text", ["a\r\nb", "ab", "b\rb\n"]),
+            (jsonl_path, "q", ["b", "ab"]),
+            (jsonl_path, "m.q", ["ab"]),
+        ]:
+            native = tokenize_local_dataset(path, field, self.vocab)
+            python = tokenize_local_dataset(path, field, fallback)
+            expected = self._expected(values)
+            self.assertEqual((list(native[0]), list(native[1])), expected, (path, field))
+            self.assertEqual((list(python[0]), list(python[1])), expected, (path, field))
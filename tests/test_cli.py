@@ -0,0 +1,132 @@
+"""
+crayon-tokenize (tools/crayon_tokenize.c) and libcrayon against
+CrayonVocab.tokenize.
+
+Both are built by CMake, not setup.py, so these tests run only when a
+binary is found: $CRAYON_TOKENIZE / $CRAYON_LIBRARY, or the build output
+in build/ or _gate_build/. tests/native/test_cli.cmake covers chunking
+under ctest.
+"""
+
+import ctypes
+import os
+import random
+import shutil
+import subprocess
+import tempfile
+import unittest
+from array import array
+
+from crayon.core.vocabulary import CrayonVocab
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def find_cli():
+    candidates = [os.environ.get("CRAYON_TOKENIZE", "")]
+    candidates += [os.path.join(ROOT, d, "crayon-tokenize") for d in ("build", "_gate_build")]
+    for path in candidates:
+        if path and os.access(path, os.X_OK):
+            return path
+    return None
+
+
+def find_library():
+    candidates = [os.environ.get("CRAYON_LIBRARY", "")]
+    candidates += [os.path.join(ROOT, d, "libcrayon.so") for d in ("build", "_gate_build")]
+    for path in candidates:
+        if path and os.path.exists(path):
+            return path
+    return None
+
+
+CLI = find_cli()
+LIBRARY = find_library()
+
+
+@unittest.skipUnless(CLI, "crayon-tokenize not built")
+class TestTokenizeCli(unittest.TestCase):
+
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+        rng = random.Random(92)
+        # No whitespace-only tokens: the text format strips them on load
+        words = ["token", "tok", "izer", "ization", "a b", "é", "😀", "<UNK>"]
+        self.vocab = CrayonVocab(words)
+        self.text = "".join(rng.choice(words[:-1] + [" ", "\n", "z", "ü"]) for _ in range(5000))
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp)
+
+    def run_cli(self, vocab_path, *args, stdin=None):
+        result = subprocess.run([CLI, "-q", "-v", vocab_path, *args], input=stdin,
+                                capture_output=True, check=True)
+        return result.stdout
+
+    def test_matches_python(self):
+        expected = self.vocab.tokenize(self.text)
+        corpus = os.path.join(self.tmp, "corpus.txt")
+        with open(corpus, "w", encoding="utf-8") as f:
+            f.write(self.text)
+
+        image = os.path.join(self.tmp, "vocab.bin")
+        lines = os.path.join(self.tmp, "vocab.txt")
+        self.vocab.save(image, format="image")
+        self.vocab.save(lines, format="txt")
+
+        for vocab_path in (image, lines):
+            for threads in ("1", "3"):
+                ids = array("H")
+                ids.frombytes(self.run_cli(vocab_path, "-t", threads, "--chunk-size", "37", corpus))
+                self.assertEqual(list(ids), expected)
+
+        # stdin, text output
+        out = self.run_cli(image, "-f", "text", "--chunk-size", "50", stdin=self.text.encode("utf-8"))
+        self.assertEqual([int(x) for x in out.split()], expected)
+
+
+@unittest.skipUnless(LIBRARY, "libcrayon not built")
+class TestLibcrayon(unittest.TestCase):
+
+    def setUp(self):
+        self.lib = ctypes.CDLL(LIBRARY)
+        self.lib.crayon_load_image.argtypes = [ctypes.c_char_p, ctypes.c_size_t,
+                                               ctypes.POINTER(ctypes.c_void_p)]
+        self.lib.crayon_tokenize.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t,
+                                             ctypes.c_int32, ctypes.POINTER(ctypes.c_int32),
+                                             ctypes.c_size_t, ctypes.c_void_p]
+        self.lib.crayon_tokenize.restype = ctypes.c_size_t
+        self.lib.crayon_free.argtypes = [ctypes.c_void_p]
+
+    def tokenize(self, image, text):
+        trie = ctypes.c_void_p()
+        self.assertEqual(self.lib.crayon_load_image(image, len(image), ctypes.byref(trie)), 0)
+        data = text.encode("utf-8")
+        out = (ctypes.c_int32 * max(len(data), 1))()
+        n = self.lib.crayon_tokenize(trie, data, len(data), 0, out, len(data), None)
+        self.lib.crayon_free(trie)
+        return out[:n]
+
+    def test_load_saved_vocab_image(self):
+        """crayon_load_image accepts CrayonVocab.save(format="image") output."""
+        vocab = CrayonVocab(["<UNK>", "token", "tok", "izer", "é", "a b"])
+        text = "tokenizer a b é tokz" * 50
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "vocab.bin")
+            vocab.save(path, format="image")
+            with open(path, "rb") as f:
+                image = f.read()
+        self.assertEqual(image[:8], b"CRYNVOC1")
+        self.assertEqual(self.tokenize(image, text), vocab.tokenize(text))
+
+        # Saved without a compiled trie: rebuilt from the tokens
+        c_trie, vocab._c_trie = vocab._c_trie, None
+        try:
+            bare = vocab.to_image()
+        finally:
+            vocab._c_trie = c_trie
+        self.assertEqual(self.tokenize(bare, text), vocab.tokenize(text))
+
+
+if __name__ == "__main__":
+    unittest.main()
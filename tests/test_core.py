@@ -20,6 +20,112 @@ class TestCoreTokenization(unittest.TestCase):
         # 'unfortunate' is in vocab, so it should be picked over 'un' + 'fortunate'
         self.assertEqual(resolved_tokens, ["unfortunate", "ly"])
 
+    def test_optimal_segmentation(self):
+        """tokenize_optimal beats greedy where a long first token costs later."""
+        vocab = CrayonVocab(["a", "ab", "bcd", "c", "d", "<UNK>"], unk_token="<UNK>")
+        fallback = CrayonVocab(["a", "ab", "bcd", "c", "d", "<UNK>"], unk_token="<UNK>")
+        fallback._c_ext_available = False
+        for v in (vocab, fallback):
+            names = lambda ids: [v.id_to_token[i] for i in ids]
+            self.assertEqual(names(v.tokenize("abcd")), ["ab", "c", "d"])
+            self.assertEqual(names(v.tokenize_optimal("abcd")), ["a", "bcd"])
+            self.assertEqual(names(v.tokenize_optimal("abxcd")), ["ab", "<UNK>", "c", "d"])
+            self.assertEqual(v.tokenize_optimal(""), [])
+            # Scores: a strongly disfavoured bcd makes ab + c + d the best path
+            scores = [-1.0, -1.0, -50.0, -1.0, -1.0, -1.0]
+            self.assertEqual(names(v.tokenize_optimal("abcd", scores)), ["ab", "c", "d"])
+
+    def test_sampled_segmentation(self):
+        """tokenize_sampled follows the unigram distribution of the scores."""
+        import math
+        from collections import Counter
+        tokens = ["a", "ab", "b", "bc", "c", "<UNK>"]
+        probs = [0.3, 0.1, 0.2, 0.2, 0.2, 1e-9]
+        scores = [math.log(p) for p in probs]
+        vocab = CrayonVocab(tokens, unk_token="<UNK>", scores=scores)
+        fallback = CrayonVocab(tokens, unk_token="<UNK>", scores=scores)
+        fallback._c_ext_available = False
+        # "abc": a+b+c .012, ab+c .02, a+bc .06
+        expected = {("a", "b", "c"): 0.012, ("ab", "c"): 0.02, ("a", "bc"): 0.06}
+        total = sum(expected.values())
+        for v in (vocab, fallback):
+            names = lambda ids: tuple(v.id_to_token[i] for i in ids)
+            self.assertEqual(names(v.tokenize_optimal("abc")), ("a", "bc"))
+            self.assertEqual(v.tokenize_sampled("abcabc", seed=7), v.tokenize_sampled("abcabc", seed=7))
+            self.assertEqual(names(v.tokenize_sampled("xa")), ("<UNK>", "a"))
+            draws = Counter(names(v.tokenize_sampled("abc")) for _ in range(4000))
+            self.assertEqual(set(draws), set(expected))
+            for seg, p in expected.items():
+                self.assertAlmostEqual(draws[seg] / 4000, p / total, delta=0.04)
+            # alpha = 0: uniform over the three segmentations
+            draws = Counter(names(v.tokenize_sampled("abc", alpha=0.0)) for _ in range(3000))
+            for seg in expected:
+                self.assertAlmostEqual(draws[seg] / 3000, 1 / 3, delta=0.05)
+
+        # Scores travel with the compiled trie through the binary image
+        if vocab._c_ext_available:
+            loaded = CrayonVocab._from_image_buffer(memoryview(vocab.to_image()))
+            self.assertEqual(list(loaded.scores), list(vocab.scores))
+            self.assertEqual(loaded.tokenize_sampled("abcabc", seed=3),
+                             vocab.tokenize_sampled("abcabc", seed=3))
+
+    def test_bpe_encoding(self):
+        """tokenize_bpe matches a naive lowest-rank-first BPE on random merges."""
+        import random
+        from crayon.core.tokenizer import pretokenize
+
+        def naive(word, ranks):
+            symbols = list(word)
+            while True:
+                pairs = [(ranks[(a, b)], i) for i, (a, b) in enumerate(zip(symbols, symbols[1:]))
+                         if (a, b) in ranks]
+                if not pairs:
+                    return symbols
+                _, i = min(pairs)
+                symbols[i:i + 2] = [symbols[i] + symbols[i + 1]]
+
+        rng = random.Random(5)
+        for _ in range(20):
+            # "Train" merges by joining random adjacent symbols of a sample
+            sample = "".join(rng.choice("aab c1.") for _ in range(200))
+            tokens = ["<UNK>"] + sorted(set(sample) - {"."})
+            merges = []
+            words = [list(w) for w in pretokenize(sample)]
+            for _ in range(rng.randint(0, 25)):
+                pairs = [(a, b) for w in words for a, b in zip(w, w[1:])
+                         if a in tokens and b in tokens]
+                if not pairs:
+                    break
+                a, b = rng.choice(pairs)
+                if (a, b) not in merges:
+                    merges.append((a, b))
+                    if a + b not in tokens:
+                        tokens.append(a + b)
+                for w in words:
+                    i = 0
+                    while i < len(w) - 1:
+                        if (w[i], w[i + 1]) == (a, b):
+                            w[i:i + 2] = [a + b]
+                        i += 1
+            ranks = {pair: r for r, pair in reversed(list(enumerate(merges)))}
+
+            vocab = CrayonVocab(tokens)
+            vocab.set_merges(merges)
+            fallback = CrayonVocab(tokens)
+            fallback.set_merges(merges)
+            fallback._c_ext_available = False
+            text = "".join(rng.choice("aab c1.\n") for _ in range(300))
+            expected = []
+            for word in pretokenize(text):
+                expected += [vocab.token_to_id.get(t, vocab.unk_token_id) for t in naive(word, ranks)]
+            self.assertEqual(vocab.tokenize_bpe(text), expected)
+            self.assertEqual(fallback.tokenize_bpe(text), expected)
+            self.assertEqual(vocab.tokenize_bpe(text), expected)  # Served from the word cache
+
+        self.assertEqual(list(pretokenize("hi  there\n x")), ["hi", " ", " there", "\n", " x"])
+        with self.assertRaises(ValueError):
+            CrayonVocab(["a"]).set_merges([("a", "b")])
+
     def test_unknown_token_fallback(self):
         """Verify <UNK> handling."""
         text = "unfortunatxely"  # 'x' is unknown
@@ -0,0 +1,173 @@
+"""
+Differential tests: every tokenizer engine must be bit-identical to the
+reference crayon_tokenize_fast.
+
+Random vocabularies and inputs (invalid UTF-8, chunk boundaries and
+inputs above the GIL release threshold included) are run through each
+engine (trie and hashed-prefix matchers, the parallel splitter), and the IDs and byte offsets are checked against a brute-force
+oracle that never touches a trie. The Hypothesis variant explores and
+shrinks when hypothesis is installed; a seeded random variant always runs.
+The native counterpart for libFuzzer/AFL is tests/fuzz/fuzz_engines.c.
+"""
+
+import random
+import unittest
+from array import array
+
+from crayon.core.vocabulary import CrayonVocab
+
+try:
+    from crayon.c_ext import _core
+    C_EXT_AVAILABLE = True
+except ImportError:
+    C_EXT_AVAILABLE = False
+
+try:
+    from hypothesis import HealthCheck, given, settings, strategies as st
+    HYPOTHESIS_AVAILABLE = True
+except ImportError:
+    HYPOTHESIS_AVAILABLE = False
+
+# Small alphabet (ASCII, multi-byte UTF-8, emoji) so tokens overlap and nest
+ALPHABET = "abc \né€😀"
+GIL_RELEASE_THRESHOLD = 4096
+
+
+def oracle_spans(tokens, data: bytes, unk_id: int):
+    """Greedy longest match by brute force: [(id, start, end)]."""
+    encoded = [t.encode("utf-8") for t in tokens]
+    spans, pos = [], 0
+    while pos < len(data):
+        best_id, best_len = unk_id, 0
+        for i, tok in enumerate(encoded):
+            # Later duplicates win, as in the trie builder
+            if tok and len(tok) >= best_len and data.startswith(tok, pos):
+                best_id, best_len = i, len(tok)
+        step = best_len or 1
+        spans.append((best_id, pos, pos + step))
+        pos += step
+    return spans
+
+
+def spans_from_ids(ids, tokens, unk_id: int):
+    """Byte offsets implied by an ID stream (UNK covers one byte)."""
+    spans, pos = [], 0
+    for i in ids:
+        step = 1 if i == unk_id else len(tokens[i].encode("utf-8"))
+        spans.append((i, pos, pos + step))
+        pos += step
+    return spans
+
+
+def check_engines(test: unittest.TestCase, tokens, data: bytes) -> None:
+    unk_id = len(tokens)  # Never collides with a real token
+    trie = _core.build_trie(list(tokens))
+    expected = oracle_spans(tokens, data, unk_id)
+    ids = [s[0] for s in expected]
+
+    reference = _core.crayon_tokenize_fast(data, trie, unk_id)
+    test.assertEqual(spans_from_ids(reference, tokens, unk_id), expected, "reference")
+
+    tokenizer = _core.Tokenizer(trie, unk_id)
+    test.assertEqual(tokenizer.tokenize(data), ids, "tokenize(bytes)")
+    test.assertEqual(tokenizer.count(data), len(ids), "count")
+    out = array("i", bytes(4 * max(len(data), 1)))
+    n = tokenizer.tokenize_into(data, out)
+    test.assertEqual(out[:n].tolist(), ids, "tokenize_into")
+
+    # Chunks cut on oracle token boundaries concatenate to the whole
+    cuts = sorted({expected[i][1] for i in range(0, len(expected), 3)} | {len(data)})
+    chunks = [data[a:b] for a, b in zip([0] + cuts, cuts) if b > a]
+    batched = tokenizer.tokenize_batch(chunks)
+    test.assertEqual([i for part in batched for i in part], ids, "tokenize_batch chunks")
+
+    image_trie = _core.load_trie(_core.serialize_trie(trie))
+    test.assertEqual(_core.Tokenizer(image_trie, unk_id).tokenize(data), ids, "image")
+
+    engines = [("trie", tokenizer)]
+    if max((len(t.encode("utf-8")) for t in tokens), default=0) <= 16:
+        hashed = _core.Tokenizer(trie, unk_id, engine="hash")
+        test.assertEqual(hashed.tokenize(data), ids, "hash")
+        engines.append(("hash", hashed))
+
+    # Cuts only before whitespace that no token has past its first byte
+    safe = bytes(b for b in b"\t\n\x0b\x0c\r " if not any(
+        bytes([b]) in t.encode("utf-8")[1:] for t in tokens))
+    test.assertEqual(_core.split_bytes(trie), safe, "split_bytes")
+    for name, engine in engines:
+        for threads, segment_size in ((1, 1), (2, 1), (3, 7), (4, 64)):
+            test.assertEqual(engine.tokenize_parallel(data, threads, segment_size), ids,
+                             f"tokenize_parallel {name} x{threads}/{segment_size}")
+
+    try:
+        text = data.decode("utf-8")
+    except UnicodeDecodeError:
+        return
+    test.assertEqual(tokenizer.tokenize(text), ids, "tokenize(str)")
+    if text.isascii() and all(t.isascii() for t in tokens):
+        # The Python fallback walks code points, so it only agrees on ASCII
+        vocab = CrayonVocab(list(tokens), unk_token="\x00<unk>")
+        vocab._c_ext_available = False
+        fallback = vocab.tokenize(text)
+        vocab._c_ext_available = True
+        test.assertEqual(fallback, vocab.tokenize(text), "python fallback")
+
+
+def random_case(rng: random.Random):
+    tokens = ["".join(rng.choice(ALPHABET) for _ in range(rng.randint(1, 6)))
+              for _ in range(rng.randint(0, 40))]
+    pieces = tokens + list(ALPHABET)
+    text = "".join(rng.choice(pieces) for _ in range(rng.randint(0, 200))) if pieces else ""
+    data = text.encode("utf-8")
+    if rng.random() < 0.3:
+        # Corrupt a few bytes: lone continuations, truncated sequences
+        raw = bytearray(data)
+        for _ in range(rng.randint(1, 4)):
+            raw.insert(rng.randint(0, len(raw)), rng.choice([0x80, 0xBF, 0xC3, 0xE2, 0xF0, 0xFF]))
+        data = bytes(raw)
+    if rng.random() < 0.1:
+        data *= GIL_RELEASE_THRESHOLD // max(len(data), 1) + 1
+    return tokens, data
+
+
+@unittest.skipUnless(C_EXT_AVAILABLE, "C extension not compiled")
+class TestDifferentialEngines(unittest.TestCase):
+
+    def test_seeded_random_cases(self):
+        """Engines agree with the oracle on seeded random vocabularies and inputs."""
+        rng = random.Random(88)
+        cut_kinds = set()
+        for _ in range(300):
+            tokens, data = random_case(rng)
+            check_engines(self, tokens, data)
+            cut_kinds.add(any(ch in " \n" for t in tokens for ch in t[1:]))
+        # Vocabularies with every cut byte safe and with some made unsafe
+        self.assertEqual(cut_kinds, {False, True})
+
+    @unittest.skipUnless(HYPOTHESIS_AVAILABLE, "hypothesis not installed")
+    def test_hypothesis_engines(self):
+        """Hypothesis-driven search for an engine that diverges from the oracle."""
+        token = st.text(alphabet=ALPHABET, min_size=1, max_size=8)
+
+        @st.composite
+        def cases(draw):
+            tokens = draw(st.lists(token, max_size=40))
+            pieces = st.sampled_from(tokens + list(ALPHABET))
+            text = "".join(draw(st.lists(pieces, max_size=120)))
+            data = draw(st.one_of(st.just(text.encode("utf-8")), st.binary(max_size=200),
+                                  st.builds(lambda t, b: t.encode("utf-8") + b + t.encode("utf-8"),
+                                            st.just(text), st.binary(max_size=4))))
+            if draw(st.booleans()) and draw(st.booleans()) and draw(st.booleans()):
+                data *= GIL_RELEASE_THRESHOLD // max(len(data), 1) + 1
+            return tokens, data
+
+        @settings(max_examples=300, deadline=None, suppress_health_check=list(HealthCheck))
+        @given(cases())
+        def run(case):
+            check_engines(self, *case)
+
+        run()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -2,8 +2,10 @@ import unittest
 import os
 import gc
 import tempfile
+import threading
 from crayon.memory.pool import MemoryPool
 from crayon.memory.zerocopy import ZeroCopyTokenizer
+from crayon.memory.disk_cache import PersistentTokenCache
 from crayon.core.vocabulary import CrayonVocab
 
 class TestMemorySubsystem(unittest.TestCase):
@@ -59,4 +61,80 @@ class TestMemorySubsystem(unittest.TestCase):
         
         # Return it - should not be added to pool
         pool.return_buffer(big_buf)
-        self.assertEqual(len(pool.available_buffers), 2)  # Original pool unchanged
\ No newline at end of file
+        self.assertEqual(len(pool.available_buffers), 2)  # Original pool unchanged
+
+    def test_persistent_cache_hits_across_instances(self):
+        """Cached token arrays survive reopening and match fresh tokenization."""
+        vocab = CrayonVocab(["test", " ", "café"])
+        with tempfile.TemporaryDirectory() as cache_dir:
+            with PersistentTokenCache(cache_dir, vocab, max_bytes=1 << 20, slot_count=64) as cache:
+                first = cache.tokenize("test café test")
+                self.assertEqual(list(first), vocab.tokenize("test café test"))
+                self.assertEqual(cache.misses, 1)
+                del first
+
+            with PersistentTokenCache(cache_dir, vocab, max_bytes=1 << 20, slot_count=64) as cache:
+                hit = cache.get("test café test")
+                self.assertIsNotNone(hit)
+                self.assertEqual(list(hit), vocab.tokenize("test café test"))
+                # Same content as bytes hits the same entry
+                self.assertIsNotNone(cache.get("test café test".encode("utf-8")))
+                del hit
+
+            # A different vocabulary never sees these entries
+            other = CrayonVocab(["test", " "])
+            with PersistentTokenCache(cache_dir, other, max_bytes=1 << 20, slot_count=64) as cache:
+                self.assertIsNone(cache.get("test café test"))
+
+    def test_persistent_cache_size_bounded_eviction(self):
+        """Rotation keeps at most two generations on disk."""
+        vocab = CrayonVocab(["test", " "])
+        with tempfile.TemporaryDirectory() as cache_dir:
+            with PersistentTokenCache(cache_dir, vocab, max_bytes=4096, slot_count=16) as cache:
+                for i in range(200):
+                    cache.tokenize("test " * (i % 7 + 1) + str(i))
+                segments = [n for n in os.listdir(cache_dir) if n.endswith(".seg")]
+                self.assertLessEqual(len(segments), 2)
+                # The most recent document is still cached
+                self.assertIsNotNone(cache.get("test " * (199 % 7 + 1) + "199"))
+
+    def test_persistent_cache_shared_by_threads(self):
+        """get and put from two threads survive rotations; misses follow HEAD."""
+        vocab = CrayonVocab(["test", " "])
+        with tempfile.TemporaryDirectory() as cache_dir:
+            with PersistentTokenCache(cache_dir, vocab, max_bytes=4096, slot_count=16) as cache:
+                docs = ["test " * (i % 7 + 1) + str(i) for i in range(300)]
+                errors = []
+
+                def writer():
+                    try:
+                        for doc in docs:
+                            cache.put(doc, vocab.tokenize(doc))
+                    except Exception as exc:
+                        errors.append(exc)
+
+                def reader():
+                    try:
+                        for doc in docs * 2:
+                            hit = cache.get(doc)
+                            if hit is not None and list(hit) != vocab.tokenize(doc):
+                                errors.append(doc)
+                    except Exception as exc:
+                        errors.append(exc)
+
+                threads = [threading.Thread(target=writer), threading.Thread(target=reader)]
+                for t in threads:
+                    t.start()
+                for t in threads:
+                    t.join()
+                self.assertEqual(errors, [])
+
+                # Another instance rotates past the generations this one holds
+                with PersistentTokenCache(cache_dir, vocab, max_bytes=4096, slot_count=16) as other:
+                    for doc in docs:
+                        other.put(doc, vocab.tokenize(doc))
+                    other.put("test new", vocab.tokenize("test new"))
+                    generation = other._generation
+                self.assertNotEqual(cache._generation, generation)
+                self.assertEqual(list(cache.get("test new")), vocab.tokenize("test new"))
+                self.assertEqual(cache._generation, generation)
@@ -0,0 +1,678 @@
+/*
+ * crayon-tokenize: stream text through libcrayon and write token IDs.
+ *
+ *   crayon-tokenize --vocab v.bin < corpus.txt > ids.u16
+ *   crayon-tokenize -v vocab.txt -t 8 -o ids -f u32 --shard-size 1G a.txt b.txt
+ *
+ * Regular files are memory-mapped; pipes are read in blocks. Each block is
+ * cut into one chunk per thread and every chunk is tokenized independently
+ * from its own start. Greedy longest match is memoryless (the token at p
+ * depends only on the bytes from p on), so a chunk's IDs are exact from the
+ * first token boundary it shares with the exact stream coming from the
+ * previous chunk; the merge finds that boundary (almost always the chunk's
+ * first token, otherwise within a few tokens) and only the tokens before it
+ * are redone serially. Output is byte-identical for any thread count.
+ *
+ * Only crayon.h is used; the tool links libcrayon like any other consumer.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "crayon.h"
+
+typedef enum { FORMAT_AUTO, FORMAT_U16, FORMAT_U32, FORMAT_TEXT } OutputFormat;
+
+typedef struct {
+    crayon_trie* trie;
+    int32_t unk_id;
+    int64_t token_count;        // -1 when the vocabulary file does not say
+    size_t max_len;             // crayon_max_token_length()
+} Vocab;
+
+typedef struct {
+    FILE* file;
+    const char* path;           // NULL = stdout
+    size_t shard_size;          // 0 = single output
+    size_t shard_written;
+    unsigned shard_index;
+    size_t record;              // Bytes per ID (0 for text: cut at newlines)
+} Writer;
+
+// One chunk of a block: tokenized by its own thread, merged in order
+typedef struct {
+    const Vocab* vocab;
+    OutputFormat format;
+    const char* text;           // Chunk start
+    size_t span;                // Bytes owned by this chunk
+    size_t available;           // Bytes readable from text (span + lookahead)
+    int32_t* ids;
+    size_t* offsets;
+    size_t capacity;
+    size_t kept;                // Tokens starting inside span
+    size_t next;                // Where the token after the last kept one starts
+    uint8_t* out;               // kept IDs, formatted
+    size_t out_length;
+    size_t out_capacity;
+    int error;
+} Chunk;
+
+typedef struct {
+    Vocab vocab;
+    OutputFormat format;
+    int threads;
+    size_t chunk_size;
+    Chunk* chunks;
+    Writer writer;
+    int progress;
+    int quiet;
+    uint64_t bytes_in;
+    uint64_t tokens_out;
+    double started;
+    double last_report;
+} Context;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void die(const char* message, const char* detail) {
+    fprintf(stderr, "crayon-tokenize: %s%s%s\n", message, detail ? ": " : "", detail ? detail : "");
+    exit(1);
+}
+
+static void* xmalloc(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) die("out of memory", NULL);
+    return ptr;
+}
+
+// ----------------------------------------------------------------------------
+// Vocabulary loading
+// ----------------------------------------------------------------------------
+
+static uint8_t* read_file(const char* path, size_t* length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) die(strerror(errno), path);
+    size_t capacity = 1 << 16, used = 0;
+    uint8_t* data = (uint8_t*)xmalloc(capacity);
+    for (;;) {
+        used += fread(data + used, 1, capacity - used, f);
+        if (used < capacity) break;
+        capacity *= 2;
+        uint8_t* grown = (uint8_t*)realloc(data, capacity);
+        if (!grown) die("out of memory", NULL);
+        data = grown;
+    }
+    if (ferror(f)) die(strerror(errno), path);
+    fclose(f);
+    *length = used;
+    return data;
+}
+
+static uint64_t read_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint32_t read_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void build_or_die(Vocab* vocab, const char* const* tokens, const size_t* lengths,
+                         size_t count, const char* path) {
+    int rc = crayon_build(tokens, lengths, count, &vocab->trie);
+    if (rc != CRAYON_OK) die(rc == CRAYON_ENOMEM ? "out of memory" : "cannot build vocabulary", path);
+    vocab->token_count = (int64_t)count;
+}
+
+/*
+ * CrayonVocab.save(format="image"): crayon_load_image() unwraps the trie
+ * (or rebuilds it from the tokens); only the UNK ID and token count are
+ * read from the header here.
+ */
+static void load_vocab_image(Vocab* vocab, const uint8_t* data, size_t length,
+                             const char* path, int have_unk_id) {
+    if (length < 48 || read_u32(data + 8) != 1) die("unsupported vocabulary image", path);
+    int rc = crayon_load_image(data, length, &vocab->trie);
+    if (rc != CRAYON_OK) die(rc == CRAYON_ENOMEM ? "out of memory" : "corrupt vocabulary image", path);
+    if (!have_unk_id) vocab->unk_id = (int32_t)read_u64(data + 16);
+    vocab->token_count = (int64_t)read_u64(data + 24);
+}
+
+static int is_space(uint8_t c) {
+    // str.strip() whitespace within ASCII (includes the \x1c-\x1f separators)
+    return c == ' ' || (c >= '\t' && c <= '\r') || (c >= 0x1C && c <= 0x1F);
+}
+
+/*
+ * One token per line, stripped, blank lines skipped (CrayonVocab.from_file).
+ * The UNK ID is the last line equal to unk_token, else 0.
+ */
+static void load_vocab_lines(Vocab* vocab, uint8_t* data, size_t length, const char* path,
+                             const char* unk_token, int have_unk_id) {
+    size_t capacity = 1024, count = 0;
+    const char** tokens = (const char**)xmalloc(capacity * sizeof(char*));
+    size_t* lengths = (size_t*)xmalloc(capacity * sizeof(size_t));
+    size_t unk_len = strlen(unk_token);
+    int32_t unk_id = 0;
+
+    size_t pos = 0;
+    while (pos < length) {
+        size_t end = pos;
+        while (end < length && data[end] != '\n') end++;
+        size_t a = pos, b = end;
+        while (a < b && is_space(data[a])) a++;
+        while (b > a && is_space(data[b - 1])) b--;
+        if (b > a) {
+            if (count == capacity) {
+                capacity *= 2;
+                tokens = (const char**)realloc((void*)tokens, capacity * sizeof(char*));
+                lengths = (size_t*)realloc(lengths, capacity * sizeof(size_t));
+                if (!tokens || !lengths) die("out of memory", NULL);
+            }
+            if (b - a == unk_len && memcmp(data + a, unk_token, unk_len) == 0) {
+                unk_id = (int32_t)count;
+            }
+            tokens[count] = (const char*)data + a;
+            lengths[count++] = b - a;
+        }
+        pos = end + 1;
+    }
+    if (!have_unk_id) vocab->unk_id = unk_id;
+    build_or_die(vocab, tokens, lengths, count, path);
+    free((void*)tokens);
+    free(lengths);
+}
+
+static void load_vocab(Vocab* vocab, const char* path, const char* unk_token, int have_unk_id) {
+    size_t length;
+    uint8_t* data = read_file(path, &length);
+    vocab->token_count = -1;
+
+    if (length >= 8 && memcmp(data, "CRYNVOC1", 8) == 0) {
+        load_vocab_image(vocab, data, length, path, have_unk_id);
+    } else if (length >= 8 && memcmp(data, "CRYTRIE1", 8) == 0) {
+        int rc = crayon_load_image(data, length, &vocab->trie);
+        if (rc != CRAYON_OK) die(rc == CRAYON_ENOMEM ? "out of memory" : "corrupt trie image", path);
+    } else {
+        size_t n = strlen(path);
+        if (n >= 5 && strcmp(path + n - 5, ".json") == 0) {
+            die("JSON vocabularies are not read natively; convert with "
+                "CrayonVocab.from_json(path).save(out, format=\"image\")", path);
+        }
+        load_vocab_lines(vocab, data, length, path, unk_token, have_unk_id);
+    }
+    free(data);
+    vocab->max_len = crayon_max_token_length(vocab->trie);
+    if (vocab->max_len == 0) vocab->max_len = 1;
+}
+
+// ----------------------------------------------------------------------------
+// Output
+// ----------------------------------------------------------------------------
+
+static void writer_open_next(Writer* w) {
+    if (!w->path) {
+        w->file = stdout;
+        return;
+    }
+    char name[4096];
+    if (w->shard_size) {
+        snprintf(name, sizeof(name), "%s.%05u", w->path, w->shard_index++);
+    } else {
+        snprintf(name, sizeof(name), "%s", w->path);
+    }
+    w->file = fopen(name, "wb");
+    if (!w->file) die(strerror(errno), name);
+    setvbuf(w->file, NULL, _IOFBF, 1 << 20);
+    w->shard_written = 0;
+}
+
+static void writer_put(Writer* w, const uint8_t* data, size_t length) {
+    if (length && fwrite(data, 1, length, w->file) != length) die("write failed", strerror(errno));
+    w->shard_written += length;
+}
+
+static void writer_close(Writer* w) {
+    if (w->file && w->file != stdout && fclose(w->file) != 0) die("write failed", strerror(errno));
+    if (w->file == stdout && fflush(stdout) != 0) die("write failed", strerror(errno));
+    w->file = NULL;
+}
+
+// Shards are cut between IDs, never inside one
+static void writer_write(Writer* w, const uint8_t* data, size_t length) {
+    while (length) {
+        if (!w->file) writer_open_next(w);
+        if (!w->shard_size || w->shard_written + length <= w->shard_size) {
+            writer_put(w, data, length);
+            return;
+        }
+        size_t room = w->shard_size - w->shard_written;
+        size_t cut;
+        if (w->record) {
+            cut = room - room % w->record;
+        } else {
+            cut = room;
+            while (cut && data[cut - 1] != '\n') cut--;
+        }
+        if (cut == 0 && w->shard_written == 0) {
+            // A single record larger than the shard: let it overflow
+            cut = w->record ? w->record : (size_t)((uint8_t*)memchr(data, '\n', length) - data) + 1;
+        }
+        writer_put(w, data, cut);
+        data += cut;
+        length -= cut;
+        writer_close(w);
+    }
+}
+
+static size_t format_width(OutputFormat format) {
+    return format == FORMAT_U16 ? 2 : format == FORMAT_U32 ? 4 : 11;
+}
+
+// Append IDs in the output format; returns bytes written, or 0 with *error
+static size_t format_ids(OutputFormat format, const int32_t* ids, size_t count,
+                         uint8_t* out, int* error) {
+    uint8_t* p = out;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t id = (uint32_t)ids[i];
+        if (format == FORMAT_U16) {
+            if (id > 0xFFFF) {
+                *error = 1;
+                return 0;
+            }
+            *p++ = (uint8_t)id;
+            *p++ = (uint8_t)(id >> 8);
+        } else if (format == FORMAT_U32) {
+            *p++ = (uint8_t)id;
+            *p++ = (uint8_t)(id >> 8);
+            *p++ = (uint8_t)(id >> 16);
+            *p++ = (uint8_t)(id >> 24);
+        } else {
+            char digits[12];
+            int n = 0;
+            int32_t value = ids[i];
+            uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+            do {
+                digits[n++] = (char)('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+            if (value < 0) *p++ = '-';
+            while (n) *p++ = (uint8_t)digits[--n];
+            *p++ = '\n';
+        }
+    }
+    return (size_t)(p - out);
+}
+
+// ----------------------------------------------------------------------------
+// Chunked tokenization
+// ----------------------------------------------------------------------------
+
+static void* tokenize_chunk(void* arg) {
+    Chunk* c = (Chunk*)arg;
+    if (c->available > c->capacity) {
+        free(c->ids);
+        free(c->offsets);
+        c->capacity = c->available;
+        c->ids = (int32_t*)xmalloc(c->capacity * sizeof(int32_t));
+        c->offsets = (size_t*)xmalloc(c->capacity * sizeof(size_t));
+    }
+
+    size_t consumed;
+    size_t count = crayon_tokenize_offsets(c->vocab->trie, c->text, c->available,
+                                           c->vocab->unk_id, c->ids, c->offsets,
+                                           c->capacity, &consumed);
+    // Tokens starting in the lookahead belong to the next chunk
+    size_t kept = count;
+    while (kept && c->offsets[kept - 1] >= c->span) kept--;
+    c->kept = kept;
+    c->next = kept < count ? c->offsets[kept] : consumed;
+
+    size_t need = kept * format_width(c->format);
+    if (need > c->out_capacity) {
+        free(c->out);
+        c->out_capacity = need;
+        c->out = (uint8_t*)xmalloc(need);
+    }
+    c->out_length = format_ids(c->format, c->ids, kept, c->out, &c->error);
+    return NULL;
+}
+
+// Skip the first k IDs of a chunk's formatted output
+static size_t output_skip(const Chunk* c, size_t k) {
+    if (c->format != FORMAT_TEXT) return k * format_width(c->format);
+    size_t pos = 0;
+    while (k--) pos = (size_t)((uint8_t*)memchr(c->out + pos, '\n', c->out_length - pos) - c->out) + 1;
+    return pos;
+}
+
+static void check_format_error(int error) {
+    if (error) die("token ID above 65535; use --format u32", NULL);
+}
+
+/*
+ * Tokenize text[0, limit) with lookahead up to length and write the IDs.
+ * Returns where the first unwritten token starts (>= limit).
+ */
+static size_t tokenize_block(Context* ctx, const char* text, size_t length, size_t limit) {
+    size_t max_len = ctx->vocab.max_len;
+    int parts = ctx->threads;
+    if ((size_t)parts > limit / 4096 + 1) parts = (int)(limit / 4096 + 1);
+
+    size_t bounds[parts + 1];
+    for (int i = 0; i <= parts; i++) bounds[i] = (size_t)((double)limit * i / parts);
+
+    pthread_t workers[parts];
+    for (int i = 0; i < parts; i++) {
+        Chunk* c = &ctx->chunks[i];
+        c->text = text + bounds[i];
+        c->span = bounds[i + 1] - bounds[i];
+        size_t end = bounds[i + 1] + max_len;
+        c->available = (end < length ? end : length) - bounds[i];
+        if (i > 0 && pthread_create(&workers[i], NULL, tokenize_chunk, c) != 0) {
+            tokenize_chunk(c);
+            workers[i] = pthread_self();
+        }
+    }
+    tokenize_chunk(&ctx->chunks[0]);
+    for (int i = 1; i < parts; i++) {
+        if (!pthread_equal(workers[i], pthread_self())) pthread_join(workers[i], NULL);
+    }
+
+    // Merge: chunk 0 starts on a known boundary; every later chunk is used
+    // from the first of its token starts that the exact stream reaches
+    size_t pos = 0;
+    uint8_t scratch[16];
+    for (int i = 0; i < parts; i++) {
+        Chunk* c = &ctx->chunks[i];
+        check_format_error(c->error);
+        while (pos < bounds[i + 1]) {
+            size_t rel = pos - bounds[i];
+            size_t lo = 0, hi = c->kept;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (c->offsets[mid] < rel) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo < c->kept && c->offsets[lo] == rel) {
+                size_t skip = output_skip(c, lo);
+                writer_write(&ctx->writer, c->out + skip, c->out_length - skip);
+                ctx->tokens_out += c->kept - lo;
+                pos = bounds[i] + c->next;
+                break;
+            }
+            // Not in sync yet: redo one token on the exact stream
+            int32_t id;
+            size_t consumed;
+            crayon_tokenize(ctx->vocab.trie, text + pos, length - pos, ctx->vocab.unk_id,
+                            &id, 1, &consumed);
+            int error = 0;
+            size_t n = format_ids(ctx->format, &id, 1, scratch, &error);
+            check_format_error(error);
+            writer_write(&ctx->writer, scratch, n);
+            ctx->tokens_out++;
+            pos += consumed;
+        }
+    }
+    return pos;
+}
+
+static void report_progress(Context* ctx, int final) {
+    double now = now_seconds();
+    if (!final && now - ctx->last_report < 1.0) return;
+    ctx->last_report = now;
+    double elapsed = now - ctx->started;
+    double mb = (double)ctx->bytes_in / 1e6;
+    fprintf(stderr, "\r%10.1f MB  %8.1f MB/s  %14llu tokens%s", mb,
+            elapsed > 0 ? mb / elapsed : 0.0, (unsigned long long)ctx->tokens_out,
+            final ? "\n" : "");
+}
+
+// Process [0, length) of an input that is fully available (mapped file)
+static void process_mapped(Context* ctx, const char* data, size_t length) {
+    size_t block = (size_t)ctx->threads * ctx->chunk_size;
+    size_t pos = 0;
+    while (pos < length) {
+        size_t remaining = length - pos;
+        size_t limit = remaining < block ? remaining : block;
+        size_t next = tokenize_block(ctx, data + pos, remaining, limit);
+        ctx->bytes_in += next;
+        pos += next;
+        if (ctx->progress) report_progress(ctx, 0);
+    }
+}
+
+// Process a pipe (or any unmappable input) in blocks, carrying the tail
+static void process_stream(Context* ctx, int fd, const char* name) {
+    size_t capacity = (size_t)ctx->threads * ctx->chunk_size + ctx->vocab.max_len;
+    char* buffer = (char*)xmalloc(capacity);
+    size_t have = 0;
+    int eof = 0;
+
+    for (;;) {
+        while (!eof && have < capacity) {
+            ssize_t r = read(fd, buffer + have, capacity - have);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                die(strerror(errno), name);
+            }
+            if (r == 0) eof = 1;
+            have += (size_t)r;
+        }
+        if (have == 0) break;
+
+        // Before EOF, only tokens with max_len bytes of lookahead are final
+        size_t limit = eof ? have : (have > ctx->vocab.max_len ? have - ctx->vocab.max_len : 0);
+        if (limit == 0) {
+            capacity *= 2;
+            char* grown = (char*)realloc(buffer, capacity);
+            if (!grown) die("out of memory", NULL);
+            buffer = grown;
+            continue;
+        }
+        size_t next = tokenize_block(ctx, buffer, have, limit);
+        ctx->bytes_in += next;
+        memmove(buffer, buffer + next, have - next);
+        have -= next;
+        if (ctx->progress) report_progress(ctx, 0);
+    }
+    free(buffer);
+}
+
+static void process_input(Context* ctx, const char* path) {
+    int stdin_input = strcmp(path, "-") == 0;
+    int fd = stdin_input ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) die(strerror(errno), path);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+#if defined(POSIX_MADV_SEQUENTIAL)
+            posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+            process_mapped(ctx, (const char*)map, (size_t)st.st_size);
+            munmap(map, (size_t)st.st_size);
+            if (!stdin_input) close(fd);
+            return;
+        }
+    }
+    process_stream(ctx, fd, stdin_input ? "<stdin>" : path);
+    if (!stdin_input) close(fd);
+}
+
+// ----------------------------------------------------------------------------
+// Command line
+// ----------------------------------------------------------------------------
+
+static void usage(FILE* out) {
+    fprintf(out,
+        "usage: crayon-tokenize -v VOCAB [options] [FILE...]\n"
+        "\n"
+        "Tokenize FILEs (or stdin, or '-') and write token IDs to stdout.\n"
+        "Each file is tokenized on its own; no token spans two files.\n"
+        "\n"
+        "  -v, --vocab PATH      vocabulary: image (CrayonVocab.save(format=\"image\"),\n"
+        "                        *.bin), trie image, or text with one token per line\n"
+        "  -o, --output PATH     write here instead of stdout\n"
+        "  -f, --format FMT      u16 | u32 (little-endian) | text (one ID per line);\n"
+        "                        default u16 when the vocabulary fits, else u32\n"
+        "  -t, --threads N       worker threads (default: online CPUs)\n"
+        "      --chunk-size N    bytes per thread per block (default 1M)\n"
+        "      --shard-size N    with -o, split output into PATH.00000, PATH.00001, ...\n"
+        "                        of at most N bytes each\n"
+        "      --unk-token TOK   UNK token for text vocabularies (default <UNK>)\n"
+        "      --unk-id N        override the UNK ID\n"
+        "  -p, --progress        report progress on stderr every second\n"
+        "  -q, --quiet           no summary line\n"
+        "\n"
+        "Sizes accept K, M and G suffixes. libcrayon %s\n", crayon_version());
+}
+
+static size_t parse_size(const char* text, const char* option) {
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    switch (*end) {
+        case 'k': case 'K': value <<= 10; end++; break;
+        case 'm': case 'M': value <<= 20; end++; break;
+        case 'g': case 'G': value <<= 30; end++; break;
+        default: break;
+    }
+    if (errno || end == text || *end || value == 0) die("invalid size for", option);
+    return (size_t)value;
+}
+
+int main(int argc, char** argv) {
+    Context ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    const char* vocab_path = NULL;
+    const char* unk_token = "<UNK>";
+    int have_unk_id = 0;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    ctx.threads = cpus > 0 ? (int)cpus : 1;
+    ctx.chunk_size = 1 << 20;
+    ctx.format = FORMAT_AUTO;
+
+    const char** inputs = (const char**)xmalloc((size_t)argc * sizeof(char*));
+    int n_inputs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+#define OPTION(short_name, long_name) \
+        (strcmp(arg, short_name) == 0 || strcmp(arg, long_name) == 0)
+#define TAKE_VALUE() do { if (!value) die("missing value for", arg); i++; } while (0)
+        if (OPTION("-h", "--help")) {
+            usage(stdout);
+            return 0;
+        } else if (OPTION("-v", "--vocab")) {
+            TAKE_VALUE();
+            vocab_path = value;
+        } else if (OPTION("-o", "--output")) {
+            TAKE_VALUE();
+            ctx.writer.path = value;
+        } else if (OPTION("-f", "--format")) {
+            TAKE_VALUE();
+            if (strcmp(value, "u16") == 0) ctx.format = FORMAT_U16;
+            else if (strcmp(value, "u32") == 0) ctx.format = FORMAT_U32;
+            else if (strcmp(value, "text") == 0) ctx.format = FORMAT_TEXT;
+            else die("unknown format", value);
+        } else if (OPTION("-t", "--threads")) {
+            TAKE_VALUE();
+            ctx.threads = atoi(value);
+            if (ctx.threads < 1 || ctx.threads > 1024) die("invalid thread count", value);
+        } else if (strcmp(arg, "--chunk-size") == 0) {
+            TAKE_VALUE();
+            ctx.chunk_size = parse_size(value, arg);
+        } else if (strcmp(arg, "--shard-size") == 0) {
+            TAKE_VALUE();
+            ctx.writer.shard_size = parse_size(value, arg);
+        } else if (strcmp(arg, "--unk-token") == 0) {
+            TAKE_VALUE();
+            unk_token = value;
+        } else if (strcmp(arg, "--unk-id") == 0) {
+            TAKE_VALUE();
+            ctx.vocab.unk_id = (int32_t)atol(value);
+            have_unk_id = 1;
+        } else if (OPTION("-p", "--progress")) {
+            ctx.progress = 1;
+        } else if (OPTION("-q", "--quiet")) {
+            ctx.quiet = 1;
+        } else if (arg[0] == '-' && arg[1]) {
+            usage(stderr);
+            die("unknown option", arg);
+        } else {
+            inputs[n_inputs++] = arg;
+        }
+#undef OPTION
+#undef TAKE_VALUE
+    }
+    if (!vocab_path) {
+        usage(stderr);
+        return 2;
+    }
+    if (ctx.writer.shard_size && !ctx.writer.path) die("--shard-size needs --output", NULL);
+    if (!ctx.writer.path && isatty(STDOUT_FILENO) && ctx.format != FORMAT_TEXT) {
+        die("refusing to write binary IDs to a terminal (use -o or --format text)", NULL);
+    }
+    if (n_inputs == 0) inputs[n_inputs++] = "-";
+
+    load_vocab(&ctx.vocab, vocab_path, unk_token, have_unk_id);
+    if (ctx.format == FORMAT_AUTO) {
+        int64_t n = ctx.vocab.token_count;
+        ctx.format = n >= 0 && n <= 0x10000 && ctx.vocab.unk_id <= 0xFFFF ? FORMAT_U16 : FORMAT_U32;
+    }
+    ctx.writer.record = ctx.format == FORMAT_TEXT ? 0 : format_width(ctx.format);
+    if (ctx.writer.shard_size && ctx.writer.shard_size < 16) die("--shard-size must be at least 16", NULL);
+    if (!ctx.writer.path) setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+    if (!ctx.writer.shard_size) writer_open_next(&ctx.writer);  // Even for empty input
+
+    ctx.chunks = (Chunk*)calloc((size_t)ctx.threads, sizeof(Chunk));
+    if (!ctx.chunks) die("out of memory", NULL);
+    for (int i = 0; i < ctx.threads; i++) {
+        ctx.chunks[i].vocab = &ctx.vocab;
+        ctx.chunks[i].format = ctx.format;
+    }
+
+    ctx.started = now_seconds();
+    ctx.last_report = ctx.started;
+    for (int i = 0; i < n_inputs; i++) process_input(&ctx, inputs[i]);
+    writer_close(&ctx.writer);
+
+    double elapsed = now_seconds() - ctx.started;
+    if (ctx.progress) report_progress(&ctx, 1);
+    if (!ctx.quiet) {
+        fprintf(stderr, "crayon-tokenize: %llu bytes -> %llu tokens in %.3f s "
+                "(%.1f MB/s, %.2f M tokens/s, %d threads)\n",
+                (unsigned long long)ctx.bytes_in, (unsigned long long)ctx.tokens_out, elapsed,
+                elapsed > 0 ? (double)ctx.bytes_in / 1e6 / elapsed : 0.0,
+                elapsed > 0 ? (double)ctx.tokens_out / 1e6 / elapsed : 0.0, ctx.threads);
+    }
+
+    for (int i = 0; i < ctx.threads; i++) {
+        free(ctx.chunks[i].ids);
+        free(ctx.chunks[i].offsets);
+        free(ctx.chunks[i].out);
+    }
+    free(ctx.chunks);
+    free((void*)inputs);
+    crayon_free(ctx.vocab.trie);
+    return 0;
+}
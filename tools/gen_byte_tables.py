@@ -0,0 +1,195 @@
+"""
+Generate the byte-class and UTF-8 tables shared by the native kernels.
+
+Writes src/crayon/c_ext/byte_tables.h and byte_tables.c. The tables are
+plain const data, so there is no startup work, and every kernel reads the
+same bytes:
+
+    crayon_byte_class[256]      CRAYON_BYTE_* class mask per byte
+    crayon_utf8_length[256]     sequence length per lead byte (0 = invalid lead)
+    crayon_utf8_second_*[64]    well-formed second-byte range per lead C0..FF
+    crayon_nibble_lo/hi[16]     PSHUFB tables for the vector classifier
+
+The nibble tables split each vector class into rectangles of (high nibble
+set) x (low nibble set), one bit per rectangle. A byte is in the class when
+lo[b & 15] & hi[b >> 4] has any of that class's CRAYON_NIBBLE_* bits set.
+
+Usage:
+    python tools/gen_byte_tables.py            # rewrite the checked-in files
+    python tools/gen_byte_tables.py --check    # exit 1 if they are stale
+"""
+
+import argparse
+import os
+import string
+import sys
+from typing import Dict, List, Tuple
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+OUT_DIR = os.path.join(REPO_ROOT, "src", "crayon", "c_ext")
+
+# (name, bit, description, membership)
+CLASSES = [
+    ("ALPHA", 0x01, "ASCII letter", lambda b: chr(b) in string.ascii_letters),
+    ("DIGIT", 0x02, "ASCII digit", lambda b: chr(b) in string.digits),
+    ("SPACE", 0x04, "ASCII whitespace (space, \\t \\n \\v \\f \\r)",
+     lambda b: chr(b) in " \t\n\v\f\r"),
+    ("PUNCT", 0x08, "ASCII punctuation", lambda b: chr(b) in string.punctuation),
+    ("UPPER", 0x10, "ASCII upper-case letter", lambda b: chr(b) in string.ascii_uppercase),
+    ("CONTROL", 0x20, "C0 control or DEL", lambda b: b < 0x20 or b == 0x7F),
+    ("UTF8_CONT", 0x40, "UTF-8 continuation byte", lambda b: 0x80 <= b <= 0xBF),
+    ("UTF8_LEAD", 0x80, "UTF-8 multi-byte lead (C2..F4)", lambda b: 0xC2 <= b <= 0xF4),
+]
+
+# Classes the AVX2 classifier computes (its output is their CRAYON_BYTE_* bits)
+VECTOR_CLASSES = ["ALPHA", "DIGIT", "SPACE"]
+
+
+def byte_class() -> List[int]:
+    return [sum(bit for _, bit, _, member in CLASSES if member(b)) for b in range(256)]
+
+
+def utf8_length() -> List[int]:
+    table = []
+    for b in range(256):
+        if b < 0x80:
+            table.append(1)
+        elif 0xC2 <= b <= 0xDF:
+            table.append(2)
+        elif 0xE0 <= b <= 0xEF:
+            table.append(3)
+        elif 0xF0 <= b <= 0xF4:
+            table.append(4)
+        else:
+            table.append(0)  # continuation, overlong lead C0/C1, or > U+10FFFF
+    return table
+
+
+def utf8_second_range() -> Tuple[List[int], List[int]]:
+    """Unicode Table 3-7: second byte bounds that rule out overlongs,
+    surrogates and code points above U+10FFFF. Indexed by lead - 0xC0."""
+    special = {0xE0: (0xA0, 0xBF), 0xED: (0x80, 0x9F), 0xF0: (0x90, 0xBF), 0xF4: (0x80, 0x8F)}
+    lo, hi = [], []
+    for lead in range(0xC0, 0x100):
+        first, last = special.get(lead, (0x80, 0xBF))
+        if utf8_length()[lead] == 0:
+            first, last = 0xFF, 0x00  # empty range
+        lo.append(first)
+        hi.append(last)
+    return lo, hi
+
+
+def nibble_tables() -> Tuple[List[int], List[int], Dict[str, int]]:
+    members = {name: member for name, _, _, member in CLASSES}
+    lo_table, hi_table = [0] * 16, [0] * 16
+    masks: Dict[str, int] = {}
+    bit = 0
+    for name in VECTOR_CLASSES:
+        # Group high nibbles by their low-nibble set: one rectangle each
+        rectangles: Dict[Tuple[int, ...], List[int]] = {}
+        for high in range(16):
+            lows = tuple(low for low in range(16) if members[name]((high << 4) | low))
+            if lows:
+                rectangles.setdefault(lows, []).append(high)
+        masks[name] = 0
+        for lows, highs in rectangles.items():
+            if bit == 8:
+                sys.exit("vector classes need more than 8 nibble bits")
+            for low in lows:
+                lo_table[low] |= 1 << bit
+            for high in highs:
+                hi_table[high] |= 1 << bit
+            masks[name] |= 1 << bit
+            bit += 1
+    return lo_table, hi_table, masks
+
+
+def format_array(values: List[int], per_line: int = 16) -> str:
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(f"0x{v:02X}" for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+BANNER = "// Generated by tools/gen_byte_tables.py -- do not edit.\n"
+
+
+def render_header() -> str:
+    _, _, masks = nibble_tables()
+    out = [BANNER, "#ifndef CRAYON_BYTE_TABLES_H", "#define CRAYON_BYTE_TABLES_H", "",
+           "#include <stdint.h>", "", "// crayon_byte_class bits"]
+    for name, bit, description, _ in CLASSES:
+        out.append(f"#define CRAYON_BYTE_{name:<10} 0x{bit:02X}  // {description}")
+    out += ["", "// Nibble-table bits per vector class (see crayon_nibble_lo/hi)"]
+    for name in VECTOR_CLASSES:
+        out.append(f"#define CRAYON_NIBBLE_{name:<6} 0x{masks[name]:02X}")
+    out += [
+        "",
+        "extern const uint8_t crayon_byte_class[256];",
+        "",
+        "// UTF-8 sequence length by lead byte; 0 for continuation bytes and",
+        "// leads that can only start overlong or out-of-range sequences",
+        "extern const uint8_t crayon_utf8_length[256];",
+        "",
+        "// Well-formed second-byte range by lead byte, indexed lead - 0xC0",
+        "extern const uint8_t crayon_utf8_second_min[64];",
+        "extern const uint8_t crayon_utf8_second_max[64];",
+        "",
+        "// PSHUFB lookup by low and high nibble: class bits = lo[b & 15] & hi[b >> 4]",
+        "extern const uint8_t crayon_nibble_lo[16];",
+        "extern const uint8_t crayon_nibble_hi[16];",
+        "",
+        "#endif // CRAYON_BYTE_TABLES_H",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def render_source() -> str:
+    second_lo, second_hi = utf8_second_range()
+    nibble_lo, nibble_hi, _ = nibble_tables()
+    tables = [
+        ("crayon_byte_class[256]", byte_class()),
+        ("crayon_utf8_length[256]", utf8_length()),
+        ("crayon_utf8_second_min[64]", second_lo),
+        ("crayon_utf8_second_max[64]", second_hi),
+        ("crayon_nibble_lo[16]", nibble_lo),
+        ("crayon_nibble_hi[16]", nibble_hi),
+    ]
+    out = [BANNER, '#include "byte_tables.h"', ""]
+    for declaration, values in tables:
+        out += [f"const uint8_t {declaration} = {{", format_array(values), "};", ""]
+    return "\n".join(out)
+
+
+def outputs() -> Dict[str, str]:
+    return {
+        os.path.join(OUT_DIR, "byte_tables.h"): render_header(),
+        os.path.join(OUT_DIR, "byte_tables.c"): render_source(),
+    }
+
+
+def main(argv=None) -> int:
+    parser = argparse.ArgumentParser(description="Generate Crayon byte tables")
+    parser.add_argument("--check", action="store_true",
+                        help="compare with the checked-in files instead of writing")
+    args = parser.parse_args(argv)
+
+    stale = []
+    for path, content in outputs().items():
+        current = open(path, encoding="utf-8").read() if os.path.exists(path) else None
+        if current == content:
+            continue
+        if args.check:
+            stale.append(path)
+        else:
+            with open(path, "w", encoding="utf-8", newline="\n") as f:
+                f.write(content)
+            print(f"wrote {os.path.relpath(path, REPO_ROOT)}")
+    for path in stale:
+        print(f"stale: {os.path.relpath(path, REPO_ROOT)} (run tools/gen_byte_tables.py)")
+    return 1 if stale else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())